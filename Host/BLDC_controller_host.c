@@ -0,0 +1,18 @@
+/*
+ * Src/BLDC_controller.c for LP64 hosts.
+ *
+ * The generated code refuses to build unless long is 32 bits wide, a check
+ * for the word sizes of the Cortex-M3 target. It never uses long itself,
+ * all its arithmetic is on int32_T (int) and int64_T (long long), so the
+ * host build takes the 32 bit limits for the check and compiles the file
+ * unchanged otherwise, through BLDC_controller_weak.c like the board.
+ */
+
+#include <limits.h>
+
+#undef  ULONG_MAX
+#undef  LONG_MAX
+#define ULONG_MAX 0xFFFFFFFFU
+#define LONG_MAX  0x7FFFFFFF
+
+#include "../Src/BLDC_controller_weak.c"
@@ -0,0 +1,58 @@
+/*
+ * BLDC_Init() of util.c for the host tools, see bldc_host.h.
+ */
+
+#include <string.h>
+#include "config.h"
+#include "bldc_host.h"
+
+P rtP_Right;
+DW rtDW_Left, rtDW_Right;
+ExtU rtU_Left, rtU_Right;
+ExtY rtY_Left, rtY_Right;
+static RT_MODEL rtM_Left_, rtM_Right_;
+RT_MODEL *const rtM_Left = &rtM_Left_;
+RT_MODEL *const rtM_Right = &rtM_Right_;
+
+void bldc_host_reset(void)
+{
+  // the board starts from zeroed statics, a host tool may start several times
+  memset(&rtDW_Left, 0, sizeof(rtDW_Left));
+  memset(&rtDW_Right, 0, sizeof(rtDW_Right));
+  memset(&rtU_Left, 0, sizeof(rtU_Left));
+  memset(&rtU_Right, 0, sizeof(rtU_Right));
+  memset(&rtY_Left, 0, sizeof(rtY_Left));
+  memset(&rtY_Right, 0, sizeof(rtY_Right));
+
+  rtM_Left->defaultParam = &rtP_Left;
+  rtM_Left->dwork = &rtDW_Left;
+  rtM_Left->inputs = &rtU_Left;
+  rtM_Left->outputs = &rtY_Left;
+  rtM_Right->defaultParam = &rtP_Right;
+  rtM_Right->dwork = &rtDW_Right;
+  rtM_Right->inputs = &rtU_Right;
+  rtM_Right->outputs = &rtY_Right;
+
+  BLDC_controller_initialize(rtM_Left);
+  BLDC_controller_initialize(rtM_Right);
+}
+
+void bldc_host_init(uint8_t ctrl_typ)
+{
+  rtP_Left.b_angleMeasEna = 0;
+  rtP_Left.z_selPhaCurMeasABC = 0;
+  rtP_Left.z_ctrlTypSel = ctrl_typ;
+  rtP_Left.b_diagEna = DIAG_ENA;
+  rtP_Left.i_max = (I_MOT_MAX * A2BIT_CONV) << 4;
+  rtP_Left.n_max = N_MOT_MAX << 4;
+  rtP_Left.b_fieldWeakEna = FIELD_WEAK_ENA;
+  rtP_Left.id_fieldWeakMax = (FIELD_WEAK_MAX * A2BIT_CONV) << 4;
+  rtP_Left.a_phaAdvMax = PHASE_ADV_MAX << 4;
+  rtP_Left.r_fieldWeakHi = FIELD_WEAK_HI << 4;
+  rtP_Left.r_fieldWeakLo = FIELD_WEAK_LO << 4;
+
+  rtP_Right = rtP_Left;
+  rtP_Right.z_selPhaCurMeasABC = 1;
+
+  bldc_host_reset();
+}
@@ -0,0 +1,34 @@
+/*
+ * The controller state util.c keeps on the board, for the host tools that
+ * step BLDC_controller (bldc_sil, bldc_replay).
+ */
+
+#ifndef BLDC_HOST_H
+#define BLDC_HOST_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "BLDC_controller.h"
+
+extern P rtP_Left;    // defaults in BLDC_controller_data.c
+extern P rtP_Right;
+extern DW rtDW_Left, rtDW_Right;
+extern ExtU rtU_Left, rtU_Right;
+extern ExtY rtY_Left, rtY_Right;
+extern RT_MODEL *const rtM_Left;
+extern RT_MODEL *const rtM_Right;
+
+// BLDC_Init() with the control type as a parameter
+void bldc_host_init(uint8_t ctrl_typ);
+// zeroes the controller state and initializes both controllers with rtP_Left/rtP_Right as they are
+void bldc_host_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
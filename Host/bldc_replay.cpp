@@ -0,0 +1,507 @@
+/*
+ * bldc_replay : step BLDC_controller through a recorded trace of its inputs
+ * and compare every output with a golden run, as the regression gate for
+ * changes to the controller code or BLDC_FAST_HELPERS.
+ *
+ *   bldc_replay [-g golden.hbt] [-w out.hbt] [-I max_instr_per_step] [-k repeats] [-v max_reported] trace.hbt
+ *   bldc_replay -i capture.csv [-c com|sin|foc] trace.hbt
+ *
+ *   -g  compare with the outputs of this trace instead of the ones in trace.hbt
+ *   -w  write the inputs with the outputs of this build, a golden run for later
+ *   -I  fail when BLDC_controller_step() takes more user space instructions
+ *       per call than this
+ *   -k  timed passes over the trace, the fastest counts (5)
+ *   -v  mismatches printed in full, the rest are only counted (10)
+ *   -i  convert a decimation 1 limero_scope capture of the ctl/tgt and
+ *       current channels into a trace without outputs, with rtP as
+ *       BLDC_Init() sets it for the control type -c
+ *
+ * The controllers start from zeroed state with the rtP_Left/rtP_Right stored
+ * in the trace, get the recorded ExtU of every period and each ExtY field is
+ * compared bit for bit. Any difference exits 1 and names the first periods,
+ * motors and fields that differ.
+ *
+ * The speed is counted with the hardware instruction counter
+ * (perf_event_open, user space only), which does not drift with the clock or
+ * the load of the machine like the ns/step printed next to it. The count
+ * includes copying ExtU into place, a few instructions per step. Where the
+ * counter is not available (virtual machines, perf_event_paranoid > 2)
+ *   valgrind --tool=callgrind --toggle-collect=BLDC_controller_step Host/build/bldc_replay -k 1 trace.hbt
+ * gives the same number as Ir / calls. Either is an x86 count: it tracks
+ * changes to the C code, the Cortex-M3 cycles come from ISR_PROFILE.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+#include "bldc_host.h"
+#include "ctrl_trace.h"
+#include "host_util.h"
+
+struct Row
+{
+    ExtU u[2];
+    ExtY y[2];
+};
+
+struct Trace
+{
+    uint8_t motors = 0;
+    uint8_t flags = 0;
+    P params[2];
+    std::vector<Row> rows;
+};
+
+static const char *const motor_names[] = {"left", "right"};
+
+// ExtY fields in the order of the trace
+static const struct
+{
+    const char *name;
+    size_t offset;
+    size_t size;
+} out_fields[] = {
+    {"DC_phaA", offsetof(ExtY, DC_phaA), 2},
+    {"DC_phaB", offsetof(ExtY, DC_phaB), 2},
+    {"DC_phaC", offsetof(ExtY, DC_phaC), 2},
+    {"n_mot", offsetof(ExtY, n_mot), 2},
+    {"a_elecAngle", offsetof(ExtY, a_elecAngle), 2},
+    {"iq", offsetof(ExtY, iq), 2},
+    {"id", offsetof(ExtY, id), 2},
+    {"z_errCode", offsetof(ExtY, z_errCode), 1},
+};
+#define OUT_FIELDS (sizeof(out_fields) / sizeof(out_fields[0]))
+
+static int field_value(const ExtY &y, size_t field)
+{
+    const char *p = (const char *)&y + out_fields[field].offset;
+    return out_fields[field].size == 2 ? *(const int16_t *)p : *(const uint8_t *)p;
+}
+
+static bool load_trace(const char *path, Trace &trace)
+{
+    CtrlTrace in;
+    if (ctrl_trace_open(&in, path) != 0)
+    {
+        return false;
+    }
+    trace.motors = in.motors;
+    trace.flags = in.flags;
+    trace.params[0] = in.params[0];
+    trace.params[1] = in.params[1];
+    trace.rows.reserve(in.periods);
+    Row row;
+    memset(&row, 0, sizeof(row));
+    while (ctrl_trace_read(&in, row.u, row.y) == 1)
+    {
+        trace.rows.push_back(row);
+    }
+    fclose(in.file);
+    return true;
+}
+
+// Both controllers once per row, as DMA1_Channel1_IRQHandler() does
+static void replay(const Trace &trace, std::vector<Row> *out)
+{
+    rtP_Left = trace.params[0];
+    rtP_Right = trace.params[1];
+    bldc_host_reset();
+    for (size_t n = 0; n < trace.rows.size(); n++)
+    {
+        const Row &row = trace.rows[n];
+        if (trace.motors & CTRL_TRACE_LEFT)
+        {
+            rtU_Left = row.u[0];
+            BLDC_controller_step(rtM_Left);
+        }
+        if (trace.motors & CTRL_TRACE_RIGHT)
+        {
+            rtU_Right = row.u[1];
+            BLDC_controller_step(rtM_Right);
+        }
+        if (out)
+        {
+            (*out)[n].y[0] = rtY_Left;
+            (*out)[n].y[1] = rtY_Right;
+        }
+    }
+}
+
+// Hardware instruction counter of this thread in user space, -1 if there is none
+static int instr_counter_open()
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static uint64_t counted_replay(int counter, const Trace &trace, uint64_t &ns)
+{
+    uint64_t count = 0;
+    uint64_t start = now_ns(CLOCK_THREAD_CPUTIME_ID);
+    if (counter >= 0)
+    {
+        ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+        ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    replay(trace, NULL);
+    if (counter >= 0)
+    {
+        ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(counter, &count, sizeof(count)) != sizeof(count))
+        {
+            count = 0;
+        }
+    }
+    ns = now_ns(CLOCK_THREAD_CPUTIME_ID) - start;
+    return count;
+}
+
+static int compare(const Trace &trace, const std::vector<Row> &got, const std::vector<Row> &golden,
+                   uint8_t motors, long max_reported)
+{
+    uint32_t mismatched[2][OUT_FIELDS] = {};
+    uint32_t periods = 0;
+    long reported = 0;
+    for (size_t n = 0; n < trace.rows.size(); n++)
+    {
+        bool differs = false;
+        for (int m = 0; m < 2; m++)
+        {
+            if (!(motors & (1 << m)))
+            {
+                continue;
+            }
+            for (size_t f = 0; f < OUT_FIELDS; f++)
+            {
+                int a = field_value(got[n].y[m], f);
+                int b = field_value(golden[n].y[m], f);
+                if (a == b)
+                {
+                    continue;
+                }
+                differs = true;
+                mismatched[m][f]++;
+                if (reported++ < max_reported)
+                {
+                    printf("period %zu %s %s: %d, golden %d\n", n, motor_names[m], out_fields[f].name, a, b);
+                }
+            }
+        }
+        periods += differs;
+    }
+    if (periods == 0)
+    {
+        return 0;
+    }
+    printf("%u of %zu periods differ\n", periods, trace.rows.size());
+    for (int m = 0; m < 2; m++)
+    {
+        for (size_t f = 0; f < OUT_FIELDS; f++)
+        {
+            if (mismatched[m][f])
+            {
+                printf("  %-5s %-12s %u\n", motor_names[m], out_fields[f].name, mismatched[m][f]);
+            }
+        }
+    }
+    return 1;
+}
+
+static int lookup(const char *name, const char *const *names, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (strcmp(name, names[i]) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// limero_scope CSV -> trace: per motor the packed ctl channel, r_inpTgt and the three currents
+static int import_scope(const char *argv0, const char *csv_path, const char *trace_path, int ctrl_typ)
+{
+    static const char *const columns[2][5] = {
+        {"ctl_l", "tgt_l", "curl_phaa", "curl_phab", "curl_dc"},
+        {"ctl_r", "tgt_r", "curr_phab", "curr_phac", "curr_dc"},
+    };
+    FILE *in = fopen(csv_path, "r");
+    if (!in)
+    {
+        fprintf(stderr, "%s: %s: %s\n", argv0, csv_path, strerror(errno));
+        return 1;
+    }
+    char line[1024];
+    std::vector<std::string> names;
+    if (fgets(line, sizeof(line), in))
+    {
+        for (char *tok = strtok(line, ",\r\n"); tok; tok = strtok(NULL, ",\r\n"))
+        {
+            names.push_back(tok);
+        }
+    }
+    int index[2][5];
+    uint8_t motors = 0;
+    for (int m = 0; m < 2; m++)
+    {
+        bool complete = true;
+        for (int c = 0; c < 5; c++)
+        {
+            index[m][c] = -1;
+            for (size_t i = 0; i < names.size(); i++)
+            {
+                if (names[i] == columns[m][c])
+                {
+                    index[m][c] = (int)i;
+                }
+            }
+            complete &= index[m][c] >= 0;
+        }
+        motors |= complete ? 1 << m : 0;
+    }
+    if (names.empty() || names[0] != "time_us" || motors == 0)
+    {
+        fprintf(stderr, "%s: %s: needs time_us and ctl, tgt and the three currents of a motor\n", argv0, csv_path);
+        fclose(in);
+        return 1;
+    }
+
+    bldc_host_init(ctrl_typ);
+    CtrlTrace trace;
+    if (ctrl_trace_create(&trace, trace_path, motors, 0, &rtP_Left, &rtP_Right) != 0)
+    {
+        fprintf(stderr, "%s: %s: %s\n", argv0, trace_path, strerror(errno));
+        fclose(in);
+        return 1;
+    }
+    const double period_us = 1e6 / PWM_FREQ;
+    double prev_t = 0;
+    int rc = 0;
+    ExtU u[2];
+    memset(u, 0, sizeof(u));
+    while (rc == 0 && fgets(line, sizeof(line), in))
+    {
+        std::vector<double> values;
+        for (char *tok = strtok(line, ",\r\n"); tok; tok = strtok(NULL, ",\r\n"))
+        {
+            values.push_back(atof(tok));
+        }
+        if (values.size() != names.size())
+        {
+            continue;
+        }
+        if (trace.periods && (values[0] - prev_t < period_us - 1 || values[0] - prev_t > period_us + 1))
+        {
+            fprintf(stderr, "%s: %s: samples are not 16 kHz periods, capture with -n 1\n", argv0, csv_path);
+            rc = 1;
+            break;
+        }
+        prev_t = values[0];
+        for (int m = 0; m < 2; m++)
+        {
+            if (!(motors & (1 << m)))
+            {
+                continue;
+            }
+            int ctl = (int)values[index[m][0]];
+            u[m].b_hallA = ctl & 1;
+            u[m].b_hallB = ctl >> 1 & 1;
+            u[m].b_hallC = ctl >> 2 & 1;
+            u[m].b_motEna = ctl >> 3 & 1;
+            u[m].z_ctrlModReq = ctl >> 4 & 3;
+            u[m].r_inpTgt = (int16_t)values[index[m][1]];
+            u[m].i_phaAB = (int16_t)values[index[m][2]];
+            u[m].i_phaBC = (int16_t)values[index[m][3]];
+            u[m].i_DCLink = (int16_t)values[index[m][4]];
+        }
+        if (ctrl_trace_write(&trace, u, NULL) != 0)
+        {
+            fprintf(stderr, "%s: %s: %s\n", argv0, trace_path, strerror(errno));
+            rc = 1;
+        }
+    }
+    fclose(in);
+    if (ctrl_trace_close(&trace) != 0 && rc == 0)
+    {
+        fprintf(stderr, "%s: %s: %s\n", argv0, trace_path, strerror(errno));
+        rc = 1;
+    }
+    if (rc == 0)
+    {
+        printf("%u periods, motors%s%s\n", trace.periods, motors & CTRL_TRACE_LEFT ? " left" : "",
+               motors & CTRL_TRACE_RIGHT ? " right" : "");
+    }
+    return rc;
+}
+
+static int usage(const char *argv0)
+{
+    fprintf(stderr, "usage: %s [-g golden.hbt] [-w out.hbt] [-I max_instr_per_step] [-k repeats] [-v max_reported] trace.hbt\n"
+                    "       %s -i capture.csv [-c com|sin|foc] trace.hbt\n",
+            argv0, argv0);
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    static const char *const ctrl_names[] = {"com", "sin", "foc"};
+    const char *golden_path = NULL;
+    const char *out_path = NULL;
+    const char *import_path = NULL;
+    int ctrl_typ = CTRL_TYP_SEL;
+    double max_instr = 0;
+    int repeats = 5;
+    long max_reported = 10;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "g:w:I:k:v:i:c:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'g': golden_path = optarg; break;
+        case 'w': out_path = optarg; break;
+        case 'I': max_instr = atof(optarg); break;
+        case 'k': repeats = atoi(optarg) > 0 ? atoi(optarg) : 1; break;
+        case 'v': max_reported = atol(optarg); break;
+        case 'i': import_path = optarg; break;
+        case 'c':
+            ctrl_typ = lookup(optarg, ctrl_names, 3);
+            if (ctrl_typ < 0)
+            {
+                return usage(argv[0]);
+            }
+            break;
+        default: return usage(argv[0]);
+        }
+    }
+    if (optind != argc - 1)
+    {
+        return usage(argv[0]);
+    }
+    const char *trace_path = argv[optind];
+    if (import_path)
+    {
+        return import_scope(argv[0], import_path, trace_path, ctrl_typ);
+    }
+
+    Trace trace;
+    if (!load_trace(trace_path, trace))
+    {
+        fprintf(stderr, "%s: %s: %s\n", argv[0], trace_path, strerror(errno));
+        return 1;
+    }
+    if (trace.rows.empty())
+    {
+        fprintf(stderr, "%s: %s: no periods\n", argv[0], trace_path);
+        return 1;
+    }
+
+    // golden outputs: another trace of the same inputs, or the ones recorded with them
+    Trace golden_trace;
+    const Trace *golden = NULL;
+    if (golden_path)
+    {
+        if (!load_trace(golden_path, golden_trace))
+        {
+            fprintf(stderr, "%s: %s: %s\n", argv[0], golden_path, strerror(errno));
+            return 1;
+        }
+        if (!(golden_trace.flags & CTRL_TRACE_OUTPUTS) || (golden_trace.motors & trace.motors) != trace.motors ||
+            golden_trace.rows.size() != trace.rows.size())
+        {
+            fprintf(stderr, "%s: %s: no outputs for the %zu periods and motors of %s\n", argv[0], golden_path,
+                    trace.rows.size(), trace_path);
+            return 1;
+        }
+        golden = &golden_trace;
+    }
+    else if (trace.flags & CTRL_TRACE_OUTPUTS)
+    {
+        golden = &trace;
+    }
+
+    std::vector<Row> got(trace.rows);
+    replay(trace, &got);
+    int rc = golden ? compare(trace, got, golden->rows, trace.motors, max_reported) : 0;
+
+    if (out_path)
+    {
+        CtrlTrace out;
+        if (ctrl_trace_create(&out, out_path, trace.motors, CTRL_TRACE_OUTPUTS, &trace.params[0], &trace.params[1]) != 0)
+        {
+            fprintf(stderr, "%s: %s: %s\n", argv[0], out_path, strerror(errno));
+            return 1;
+        }
+        for (const Row &row : got)
+        {
+            ctrl_trace_write(&out, row.u, row.y);
+        }
+        if (ctrl_trace_close(&out) != 0)
+        {
+            fprintf(stderr, "%s: %s: %s\n", argv[0], out_path, strerror(errno));
+            return 1;
+        }
+    }
+
+    int counter = instr_counter_open();
+    int counter_errno = errno;
+    uint64_t best_instr = UINT64_MAX, best_ns = UINT64_MAX;
+    for (int k = 0; k < repeats; k++)
+    {
+        uint64_t ns;
+        uint64_t instr = counted_replay(counter, trace, ns);
+        best_instr = instr < best_instr ? instr : best_instr;
+        best_ns = ns < best_ns ? ns : best_ns;
+    }
+    const double steps = (double)trace.rows.size() * __builtin_popcount(trace.motors);
+    printf("%zu periods, %.0f steps: %s, ", trace.rows.size(), steps,
+           !golden ? "no golden outputs" : rc ? "MISMATCH" : "outputs identical");
+    if (counter >= 0 && best_instr)
+    {
+        printf("%.1f instructions/step, ", best_instr / steps);
+    }
+    else
+    {
+        printf("instructions n/a, ");
+    }
+    printf("%.1f ns/step\n", best_ns / steps);
+
+    if (max_instr > 0)
+    {
+        if (counter < 0 || !best_instr)
+        {
+            printf("no instruction counter (%s), -I cannot be checked\n", strerror(counter_errno));
+            rc = 1;
+        }
+        else if (best_instr / steps > max_instr)
+        {
+            printf("over the limit of %.1f instructions/step\n", max_instr);
+            rc = 1;
+        }
+    }
+    if (counter >= 0)
+    {
+        close(counter);
+    }
+    return rc;
+}
@@ -0,0 +1,394 @@
+/*
+ * bldc_sil : BLDC_controller on Linux driving two simulated hub motors.
+ *
+ * Src/BLDC_controller.c is compiled unchanged and stepped for rtM_Left and
+ * rtM_Right once per simulated 16 kHz period, exactly as
+ * DMA1_Channel1_IRQHandler() does: halls and phase currents from the plant
+ * go in, DC_phaA..C come out and drive the plant through the next period.
+ * Every DELAY_IN_MAIN_LOOP ms a main loop pass sets pwml/pwmr from the
+ * command script. Nothing waits for the wall clock, a run takes as long as
+ * the arithmetic.
+ *
+ *   bldc_sil [-c com|sin|foc] [-m open|vlt|spd|trq] [-t duration_sec] [-n decimation]
+ *            [-P name=value ...] [-s script] [-o file.csv] [-r trace.hbt] [-H]
+ *
+ *   -c  control type (CTRL_TYP_SEL)
+ *   -m  control mode (CTRL_MOD_REQ)
+ *   -t  simulated seconds (the time of the last script line)
+ *   -n  one CSV row every this many 16 kHz periods (16, 1 ms)
+ *   -P  plant parameter for both motors, see motor_param_set(), e.g. -P inertia=0.5
+ *   -s  command script, lines "time_sec cmdl cmdr" with cmdl/cmdr in
+ *       INPUT_MIN..INPUT_MAX; values in between are interpolated linearly,
+ *       '#' starts a comment. Without one both motors step to 300 at 0.1 s.
+ *   -o  CSV output, none by default
+ *   -r  record the controller inputs and outputs of every period as a
+ *       ctrl_trace.h trace for bldc_replay
+ *   -H  HALL_CAPTURE: the hall edges are stamped where the plant crosses the
+ *       sector boundary within the period, hall_speed.c turns them into
+ *       a_mechAngle and the controllers run with b_angleMeasEna. The summary
+ *       adds the angle error against the plant.
+ *
+ * The summary on stderr ends with the final speeds, so sweeps over -P
+ * values only need to grep it. Runs are deterministic, two CSVs of the same
+ * setup compare equal.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+
+#include "bldc_host.h"
+#include "ctrl_trace.h"
+#include "hall_speed.h"
+#include "host_util.h"
+#include "motor_model.h"
+
+#define IQ_PER_AMP  (A2BIT_CONV * 16.0)   // iq/id are fixdt(1,16,4) of the ADC bits
+
+struct ScriptPoint
+{
+    double t;
+    double cmdl, cmdr;
+};
+
+static bool load_script(const char *path, std::vector<ScriptPoint> &script)
+{
+    FILE *in = fopen(path, "r");
+    if (!in)
+    {
+        return false;
+    }
+    char line[256];
+    while (fgets(line, sizeof(line), in))
+    {
+        char *hash = strchr(line, '#');
+        if (hash)
+        {
+            *hash = 0;
+        }
+        ScriptPoint point;
+        if (sscanf(line, "%lf %lf %lf", &point.t, &point.cmdl, &point.cmdr) == 3)
+        {
+            script.push_back(point);
+        }
+    }
+    fclose(in);
+    return true;
+}
+
+static void script_at(const std::vector<ScriptPoint> &script, double t, int16_t &cmdl, int16_t &cmdr)
+{
+    size_t i = 0;
+    while (i < script.size() && script[i].t <= t)
+    {
+        i++;
+    }
+    if (i == 0 || i == script.size())
+    {
+        const ScriptPoint &p = i == 0 ? script.front() : script.back();
+        cmdl = (int16_t)p.cmdl;
+        cmdr = (int16_t)p.cmdr;
+        return;
+    }
+    const ScriptPoint &a = script[i - 1];
+    const ScriptPoint &b = script[i];
+    double f = (t - a.t) / (b.t - a.t);
+    cmdl = (int16_t)(a.cmdl + f * (b.cmdl - a.cmdl));
+    cmdr = (int16_t)(a.cmdr + f * (b.cmdr - a.cmdr));
+}
+
+// Plant angle in the frame of the controller: hall position p covers [60 p, 60 p + 60) deg el
+static double plant_angle(const Motor *m)
+{
+    double deg = fmod(m->theta * (180 / M_PI) + m->p.hall_offset, 360);
+    return deg < 0 ? deg + 360 : deg;
+}
+
+// The edge between two periods, stamped where the angle crossed the sector boundary
+static void hall_capture(HallEdges *e, const Motor *m, double deg_prev, const MotorSensors &s, uint32_t t_prev)
+{
+    double deg = plant_angle(m);
+    double delta = fmod(deg - deg_prev + 540, 360) - 180;
+    if (delta == 0)
+    {
+        return;
+    }
+    double boundary = delta > 0 ? ceil(deg_prev / 60) * 60 : floor(deg_prev / 60) * 60;
+    double f = (boundary - deg_prev) / delta;
+    f = f < 0 ? 0 : f > 1 ? 1 : f;
+    hall_speed_edge(e, (uint8_t)(s.hall_a << 2 | s.hall_b << 1 | s.hall_c), t_prev + (uint32_t)(f * (HALL_TICK_HZ / PWM_FREQ)));
+}
+
+static double angle_err(int16_t angle, double deg)
+{
+    return fabs(fmod(angle / 16.0 - deg + 540, 360) - 180);
+}
+
+static int lookup(const char *name, const char *const *names, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (strcmp(name, names[i]) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int usage(const char *argv0)
+{
+    fprintf(stderr, "usage: %s [-c com|sin|foc] [-m open|vlt|spd|trq] [-t duration_sec] [-n decimation]\n"
+                    "       [-P name=value ...] [-s script] [-o file.csv] [-r trace.hbt] [-H]\n",
+            argv0);
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    static const char *const ctrl_names[] = {"com", "sin", "foc"};
+    static const char *const mode_names[] = {"open", "vlt", "spd", "trq"};
+    int ctrl_typ = CTRL_TYP_SEL;
+    int ctrl_mod = CTRL_MOD_REQ;
+    double duration = 0;
+    int decimation = 16;
+    const char *script_path = NULL;
+    const char *csv_path = NULL;
+    const char *trace_path = NULL;
+    bool hall = false;
+    MotorParams params;
+    motor_params_default(&params);
+
+    int opt;
+    while ((opt = getopt(argc, argv, "c:m:t:n:P:s:o:r:H")) != -1)
+    {
+        switch (opt)
+        {
+        case 'c':
+            ctrl_typ = lookup(optarg, ctrl_names, 3);
+            if (ctrl_typ < 0)
+            {
+                return usage(argv[0]);
+            }
+            break;
+        case 'm':
+            ctrl_mod = lookup(optarg, mode_names, 4);
+            if (ctrl_mod < 0)
+            {
+                return usage(argv[0]);
+            }
+            break;
+        case 't': duration = atof(optarg); break;
+        case 'n': decimation = atoi(optarg) > 0 ? atoi(optarg) : 1; break;
+        case 'P':
+        {
+            char *eq = strchr(optarg, '=');
+            if (!eq)
+            {
+                return usage(argv[0]);
+            }
+            *eq = 0;
+            if (motor_param_set(&params, optarg, atof(eq + 1)) != 0)
+            {
+                fprintf(stderr, "%s: unknown plant parameter %s\n", argv[0], optarg);
+                return 1;
+            }
+            break;
+        }
+        case 's': script_path = optarg; break;
+        case 'o': csv_path = optarg; break;
+        case 'r': trace_path = optarg; break;
+        case 'H': hall = true; break;
+        default: return usage(argv[0]);
+        }
+    }
+    if (optind != argc)
+    {
+        return usage(argv[0]);
+    }
+
+    std::vector<ScriptPoint> script;
+    if (script_path)
+    {
+        if (!load_script(script_path, script) || script.empty())
+        {
+            fprintf(stderr, "%s: %s: no commands\n", argv[0], script_path);
+            return 1;
+        }
+    }
+    else
+    {
+        script = {{0, 0, 0}, {0.1, 0, 0}, {0.1, 300, 300}, {2, 300, 300}};
+    }
+    if (duration <= 0)
+    {
+        duration = script.back().t > 0 ? script.back().t : 2;
+    }
+    FILE *csv = NULL;
+    if (csv_path)
+    {
+        csv = fopen(csv_path, "w");
+        if (!csv)
+        {
+            fprintf(stderr, "%s: %s: %s\n", argv[0], csv_path, strerror(errno));
+            return 1;
+        }
+        fprintf(csv, "time_s,cmdl,cmdr,n_mot_l,n_mot_r,rpm_l,rpm_r,iq_l,id_l,iq_r,id_r,idc_l,idc_r,err_l,err_r\n");
+    }
+
+    bldc_host_init(ctrl_typ);
+    if (hall)
+    {
+        rtP_Left.b_angleMeasEna = rtP_Right.b_angleMeasEna = 1;
+        bldc_host_reset();
+    }
+    CtrlTrace trace;
+    if (trace_path &&
+        ctrl_trace_create(&trace, trace_path, CTRL_TRACE_LEFT | CTRL_TRACE_RIGHT, CTRL_TRACE_OUTPUTS, &rtP_Left, &rtP_Right) != 0)
+    {
+        fprintf(stderr, "%s: %s: %s\n", argv[0], trace_path, strerror(errno));
+        return 1;
+    }
+    Motor left, right;
+    motor_init(&left, &params);
+    motor_init(&right, &params);
+
+    const double dt = 1.0 / PWM_FREQ;
+    const uint32_t periods = (uint32_t)(duration * PWM_FREQ);
+    const uint32_t main_loop = PWM_FREQ * DELAY_IN_MAIN_LOOP / 1000;
+    const int16_t cur_dc_max = I_DC_MAX * A2BIT_CONV;
+    int16_t cmdL = 0, cmdR = 0;
+    int16_t pwml = 0, pwmr = 0;
+    uint32_t chopped_l = 0, chopped_r = 0;
+    uint8_t err_l = 0, err_r = 0;
+    HallEdges edges_l, edges_r;
+    HallSpeed hall_l, hall_r;
+    double deg_l = plant_angle(&left), deg_r = plant_angle(&right);
+    double angle_err_sum = 0, angle_err_max = 0;
+    uint32_t angle_err_n = 0;
+    {
+        MotorSensors sl, sr;
+        motor_sensors(&left, &sl);
+        motor_sensors(&right, &sr);
+        hall_speed_init(&edges_l, (uint8_t)(sl.hall_a << 2 | sl.hall_b << 1 | sl.hall_c));
+        hall_speed_init(&edges_r, (uint8_t)(sr.hall_a << 2 | sr.hall_b << 1 | sr.hall_c));
+    }
+
+    uint64_t start = now_ns();
+    for (uint32_t n = 0; n < periods; n++)
+    {
+        if (n % main_loop == 0)
+        {
+            // main.c: the mixer output, the right wheel is mounted the other way round
+            script_at(script, n * dt, cmdL, cmdR);
+            pwml = cmdL;
+            pwmr = -cmdR;
+        }
+
+        MotorSensors sl, sr;
+        motor_sensors(&left, &sl);
+        motor_sensors(&right, &sr);
+        // current chopping, level 2 of the current protection
+        int on_l = abs(sl.i_dc) <= cur_dc_max;
+        int on_r = abs(sr.i_dc) <= cur_dc_max;
+        chopped_l += !on_l;
+        chopped_r += !on_r;
+
+        uint8_t enableFin = !rtY_Left.z_errCode && !rtY_Right.z_errCode;
+        if (hall)
+        {
+            const uint32_t now = n * (HALL_TICK_HZ / PWM_FREQ);
+            if (n > 0)
+            {
+                hall_capture(&edges_l, &left, deg_l, sl, now - HALL_TICK_HZ / PWM_FREQ);
+                hall_capture(&edges_r, &right, deg_r, sr, now - HALL_TICK_HZ / PWM_FREQ);
+            }
+            deg_l = plant_angle(&left);
+            deg_r = plant_angle(&right);
+            hall_speed_update(&edges_l, now, HALL_CAPTURE_TIMEOUT * (HALL_TICK_HZ / 1000), rtP_Left.n_polePairs, &hall_l);
+            hall_speed_update(&edges_r, now, HALL_CAPTURE_TIMEOUT * (HALL_TICK_HZ / 1000), rtP_Right.n_polePairs, &hall_r);
+            rtU_Left.a_mechAngle = hall_l.mechAngle;
+            rtU_Right.a_mechAngle = hall_r.mechAngle;
+            if (fabs(motor_rpm(&left)) > 1)
+            {
+                double err = angle_err(hall_l.angle, deg_l);
+                angle_err_sum += err;
+                angle_err_max = err > angle_err_max ? err : angle_err_max;
+                angle_err_n++;
+            }
+        }
+
+        rtU_Left.b_motEna = enableFin;
+        rtU_Left.z_ctrlModReq = ctrl_mod;
+        rtU_Left.r_inpTgt = pwml;
+        rtU_Left.b_hallA = sl.hall_a;
+        rtU_Left.b_hallB = sl.hall_b;
+        rtU_Left.b_hallC = sl.hall_c;
+        rtU_Left.i_phaAB = sl.i_pha_a;
+        rtU_Left.i_phaBC = sl.i_pha_b;
+        rtU_Left.i_DCLink = sl.i_dc;
+        BLDC_controller_step(rtM_Left);
+
+        rtU_Right.b_motEna = enableFin;
+        rtU_Right.z_ctrlModReq = ctrl_mod;
+        rtU_Right.r_inpTgt = pwmr;
+        rtU_Right.b_hallA = sr.hall_a;
+        rtU_Right.b_hallB = sr.hall_b;
+        rtU_Right.b_hallC = sr.hall_c;
+        rtU_Right.i_phaAB = sr.i_pha_b;
+        rtU_Right.i_phaBC = sr.i_pha_c;
+        rtU_Right.i_DCLink = sr.i_dc;
+        BLDC_controller_step(rtM_Right);
+
+        motor_step(&left, rtY_Left.DC_phaA, rtY_Left.DC_phaB, rtY_Left.DC_phaC, on_l, dt);
+        motor_step(&right, rtY_Right.DC_phaA, rtY_Right.DC_phaB, rtY_Right.DC_phaC, on_r, dt);
+
+        if (trace_path)
+        {
+            const ExtU u[2] = {rtU_Left, rtU_Right};
+            const ExtY y[2] = {rtY_Left, rtY_Right};
+            ctrl_trace_write(&trace, u, y);
+        }
+        err_l |= rtY_Left.z_errCode;
+        err_r |= rtY_Right.z_errCode;
+        if (csv && n % decimation == 0)
+        {
+            fprintf(csv, "%.6f,%d,%d,%d,%d,%.1f,%.1f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%u,%u\n",
+                    n * dt, cmdL, cmdR, rtY_Left.n_mot, rtY_Right.n_mot,
+                    motor_rpm(&left), motor_rpm(&right),
+                    rtY_Left.iq / IQ_PER_AMP, rtY_Left.id / IQ_PER_AMP,
+                    rtY_Right.iq / IQ_PER_AMP, rtY_Right.id / IQ_PER_AMP,
+                    left.i_dc, right.i_dc, rtY_Left.z_errCode, rtY_Right.z_errCode);
+        }
+    }
+    double wall = (now_ns() - start) / 1e9;
+
+    if (csv)
+    {
+        fclose(csv);
+    }
+    if (trace_path && ctrl_trace_close(&trace) != 0)
+    {
+        fprintf(stderr, "%s: %s: %s\n", argv[0], trace_path, strerror(errno));
+        return 1;
+    }
+    fprintf(stderr, "%s %s: %.2f s simulated in %.3f s, %.0fx real time\n",
+            ctrl_names[ctrl_typ], mode_names[ctrl_mod], periods * dt, wall, wall > 0 ? periods * dt / wall : 0.0);
+    fprintf(stderr, "chopped periods: left %u right %u, error codes seen: left 0x%02x right 0x%02x\n",
+            chopped_l, chopped_r, err_l, err_r);
+    if (hall)
+    {
+        fprintf(stderr, "hall capture: left angle error mean %.2f max %.2f deg el while moving, speed %.2f rpm\n",
+                angle_err_n ? angle_err_sum / angle_err_n : 0.0, angle_err_max, hall_l.rpm / 16.0);
+    }
+    fprintf(stderr, "final: n_mot_l %d n_mot_r %d rpm_l %.1f rpm_r %.1f\n",
+            rtY_Left.n_mot, rtY_Right.n_mot, motor_rpm(&left), motor_rpm(&right));
+    return 0;
+}
@@ -0,0 +1,180 @@
+/*
+ * Host stand-in for the board state the Limero endpoint reads and writes.
+ *
+ * Only the globals referenced by Src/limero/serial.cpp are provided. The
+ * main-loop input path is reduced to the CONTROL_LIMERO branch of
+ * readInputRaw() followed by a 1:1 mixer, so a speed sent in a
+ * HoverboardRequest shows up unchanged as cmdl/cmdr in the next
+ * HoverboardEvent. That is what limero_bench keys its latency probe on.
+ *
+ * Each main loop pass also runs the 16 kHz periods it spans, with phase
+ * currents that follow the command, so LIMERO_SCOPE captures, LIMERO_STATS
+ * and ENERGY_COUNT have a signal.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "stm32f1xx_hal.h"
+#include "config.h"
+#include "defines.h"
+#include "BLDC_controller.h"
+#include "util.h"
+#include "scope.h"
+#include "isr_stats.h"
+#include "energy.h"
+
+#define CMD_MIN -1000  // INPUT_MIN/INPUT_MAX without field weakening
+#define CMD_MAX 1000
+
+ExtY rtY_Left;
+ExtU rtU_Left;
+P rtP_Left;
+ExtY rtY_Right;
+ExtU rtU_Right;
+P rtP_Right;
+
+// serial.cpp always reports the auxiliary inputs, so keep two slots
+InputStruct input1[2];
+InputStruct input2[2];
+
+int16_t speedAvg;
+int16_t speedAvgAbs;
+uint8_t ctrlModReqRaw = CTRL_MOD_REQ;
+int16_t batVoltageCalib = 3600;  // 36.00 V
+int16_t board_temp_deg_c = 250;  // 25.0 °C
+int16_t left_dc_curr;
+int16_t right_dc_curr;
+int16_t dc_curr;
+int16_t cmdL;
+int16_t cmdR;
+
+// bldc.c
+int16_t curL_phaA, curL_phaB, curL_DC;
+int16_t curR_phaB, curR_phaC, curR_DC;
+uint32_t overrunCnt;
+uint16_t overrunRunMax;
+int16_t offsetDrift;
+uint32_t offsetTrackCnt;
+uint8_t overrunErr;  // main.c
+uint32_t bootReadyMs;
+volatile adc_buf_t adc_buffer;
+
+volatile int16_t limero_steer = 0;
+volatile int16_t limero_speed = 0;
+volatile uint8_t limero_data_fresh = 0;
+
+uint32_t board_cmd_count = 0;  // HoverboardRequests picked up by board_step()
+volatile uint32_t main_loop_counter = 0;
+double board_clock_ppm = 0;  // crystal error of the emulated board (limero_sim -k)
+
+static uint64_t boot_ns;
+
+static uint64_t monotonic_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+uint64_t board_time_us(void)
+{
+  return (uint64_t)((monotonic_ns() - boot_ns) * (1.0 + board_clock_ppm * 1e-6) / 1000);
+}
+
+// serial.cpp stamps every HoverboardRequest for the scheduler of main.c,
+// the emulated main loop steps at DELAY_IN_MAIN_LOOP only
+void sched_trigger(uint8_t id)
+{
+  (void)id;
+}
+
+void board_init(void)
+{
+  boot_ns = monotonic_ns();
+  memset(&rtP_Left, 0, sizeof(rtP_Left));
+  rtP_Left.z_ctrlTypSel = CTRL_TYP_SEL;
+  rtP_Left.i_max = (I_MOT_MAX * A2BIT_CONV) << 4;
+  rtP_Left.n_max = N_MOT_MAX << 4;
+  rtP_Left.b_fieldWeakEna = FIELD_WEAK_ENA;
+  rtP_Left.r_fieldWeakHi = FIELD_WEAK_HI << 4;
+  rtP_Left.r_fieldWeakLo = FIELD_WEAK_LO << 4;
+  rtP_Left.id_fieldWeakMax = (FIELD_WEAK_MAX * A2BIT_CONV) << 4;
+  rtP_Left.a_phaAdvMax = PHASE_ADV_MAX << 4;
+  rtP_Right = rtP_Left;
+
+  input1[0].typ = 2;
+  input2[0].typ = 2;
+  input1[0].min = input2[0].min = CMD_MIN;
+  input1[0].max = input2[0].max = CMD_MAX;
+}
+
+// The DMA1 interrupts of one main loop pass: sine phase currents at an
+// electrical frequency of 15 pole pairs x n_mot / 60, amplitude from the command
+static void isr_periods(void)
+{
+  static double angle_l, angle_r;
+  const int periods = PWM_FREQ * DELAY_IN_MAIN_LOOP / 1000;
+  for (int i = 0; i < periods; i++)
+  {
+    angle_l += 2 * M_PI * 15 * rtY_Left.n_mot / 60.0 / PWM_FREQ;
+    angle_r += 2 * M_PI * 15 * rtY_Right.n_mot / 60.0 / PWM_FREQ;
+    angle_l = fmod(angle_l, 2 * M_PI);
+    angle_r = fmod(angle_r, 2 * M_PI);
+    curL_phaA = (int16_t)(cmdL * sin(angle_l));
+    curL_phaB = (int16_t)(cmdL * sin(angle_l - 2 * M_PI / 3));
+    curR_phaB = (int16_t)(cmdR * sin(angle_r - 2 * M_PI / 3));
+    curR_phaC = (int16_t)(cmdR * sin(angle_r + 2 * M_PI / 3));
+    curL_DC = (int16_t)(-left_dc_curr * A2BIT_CONV / 100);  // main.c: dc_curr = -i_DCLink * 100 / A2BIT_CONV
+    curR_DC = (int16_t)(-right_dc_curr * A2BIT_CONV / 100);
+    rtY_Left.iq = cmdL;
+    rtY_Right.iq = cmdR;
+    rtY_Left.a_elecAngle = (int16_t)(angle_l * 180 / M_PI) << 6;
+    rtY_Right.a_elecAngle = (int16_t)(angle_r * 180 / M_PI) << 6;
+    adc_buffer.batt1 = (uint16_t)(batVoltageCalib * BAT_CALIB_ADC / BAT_CALIB_REAL_VOLTAGE);
+#ifdef LIMERO_SCOPE
+    scope_sample();
+#endif
+#ifdef LIMERO_STATS
+    isr_stats_sample();
+#endif
+#ifdef ENERGY_COUNT
+    energy_sample();
+#endif
+  }
+}
+
+// One pass of the firmware main loop (DELAY_IN_MAIN_LOOP)
+void board_step(void)
+{
+  // handle_rxd() runs in this thread, so the set is consistent without the IRQ lock of readInputRaw()
+  input1[0].raw = limero_steer;
+  input2[0].raw = limero_speed;
+  if (limero_data_fresh)
+  {
+    limero_data_fresh = 0;
+    board_cmd_count++;
+#ifdef LIMERO_ACK
+    extern volatile uint32_t pending_req_id;
+    extern void limero_applied(uint32_t req_id, uint32_t tick);
+    limero_applied(pending_req_id, main_loop_counter);
+#endif
+  }
+  input1[0].cmd = CLAMP(input1[0].raw, CMD_MIN, CMD_MAX);
+  input2[0].cmd = CLAMP(input2[0].raw, CMD_MIN, CMD_MAX);
+
+  cmdL = CLAMP(input2[0].cmd + input1[0].cmd, CMD_MIN, CMD_MAX);
+  cmdR = CLAMP(input2[0].cmd - input1[0].cmd, CMD_MIN, CMD_MAX);
+
+  // ideal plant: wheels follow the command immediately
+  rtY_Left.n_mot = cmdL;
+  rtY_Right.n_mot = -cmdR;
+  speedAvg = (rtY_Left.n_mot - rtY_Right.n_mot) / 2;
+  speedAvgAbs = ABS(speedAvg);
+  left_dc_curr = cmdL / 10;
+  right_dc_curr = cmdR / 10;
+  dc_curr = left_dc_curr + right_dc_curr;
+  isr_periods();
+  main_loop_counter++;
+}
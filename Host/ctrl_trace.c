@@ -0,0 +1,161 @@
+/*
+ * Controller boundary traces, see ctrl_trace.h.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include "ctrl_trace.h"
+
+#define HEADER_SIZE 14
+#define INPUT_SIZE  9
+#define OUTPUT_SIZE 15
+
+static uint8_t *put16(uint8_t *p, int16_t v)
+{
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)((uint16_t)v >> 8);
+  return p + 2;
+}
+
+static const uint8_t *get16(const uint8_t *p, int16_T *v)
+{
+  *v = (int16_T)(p[0] | p[1] << 8);
+  return p + 2;
+}
+
+static size_t row_size(const CtrlTrace *trace)
+{
+  size_t motor = INPUT_SIZE + (trace->flags & CTRL_TRACE_OUTPUTS ? OUTPUT_SIZE : 0);
+  return motor * __builtin_popcount(trace->motors);
+}
+
+static int write_header(CtrlTrace *trace)
+{
+  uint8_t h[HEADER_SIZE] = {'H', 'B', 'C', 'T', CTRL_TRACE_VERSION, 0, trace->motors, trace->flags,
+                            (uint8_t)trace->periods, (uint8_t)(trace->periods >> 8),
+                            (uint8_t)(trace->periods >> 16), (uint8_t)(trace->periods >> 24),
+                            (uint8_t)sizeof(P), (uint8_t)(sizeof(P) >> 8)};
+  if (fseek(trace->file, 0, SEEK_SET) != 0 || fwrite(h, sizeof(h), 1, trace->file) != 1 ||
+      fwrite(trace->params, sizeof(trace->params), 1, trace->file) != 1) {
+    return -1;
+  }
+  return 0;
+}
+
+int ctrl_trace_create(CtrlTrace *trace, const char *path, uint8_t motors, uint8_t flags,
+                      const P *left, const P *right)
+{
+  memset(trace, 0, sizeof(*trace));
+  trace->file = fopen(path, "wb");
+  if (!trace->file) {
+    return -1;
+  }
+  trace->motors = motors;
+  trace->flags = flags;
+  trace->params[0] = *left;
+  trace->params[1] = *right;
+  return write_header(trace);
+}
+
+int ctrl_trace_write(CtrlTrace *trace, const ExtU u[2], const ExtY y[2])
+{
+  uint8_t row[2 * (INPUT_SIZE + OUTPUT_SIZE)];
+  uint8_t *p = row;
+  for (int m = 0; m < 2; m++) {
+    if (!(trace->motors & (1 << m))) {
+      continue;
+    }
+    *p++ = (u[m].b_hallA & 1) | (u[m].b_hallB & 1) << 1 | (u[m].b_hallC & 1) << 2 |
+           (u[m].b_motEna & 1) << 3 | (u[m].z_ctrlModReq & 3) << 4;
+    p = put16(p, u[m].r_inpTgt);
+    p = put16(p, u[m].i_phaAB);
+    p = put16(p, u[m].i_phaBC);
+    p = put16(p, u[m].i_DCLink);
+    if (trace->flags & CTRL_TRACE_OUTPUTS) {
+      p = put16(p, y[m].DC_phaA);
+      p = put16(p, y[m].DC_phaB);
+      p = put16(p, y[m].DC_phaC);
+      p = put16(p, y[m].n_mot);
+      p = put16(p, y[m].a_elecAngle);
+      p = put16(p, y[m].iq);
+      p = put16(p, y[m].id);
+      *p++ = y[m].z_errCode;
+    }
+  }
+  if (fwrite(row, p - row, 1, trace->file) != 1) {
+    return -1;
+  }
+  trace->periods++;
+  return 0;
+}
+
+int ctrl_trace_close(CtrlTrace *trace)
+{
+  int rc = 0;
+  if (trace->file) {
+    // rows are only appended, the count goes into the header at the end
+    rc = write_header(trace);
+    if (fclose(trace->file) != 0) {
+      rc = -1;
+    }
+    trace->file = NULL;
+  }
+  return rc;
+}
+
+int ctrl_trace_open(CtrlTrace *trace, const char *path)
+{
+  uint8_t h[HEADER_SIZE];
+  memset(trace, 0, sizeof(*trace));
+  trace->file = fopen(path, "rb");
+  if (!trace->file) {
+    return -1;
+  }
+  if (fread(h, sizeof(h), 1, trace->file) != 1 || memcmp(h, "HBCT", 4) != 0 ||
+      (h[4] | h[5] << 8) != CTRL_TRACE_VERSION || (h[12] | h[13] << 8) != sizeof(P) ||
+      fread(trace->params, sizeof(trace->params), 1, trace->file) != 1) {
+    fclose(trace->file);
+    trace->file = NULL;
+    errno = EINVAL;
+    return -1;
+  }
+  trace->motors = h[6] & (CTRL_TRACE_LEFT | CTRL_TRACE_RIGHT);
+  trace->flags = h[7];
+  trace->periods = h[8] | h[9] << 8 | h[10] << 16 | (uint32_t)h[11] << 24;
+  return 0;
+}
+
+int ctrl_trace_read(CtrlTrace *trace, ExtU u[2], ExtY y[2])
+{
+  uint8_t row[2 * (INPUT_SIZE + OUTPUT_SIZE)];
+  if (fread(row, row_size(trace), 1, trace->file) != 1) {
+    return 0;
+  }
+  const uint8_t *p = row;
+  for (int m = 0; m < 2; m++) {
+    if (!(trace->motors & (1 << m))) {
+      continue;
+    }
+    uint8_t bits = *p++;
+    u[m].b_hallA = bits & 1;
+    u[m].b_hallB = bits >> 1 & 1;
+    u[m].b_hallC = bits >> 2 & 1;
+    u[m].b_motEna = bits >> 3 & 1;
+    u[m].z_ctrlModReq = bits >> 4 & 3;
+    p = get16(p, &u[m].r_inpTgt);
+    p = get16(p, &u[m].i_phaAB);
+    p = get16(p, &u[m].i_phaBC);
+    p = get16(p, &u[m].i_DCLink);
+    if (trace->flags & CTRL_TRACE_OUTPUTS) {
+      p = get16(p, &y[m].DC_phaA);
+      p = get16(p, &y[m].DC_phaB);
+      p = get16(p, &y[m].DC_phaC);
+      p = get16(p, &y[m].n_mot);
+      p = get16(p, &y[m].a_elecAngle);
+      p = get16(p, &y[m].iq);
+      p = get16(p, &y[m].id);
+      y[m].z_errCode = *p++;
+    }
+  }
+  return 1;
+}
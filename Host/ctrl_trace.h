@@ -0,0 +1,59 @@
+/*
+ * Controller boundary traces: the ExtU inputs of both BLDC controllers for
+ * every 16 kHz period, optionally with the ExtY outputs they produced.
+ *
+ * File layout, little endian:
+ *   "HBCT", version (u16), motors (u8, bit 0 left, bit 1 right),
+ *   flags (u8, CTRL_TRACE_OUTPUTS), periods (u32), sizeof(P) (u16),
+ *   rtP_Left and rtP_Right as the host lays them out,
+ *   then one row per period: for each motor in the mask its inputs
+ *   (9 bytes) followed by its outputs (15 bytes) when flagged.
+ *
+ * Inputs: b_hallA | b_hallB << 1 | b_hallC << 2 | b_motEna << 3 |
+ * z_ctrlModReq << 4 in one byte, then r_inpTgt, i_phaAB, i_phaBC, i_DCLink.
+ * Outputs: DC_phaA, DC_phaB, DC_phaC, n_mot, a_elecAngle, iq, id, z_errCode.
+ * a_mechAngle is not recorded, the firmware does not feed it.
+ */
+
+#ifndef CTRL_TRACE_H
+#define CTRL_TRACE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "BLDC_controller.h"
+
+#define CTRL_TRACE_VERSION  1
+#define CTRL_TRACE_LEFT     0x01
+#define CTRL_TRACE_RIGHT    0x02
+#define CTRL_TRACE_OUTPUTS  0x01
+
+typedef struct {
+  FILE    *file;
+  uint8_t  motors;
+  uint8_t  flags;
+  uint32_t periods;     // rows in the file, rows written so far when writing
+  P        params[2];   // left, right
+} CtrlTrace;
+
+// Writing: periods is filled in by ctrl_trace_close()
+int  ctrl_trace_create(CtrlTrace *trace, const char *path, uint8_t motors, uint8_t flags,
+                       const P *left, const P *right);
+// u and y are indexed left, right; y is ignored without CTRL_TRACE_OUTPUTS
+int  ctrl_trace_write(CtrlTrace *trace, const ExtU u[2], const ExtY y[2]);
+int  ctrl_trace_close(CtrlTrace *trace);
+
+// Reading: 0 on success, -1 with errno EINVAL for a file that is not a trace
+int  ctrl_trace_open(CtrlTrace *trace, const char *path);
+// 1 for a row, 0 at the end; motors not in the trace are left untouched
+int  ctrl_trace_read(CtrlTrace *trace, ExtU u[2], ExtY y[2]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
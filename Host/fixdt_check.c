@@ -0,0 +1,248 @@
+/*
+ * fixdt_check : BLDC_controller_fast.c against the generated helpers.
+ *
+ *   fixdt_check [-n iterations] [-s seed]
+ *
+ * The prelookups are run for every input value over a set of breakpoint
+ * origins and spacings (powers of two and the odd spacings the controller
+ * uses), div_nde_s32_floor() for every numerator the angle measurement can
+ * produce. Everything else gets -n random cases (10000000), one in eight of
+ * the values taken from the range limits. Outputs and the complete state
+ * after the call have to match bit for bit. Exits with 1 at the first
+ * difference and prints the inputs.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "BLDC_controller.h"
+
+#define REF_DECL(ret, name, args) ret name args; ret ref_##name args;
+REF_DECL(uint8_T, plook_u8s16_evencka, (int16_T u, int16_T bp0, uint16_T bpSpace, uint32_T maxIndex))
+REF_DECL(uint8_T, plook_u8u16_evencka, (uint16_T u, uint16_T bp0, uint16_T bpSpace, uint32_T maxIndex))
+REF_DECL(int32_T, div_nde_s32_floor, (int32_T numerator, int32_T denominator))
+REF_DECL(int16_T, Counter, (int16_T rtu_inc, int16_T rtu_max, boolean_T rtu_rst, DW_Counter *localDW))
+REF_DECL(void, Low_Pass_Filter, (const int16_T rtu_u[2], uint16_T rtu_coef, int16_T rty_y[2], DW_Low_Pass_Filter *localDW))
+REF_DECL(void, I_backCalc_fixdt, (int16_T rtu_err, uint16_T rtu_I, uint16_T rtu_Kb, int16_T rtu_satMax,
+                                  int16_T rtu_satMin, int16_T *rty_out, DW_I_backCalc_fixdt *localDW))
+REF_DECL(void, PI_clamp_fixdt, (int16_T rtu_err, uint16_T rtu_P, uint16_T rtu_I, int32_T rtu_init, int16_T rtu_satMax,
+                                int16_T rtu_satMin, int32_T rtu_ext_limProt, int16_T *rty_out, DW_PI_clamp_fixdt *localDW))
+REF_DECL(void, PI_clamp_fixdt_l, (int16_T rtu_err, uint16_T rtu_P, uint16_T rtu_I, int16_T rtu_init, int16_T rtu_satMax,
+                                  int16_T rtu_satMin, int32_T rtu_ext_limProt, int16_T *rty_out, DW_PI_clamp_fixdt_m *localDW))
+REF_DECL(void, PI_clamp_fixdt_k, (int16_T rtu_err, uint16_T rtu_P, uint16_T rtu_I, int16_T rtu_init, int16_T rtu_satMax,
+                                  int16_T rtu_satMin, int32_T rtu_ext_limProt, int16_T *rty_out, DW_PI_clamp_fixdt_g *localDW))
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint32_t rnd(void)
+{
+  // xorshift64*
+  rng_state ^= rng_state >> 12;
+  rng_state ^= rng_state << 25;
+  rng_state ^= rng_state >> 27;
+  return (uint32_t)((rng_state * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+// random value of the given width, one in eight from the edges of the range
+static int32_t rnd_s(int bits)
+{
+  static const int32_t edges[] = {0, 1, -1, 2, -2};
+  uint32_t r = rnd();
+  int32_t max = bits == 32 ? INT32_MAX : (1 << (bits - 1)) - 1;
+  int32_t min = -max - 1;
+  if ((r & 7) == 0) {
+    uint32_t e = (r >> 3) % 9;
+    return e < 5 ? edges[e] : e == 5 ? max : e == 6 ? min : e == 7 ? max - 1 : min + 1;
+  }
+  r = rnd();
+  return bits == 32 ? (int32_t)r : (int32_t)(r << (32 - bits)) >> (32 - bits);
+}
+
+static uint32_t rnd_u(int bits)
+{
+  uint32_t r = rnd();
+  if ((r & 7) == 0) {
+    uint32_t e = (r >> 3) % 4;
+    uint32_t max = bits == 32 ? UINT32_MAX : (1U << bits) - 1;
+    return e == 0 ? 0 : e == 1 ? 1 : e == 2 ? max : max - 1;
+  }
+  r = rnd();
+  return bits == 32 ? r : r & ((1U << bits) - 1);
+}
+
+static unsigned long long checked;
+
+#define FAIL(...) do { fprintf(stderr, "fixdt_check: MISMATCH " __VA_ARGS__); exit(1); } while (0)
+
+static void check_plook(void)
+{
+  static const int16_T bp0s[] = {-32768, -1000, -1, 0, 1, 500, 32766, 32767};
+  static const uint16_T spaces[] = {1, 2, 3, 7, 64, 100, 128, 255, 256, 1311, 4096, 32768, 40000, 65535};
+  static const uint32_T max_idx[] = {0, 45, 49, 180, 255};
+  for (size_t b = 0; b < sizeof(bp0s) / sizeof(bp0s[0]); b++) {
+    for (size_t s = 0; s < sizeof(spaces) / sizeof(spaces[0]); s++) {
+      for (size_t m = 0; m < sizeof(max_idx) / sizeof(max_idx[0]); m++) {
+        for (int32_t u = -32768; u <= 32767; u++) {
+          uint8_T ref = ref_plook_u8s16_evencka(u, bp0s[b], spaces[s], max_idx[m]);
+          uint8_T got = plook_u8s16_evencka(u, bp0s[b], spaces[s], max_idx[m]);
+          if (ref != got) {
+            FAIL("plook_u8s16_evencka(%d, %d, %u, %u): %u != %u\n", u, bp0s[b], spaces[s], max_idx[m], got, ref);
+          }
+          uint16_T uu = (uint16_T)u;
+          uint16_T bu = (uint16_T)bp0s[b];
+          ref = ref_plook_u8u16_evencka(uu, bu, spaces[s], max_idx[m]);
+          got = plook_u8u16_evencka(uu, bu, spaces[s], max_idx[m]);
+          if (ref != got) {
+            FAIL("plook_u8u16_evencka(%u, %u, %u, %u): %u != %u\n", uu, bu, spaces[s], max_idx[m], got, ref);
+          }
+          checked += 2;
+        }
+      }
+    }
+  }
+}
+
+static void check_div(long n)
+{
+  // the electrical angle: int16 << 4 numerators over 5760
+  for (int32_t x = -32768 * 16; x < 32768 * 16; x++) {
+    if (ref_div_nde_s32_floor(x, 5760) != div_nde_s32_floor(x, 5760)) {
+      FAIL("div_nde_s32_floor(%d, 5760)\n", x);
+    }
+    checked++;
+  }
+  for (long i = 0; i < n; i++) {
+    int32_t num = rnd_s(32);
+    int32_t den = rnd_s(rnd() & 1 ? 32 : 16);
+    if (den == 0 || (num == INT32_MIN && den == -1)) {
+      continue;   // undefined for both
+    }
+    int32_t ref = ref_div_nde_s32_floor(num, den);
+    int32_t got = div_nde_s32_floor(num, den);
+    if (ref != got) {
+      FAIL("div_nde_s32_floor(%d, %d): %d != %d\n", num, den, got, ref);
+    }
+    checked++;
+  }
+}
+
+static void check_counter(long n)
+{
+  for (long i = 0; i < n; i++) {
+    DW_Counter ref_dw, dw;
+    memset(&ref_dw, 0, sizeof(ref_dw));
+    ref_dw.UnitDelay_DSTATE = rnd_s(16);
+    dw = ref_dw;
+    int16_T inc = rnd_s(16), max = rnd_s(16);
+    boolean_T rst = rnd() & 1;
+    int16_T ref = ref_Counter(inc, max, rst, &ref_dw);
+    int16_T got = Counter(inc, max, rst, &dw);
+    if (ref != got || memcmp(&ref_dw, &dw, sizeof(dw))) {
+      FAIL("Counter(%d, %d, %d) state %d\n", inc, max, rst, ref_dw.UnitDelay_DSTATE);
+    }
+    checked++;
+  }
+}
+
+static void check_lpf(long n)
+{
+  for (long i = 0; i < n; i++) {
+    DW_Low_Pass_Filter ref_dw, dw;
+    memset(&ref_dw, 0, sizeof(ref_dw));
+    ref_dw.UnitDelay1_DSTATE[0] = rnd_s(32);
+    ref_dw.UnitDelay1_DSTATE[1] = rnd_s(32);
+    DW_Low_Pass_Filter in = ref_dw;
+    dw = ref_dw;
+    int16_T u[2] = {(int16_T)rnd_s(16), (int16_T)rnd_s(16)};
+    uint16_T coef = rnd_u(16);
+    int16_T ref_y[2], y[2];
+    ref_Low_Pass_Filter(u, coef, ref_y, &ref_dw);
+    Low_Pass_Filter(u, coef, y, &dw);
+    if (memcmp(ref_y, y, sizeof(y)) || memcmp(&ref_dw, &dw, sizeof(dw))) {
+      FAIL("Low_Pass_Filter({%d, %d}, %u) state {%d, %d}\n", u[0], u[1], coef,
+           in.UnitDelay1_DSTATE[0], in.UnitDelay1_DSTATE[1]);
+    }
+    checked++;
+  }
+}
+
+static void check_backcalc(long n)
+{
+  for (long i = 0; i < n; i++) {
+    DW_I_backCalc_fixdt ref_dw, dw;
+    memset(&ref_dw, 0, sizeof(ref_dw));
+    ref_dw.UnitDelay_DSTATE = rnd_s(32);
+    ref_dw.UnitDelay_DSTATE_m = rnd_s(32);
+    DW_I_backCalc_fixdt in = ref_dw;
+    dw = ref_dw;
+    int16_T err = rnd_s(16), sat_max = rnd_s(16), sat_min = rnd_s(16);
+    uint16_T gain_i = rnd_u(16), gain_b = rnd_u(16);
+    int16_T ref_out, out;
+    ref_I_backCalc_fixdt(err, gain_i, gain_b, sat_max, sat_min, &ref_out, &ref_dw);
+    I_backCalc_fixdt(err, gain_i, gain_b, sat_max, sat_min, &out, &dw);
+    if (ref_out != out || memcmp(&ref_dw, &dw, sizeof(dw))) {
+      FAIL("I_backCalc_fixdt(%d, %u, %u, %d, %d) state {%d, %d}\n", err, gain_i, gain_b, sat_max, sat_min,
+           in.UnitDelay_DSTATE, in.UnitDelay_DSTATE_m);
+    }
+    checked++;
+  }
+}
+
+// the three PI variants share the input generation
+#define CHECK_PI(fn, dw_type, init_bits, state_bits)                                                      \
+  static void check_##fn(long n)                                                                       \
+  {                                                                                                    \
+    for (long i = 0; i < n; i++) {                                                                     \
+      dw_type ref_dw, dw;                                                                              \
+      memset(&ref_dw, 0, sizeof(ref_dw));                                                              \
+      ref_dw.ResettableDelay_DSTATE = rnd_s(state_bits);                                               \
+      ref_dw.icLoad = (rnd() & 3) == 0;                                                                \
+      ref_dw.UnitDelay1_DSTATE = rnd() & 1;                                                            \
+      dw_type in = ref_dw;                                                                             \
+      dw = ref_dw;                                                                                     \
+      int16_T err = rnd_s(16), sat_max = rnd_s(16), sat_min = rnd_s(16);                              \
+      uint16_T gain_p = rnd_u(16), gain_i = rnd_u(16);                                                 \
+      int32_T init = rnd_s(init_bits), lim_prot = rnd_s(32);                                           \
+      int16_T ref_out, out;                                                                            \
+      ref_##fn(err, gain_p, gain_i, init, sat_max, sat_min, lim_prot, &ref_out, &ref_dw);              \
+      fn(err, gain_p, gain_i, init, sat_max, sat_min, lim_prot, &out, &dw);                            \
+      if (ref_out != out || memcmp(&ref_dw, &dw, sizeof(dw))) {                                        \
+        FAIL(#fn "(%d, %u, %u, %d, %d, %d, %d) state {%d, %u, %u}: %d != %d\n", err, gain_p, gain_i,  \
+             init, sat_max, sat_min, lim_prot, (int)in.ResettableDelay_DSTATE, in.icLoad,              \
+             in.UnitDelay1_DSTATE, out, ref_out);                                                      \
+      }                                                                                                \
+      checked++;                                                                                       \
+    }                                                                                                  \
+  }
+
+CHECK_PI(PI_clamp_fixdt, DW_PI_clamp_fixdt, 32, 32)
+CHECK_PI(PI_clamp_fixdt_l, DW_PI_clamp_fixdt_m, 16, 32)
+CHECK_PI(PI_clamp_fixdt_k, DW_PI_clamp_fixdt_g, 16, 16)
+
+int main(int argc, char **argv)
+{
+  long n = 10000000;
+  int opt;
+  while ((opt = getopt(argc, argv, "n:s:")) != -1) {
+    switch (opt) {
+    case 'n': n = atol(optarg); break;
+    case 's': rng_state = strtoull(optarg, NULL, 0) | 1; break;
+    default:
+      fprintf(stderr, "usage: %s [-n iterations] [-s seed]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  check_plook();
+  check_div(n);
+  check_counter(n);
+  check_lpf(n);
+  check_backcalc(n);
+  check_PI_clamp_fixdt(n);
+  check_PI_clamp_fixdt_l(n);
+  check_PI_clamp_fixdt_k(n);
+  printf("fixdt_check: %llu cases bit-exact\n", checked);
+  return 0;
+}
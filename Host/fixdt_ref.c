@@ -0,0 +1,16 @@
+/*
+ * The generated helpers of Src/BLDC_controller.c under ref_ names, so
+ * fixdt_check can run them next to the BLDC_controller_fast.c versions.
+ */
+
+#define plook_u8s16_evencka ref_plook_u8s16_evencka
+#define plook_u8u16_evencka ref_plook_u8u16_evencka
+#define div_nde_s32_floor   ref_div_nde_s32_floor
+#define Counter             ref_Counter
+#define Low_Pass_Filter     ref_Low_Pass_Filter
+#define I_backCalc_fixdt    ref_I_backCalc_fixdt
+#define PI_clamp_fixdt      ref_PI_clamp_fixdt
+#define PI_clamp_fixdt_l    ref_PI_clamp_fixdt_l
+#define PI_clamp_fixdt_k    ref_PI_clamp_fixdt_k
+
+#include "BLDC_controller_host.c"
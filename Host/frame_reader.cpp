@@ -0,0 +1,68 @@
+#include <limero/batch.h>
+#include "frame_reader.h"
+
+FrameReader::FrameReader(uint32_t capacity) : _decoder(capacity), _discard(false), _frame_bytes(0)
+{
+}
+
+void FrameReader::feed(const uint8_t *data, size_t size, Handler handler)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        _frame_bytes++;
+        if (data[i] == 0x00)
+        {
+            _stats.frames++;
+            if (!_discard)
+            {
+                frame(handler);
+            }
+            _decoder.rewind();
+            _discard = false;
+            _frame_bytes = 0;
+        }
+        else if (!_discard && _decoder.add_byte(data[i]).is_err())
+        {
+            _stats.oversize++;
+            _discard = true;
+        }
+    }
+    _stats.bytes += size;
+}
+
+void FrameReader::frame(Handler &handler)
+{
+    if (_decoder.decode_cobs().is_err())
+    {
+        _stats.cobs_errors++;
+        return;
+    }
+    if (_decoder.check_crc().is_err())
+    {
+        _stats.crc_errors++;
+        return;
+    }
+    Buffer cbor_buffer(_decoder.data(), _decoder.capacity(), _decoder.size() - 2);
+    Envelope envelope;
+    if (envelope.decode(cbor_buffer) != 0)
+    {
+        _stats.decode_errors++;
+        return;
+    }
+    if (envelope.msg_type && envelope.payload)
+    {
+        _stats.messages++;
+        handler(*envelope.msg_type, Buffer(*envelope.payload));
+        return;
+    }
+    BatchEnvelope batch;
+    if (batch.decode(cbor_buffer) != 0 ||
+        batch_for_each(batch, [&](uint32_t msg_type, const Buffer &payload)
+                       {
+                           _stats.messages++;
+                           handler(msg_type, payload);
+                       }) != 0)
+    {
+        _stats.decode_errors++;
+    }
+}
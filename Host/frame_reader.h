@@ -0,0 +1,46 @@
+/*
+ * FrameReader : byte stream -> COBS frames -> (msg_type, payload) pairs.
+ *
+ * Handles plain Envelopes and BatchEnvelopes alike and keeps the error
+ * counters every host tool reports.
+ */
+#ifndef FRAME_READER_H
+#define FRAME_READER_H
+
+#include <stdint.h>
+#include <functional>
+#include <limero/codec.h>
+#include <limero/msgs_hoverboard.h>
+
+struct FrameStats
+{
+    uint64_t frames = 0;   // frame delimiters seen
+    uint64_t bytes = 0;
+    uint64_t cobs_errors = 0;
+    uint64_t crc_errors = 0;
+    uint64_t decode_errors = 0;
+    uint64_t oversize = 0; // frame longer than the receive buffer
+    uint64_t messages = 0; // messages handed out, > frames when batched
+};
+
+class FrameReader
+{
+public:
+    typedef std::function<void(uint32_t msg_type, const Buffer &payload)> Handler;
+
+    FrameReader(uint32_t capacity = 256);
+    void feed(const uint8_t *data, size_t size, Handler handler);
+    const FrameStats &stats() const { return _stats; }
+    // wire size of the frame being handled, delimiter included; valid inside the handler
+    uint32_t frame_bytes() const { return _frame_bytes; }
+
+private:
+    FrameDecoder _decoder;
+    bool _discard; // rest of an oversize frame
+    uint32_t _frame_bytes;
+    FrameStats _stats;
+
+    void frame(Handler &handler);
+};
+
+#endif
@@ -0,0 +1,198 @@
+/*
+ * hall_check : Src/hall_speed.c on synthetic hall traces.
+ *
+ *   hall_check [-v]
+ *
+ * Each scenario moves a rotor along a speed profile in 1 us steps and turns
+ * its electrical angle into the three hall levels, optionally with sensor
+ * mounting errors. Edges are stamped twice:
+ *  - capture: at the 1 us step they happen in, like the EXTI interrupts
+ *  - sampled: at the next 16 kHz period, like the GPIO reads of the DMA
+ *    interrupt
+ * and each stamp set feeds its own estimator. Every 16 kHz period both are
+ * compared with the true speed and angle, on the ramps the angle only from
+ * ANGLE_RPM on. The summary has one line per scenario with the mean and max
+ * speed and angle errors of both; -v prints every 1000th period.
+ *
+ * Exits with 1 if a captured estimate is outside the limits of its
+ * scenario, or a stopped rotor does not read 0 rpm at the end.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "hall_speed.h"
+
+#define POLE_PAIRS  15
+#define PERIOD      (HALL_TICK_HZ / 16000)          // ticks per 16 kHz period
+#define STEP        (HALL_TICK_HZ / 1000000)        // ticks per simulation step
+#define TIMEOUT     (HALL_TICK_HZ)                  // 1 s, HALL_CAPTURE_TIMEOUT 1000
+#define ANGLE_RPM   20                              // [rpm] compare the angle from here, a sector takes 33 ms
+
+// the inverse of vec_hallToPos
+static const uint8_t hall_of_pos[6] = {2, 3, 1, 5, 4, 6};
+
+typedef struct {
+  const char *name;
+  double rpm0, rpm1;      // speed at the start and the end, linear in between
+  double ramp;            // [s] duration of the ramp, hold rpm1 afterwards
+  double duration;        // [s]
+  double mount[3];        // [deg el] edge offsets of the three sensors
+  double skip;            // [s] leave out the speed check until here
+  double max_rpm_err;     // [rpm] mean speed error limit, captured
+  double max_angle_mean;  // [deg el] mean angle error limit, captured
+  double max_angle_err;   // [deg el] angle error limit, captured
+} Scenario;
+
+/*
+ * The ramps lag by half the averaged HALL_SPEED_EDGES sectors, which is long
+ * at low speed, and the angle is only held at the sector edge around a
+ * reversal. Both are limits of the hall information: the sampled estimator
+ * does no better there. Their angle is compared from ANGLE_RPM on, the
+ * limits are about 10 % above the errors of the current estimator.
+ */
+static const Scenario scenarios[] = {
+  {"2 rpm",          2,    2,    0,   3.0, {0, 0, 0},  1.0, 0.05, 0.2, 1},
+  {"20 rpm",        20,   20,    0,   1.0, {0, 0, 0},  0.2, 0.05, 0.2, 1},
+  {"300 rpm",      300,  300,    0,   0.5, {0, 0, 0},  0.1, 0.1,  0.2, 1},
+  {"1000 rpm",    1000, 1000,    0,   0.5, {0, 0, 0},  0.1, 0.1,  0.2, 1},
+  {"-300 rpm",    -300, -300,    0,   0.5, {0, 0, 0},  0.1, 0.1,  0.2, 1},
+  {"mount 3 deg",  100,  100,    0,   1.0, {3, -2, 1}, 0.2, 0.1,  2.5, 4},
+  {"0..300 rpm",     0,  300,  1.0,   1.0, {0, 0, 0},  0.1, 6.5,  2.3, 22},
+  {"300..0 rpm",   300,    0,  1.0,   2.5, {0, 0, 0},  0.1, 3.5,  2.3, 26},
+  {"100..-100 rpm", 100, -100, 1.0,   1.0, {0, 0, 0},  0.1, 10.5, 5.7, 26},
+};
+
+typedef struct {
+  HallEdges edges;
+  HallSpeed est;
+  double rpm_err_sum, rpm_err_max, angle_err_sum, angle_err_max;
+  long n, n_angle;
+} Run;
+
+static double rpm_at(const Scenario *s, double t)
+{
+  if (t >= s->ramp) {
+    return s->rpm1;
+  }
+  return s->rpm0 + (s->rpm1 - s->rpm0) * t / s->ramp;
+}
+
+// hall position of electrical angle theta [deg], sector boundary k moved by the error of sensor k % 3
+static uint8_t pos_of(const Scenario *s, double theta)
+{
+  double k = floor(theta / 60 + 0.5);
+  int sensor = ((int)fmod(k, 3) + 3) % 3;
+  int pos = (int)floor((theta - s->mount[sensor]) / 60);
+  return (uint8_t)(((pos % 6) + 6) % 6);
+}
+
+static double angle_diff(double a, double b)
+{
+  double d = fmod(a - b, 360);
+  if (d > 180) {
+    d -= 360;
+  } else if (d < -180) {
+    d += 360;
+  }
+  return fabs(d);
+}
+
+static void compare(Run *r, const Scenario *s, double t, double rpm, double theta)
+{
+  if (t < s->skip) {
+    return;
+  }
+  double rpm_err = fabs(r->est.rpm / 16.0 - rpm);
+  r->rpm_err_sum += rpm_err;
+  if (rpm_err > r->rpm_err_max) {
+    r->rpm_err_max = rpm_err;
+  }
+  // below ANGLE_RPM on a ramp the sectors in the average are much longer than the current one
+  if (s->rpm0 == s->rpm1 || fabs(rpm) >= ANGLE_RPM) {
+    double angle_err = angle_diff(r->est.angle / 16.0, theta);
+    r->angle_err_sum += angle_err;
+    r->n_angle++;
+    if (angle_err > r->angle_err_max) {
+      r->angle_err_max = angle_err;
+    }
+  }
+  r->n++;
+}
+
+static int run_scenario(const Scenario *s, int verbose)
+{
+  Run cap, smp;
+  memset(&cap, 0, sizeof(cap));
+  memset(&smp, 0, sizeof(smp));
+  double theta = 0;   // [deg el]
+  uint8_t pos = pos_of(s, theta);
+  hall_speed_init(&cap.edges, hall_of_pos[pos]);
+  hall_speed_init(&smp.edges, hall_of_pos[pos]);
+  uint8_t pos_sampled = pos;
+
+  const uint32_t steps = (uint32_t)(s->duration * 1e6);
+  for (uint32_t i = 1; i <= steps; i++) {
+    uint32_t now = i * STEP;
+    double t = (double)now / HALL_TICK_HZ;
+    theta += rpm_at(s, t) / 60 * 360 * POLE_PAIRS * STEP / HALL_TICK_HZ;
+    uint8_t p = pos_of(s, theta);
+    if (p != pos) {
+      hall_speed_edge(&cap.edges, hall_of_pos[p], now);
+      pos = p;
+    }
+    if (now % PERIOD == 0) {
+      if (pos != pos_sampled) {
+        hall_speed_edge(&smp.edges, hall_of_pos[pos], now);
+        pos_sampled = pos;
+      }
+      double rpm = rpm_at(s, t);
+      double theta_mod = fmod(fmod(theta, 360) + 360, 360);
+      hall_speed_update(&cap.edges, now, TIMEOUT, POLE_PAIRS, &cap.est);
+      hall_speed_update(&smp.edges, now, TIMEOUT, POLE_PAIRS, &smp.est);
+      compare(&cap, s, t, rpm, theta_mod);
+      compare(&smp, s, t, rpm, theta_mod);
+      if (verbose && (now / PERIOD) % 1000 == 0) {
+        printf("  %-14s t %.3f rpm %8.3f angle %6.1f | capture %8.3f %6.1f | sampled %8.3f %6.1f\n",
+               s->name, t, rpm, theta_mod, cap.est.rpm / 16.0, cap.est.angle / 16.0,
+               smp.est.rpm / 16.0, smp.est.angle / 16.0);
+      }
+    }
+  }
+
+  double cap_mean = cap.n ? cap.rpm_err_sum / cap.n : 0;
+  double smp_mean = smp.n ? smp.rpm_err_sum / smp.n : 0;
+  double cap_angle = cap.n_angle ? cap.angle_err_sum / cap.n_angle : 0;
+  double smp_angle = smp.n_angle ? smp.angle_err_sum / smp.n_angle : 0;
+  int ok = cap_mean <= s->max_rpm_err && cap_angle <= s->max_angle_mean && cap.angle_err_max <= s->max_angle_err;
+  if (s->rpm1 == 0 && cap.est.rpm != 0) {
+    ok = 0;                 // stopped for longer than TIMEOUT
+  }
+  printf("%-14s capture: rpm err mean %7.3f max %8.3f angle err mean %5.2f max %5.1f | sampled: %7.3f %8.3f %5.2f %5.1f  %s\n",
+         s->name, cap_mean, cap.rpm_err_max, cap_angle, cap.angle_err_max,
+         smp_mean, smp.rpm_err_max, smp_angle, smp.angle_err_max, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+int main(int argc, char **argv)
+{
+  int verbose = 0;
+  int opt;
+  while ((opt = getopt(argc, argv, "v")) != -1) {
+    switch (opt) {
+    case 'v': verbose = 1; break;
+    default:
+      fprintf(stderr, "usage: %s [-v]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  int failed = 0;
+  for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+    failed += !run_scenario(&scenarios[i], verbose);
+  }
+  printf("hall_check: %d of %zu scenarios failed\n", failed, sizeof(scenarios) / sizeof(scenarios[0]));
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,70 @@
+/*
+ * HoverboardEvent fields recorded by limero_rec, one column each.
+ * Append new fields at the end; logs store the column names, so older
+ * files stay readable.
+ */
+#ifndef HB_EVENT_COLUMNS_H
+#define HB_EVENT_COLUMNS_H
+
+#define HB_EVENT_COLUMNS(X) \
+    X(ctrl_mod) \
+    X(ctrl_typ) \
+    X(cur_mot_max) \
+    X(rpm_mot_max) \
+    X(fi_weak_ena) \
+    X(fi_weak_hi) \
+    X(fi_weak_lo) \
+    X(fi_weak_max) \
+    X(phase_adv_max_deg) \
+    X(input1_raw) \
+    X(input1_typ) \
+    X(input1_min) \
+    X(input1_mid) \
+    X(input1_max) \
+    X(input1_cmd) \
+    X(input2_raw) \
+    X(input2_typ) \
+    X(input2_min) \
+    X(input2_mid) \
+    X(input2_max) \
+    X(input2_cmd) \
+    X(aux_input1_raw) \
+    X(aux_input1_typ) \
+    X(aux_input1_min) \
+    X(aux_input1_mid) \
+    X(aux_input1_max) \
+    X(aux_input1_cmd) \
+    X(aux_input2_raw) \
+    X(aux_input2_typ) \
+    X(aux_input2_min) \
+    X(aux_input2_mid) \
+    X(aux_input2_max) \
+    X(aux_input2_cmd) \
+    X(dc_curr) \
+    X(rdc_curr) \
+    X(ldc_curr) \
+    X(cmdl) \
+    X(cmdr) \
+    X(spd_avg) \
+    X(spdl) \
+    X(spdr) \
+    X(filter_rate) \
+    X(spd_coef) \
+    X(str_coef) \
+    X(batv) \
+    X(temp) \
+    X(req_gaps) \
+    X(req_superseded) \
+    X(time_us) \
+    X(overruns) \
+    X(overrun_run_max) \
+    X(overrun_err) \
+    X(offset_drift) \
+    X(offset_track_ms) \
+    X(boot_ms) \
+    X(offsets_stored) \
+    X(hall_rpm_l) \
+    X(hall_rpm_r) \
+    X(isr_stats_periods)
+
+#endif
@@ -0,0 +1,197 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "hb_log.h"
+#include "host_util.h"
+
+// Address space reserved for a log being written; the file itself grows a block at a time
+#define HB_LOG_MAP_RESERVE (64ULL << 30)
+
+static_assert(sizeof(HbLogHeader) <= HbLog::HEADER_SIZE, "HbLogHeader does not fit the header page");
+
+HbLog::HbLog() : _fd(-1), _writable(false), _map(NULL), _map_size(0), _file_size(0), _block_size(0), _header(NULL)
+{
+}
+
+HbLog::~HbLog()
+{
+    close();
+}
+
+int HbLog::create(const char *path, const char *const *columns, uint32_t n_columns)
+{
+    if (n_columns > HB_LOG_MAX_COLUMNS)
+    {
+        return EINVAL;
+    }
+    _fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (_fd < 0)
+    {
+        return errno;
+    }
+    _map = (uint8_t *)mmap(NULL, HB_LOG_MAP_RESERVE, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_NORESERVE, _fd, 0);
+    if (_map == MAP_FAILED)
+    {
+        _map = NULL;
+        return errno;
+    }
+    _map_size = HB_LOG_MAP_RESERVE;
+    _writable = true;
+    _block_size = (size_t)BLOCK_ROWS * (2 * sizeof(uint64_t) + n_columns * sizeof(int32_t));
+    _file_size = HEADER_SIZE;
+    if (ftruncate(_fd, _file_size) != 0)
+    {
+        return errno;
+    }
+
+    _header = (HbLogHeader *)_map;
+    memcpy(_header->magic, HB_LOG_MAGIC, sizeof(_header->magic));
+    _header->header_size = HEADER_SIZE;
+    _header->block_rows = BLOCK_ROWS;
+    _header->n_columns = n_columns;
+    _header->created_ns = now_ns(CLOCK_REALTIME);
+    _header->rows = 0;
+    for (uint32_t i = 0; i < n_columns; i++)
+    {
+        strncpy(_header->columns[i], columns[i], HB_LOG_NAME_LEN - 1);
+    }
+    return 0;
+}
+
+int HbLog::open(const char *path)
+{
+    _fd = ::open(path, O_RDONLY);
+    if (_fd < 0)
+    {
+        return errno;
+    }
+    struct stat st;
+    if (fstat(_fd, &st) != 0)
+    {
+        return errno;
+    }
+    if ((size_t)st.st_size < HEADER_SIZE)
+    {
+        return EINVAL;
+    }
+    _map = (uint8_t *)mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, _fd, 0);
+    if (_map == MAP_FAILED)
+    {
+        _map = NULL;
+        return errno;
+    }
+    _map_size = st.st_size;
+    _file_size = st.st_size;
+    _header = (HbLogHeader *)_map;
+    if (memcmp(_header->magic, HB_LOG_MAGIC, sizeof(_header->magic)) != 0 ||
+        _header->block_rows != BLOCK_ROWS || _header->n_columns > HB_LOG_MAX_COLUMNS)
+    {
+        return EINVAL;
+    }
+    _block_size = (size_t)BLOCK_ROWS * (2 * sizeof(uint64_t) + _header->n_columns * sizeof(int32_t));
+    // a log still being written may have committed rows beyond what was mapped
+    size_t blocks = (_file_size - HEADER_SIZE) / _block_size;
+    if (_header->rows > blocks * BLOCK_ROWS)
+    {
+        return EINVAL;
+    }
+    madvise(_map, _map_size, MADV_SEQUENTIAL);
+    return 0;
+}
+
+void HbLog::close()
+{
+    if (_map)
+    {
+        if (_writable)
+        {
+            msync(_map, _file_size, MS_SYNC);
+        }
+        munmap(_map, _map_size);
+        _map = NULL;
+    }
+    if (_fd >= 0)
+    {
+        ::close(_fd);
+        _fd = -1;
+    }
+    _header = NULL;
+}
+
+int HbLog::grow(uint64_t rows)
+{
+    size_t needed = HEADER_SIZE + ((rows + BLOCK_ROWS - 1) / BLOCK_ROWS) * _block_size;
+    if (needed <= _file_size)
+    {
+        return 0;
+    }
+    if (needed > _map_size)
+    {
+        return EFBIG;
+    }
+    if (ftruncate(_fd, needed) != 0)
+    {
+        return errno;
+    }
+    _file_size = needed;
+    return 0;
+}
+
+int HbLog::append(uint64_t timestamp, uint64_t present, const int32_t *values)
+{
+    if (!_writable)
+    {
+        return EBADF;
+    }
+    uint64_t row = _header->rows;
+    int rc = grow(row + 1);
+    if (rc)
+    {
+        return rc;
+    }
+    uint64_t *b = block(row);
+    uint32_t r = row % BLOCK_ROWS;
+    b[r] = timestamp;
+    b[BLOCK_ROWS + r] = present;
+    int32_t *cols = (int32_t *)(b + 2 * BLOCK_ROWS);
+    for (uint32_t c = 0; c < _header->n_columns; c++)
+    {
+        cols[c * BLOCK_ROWS + r] = values[c];
+    }
+    __atomic_store_n(&_header->rows, row + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+int HbLog::column(const char *name) const
+{
+    for (uint32_t i = 0; i < _header->n_columns; i++)
+    {
+        if (strncmp(_header->columns[i], name, HB_LOG_NAME_LEN) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+uint64_t HbLog::lower_bound(uint64_t t) const
+{
+    uint64_t lo = 0, hi = rows();
+    while (lo < hi)
+    {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (timestamp(mid) < t)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo;
+}
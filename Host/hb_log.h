@@ -0,0 +1,99 @@
+/*
+ * HbLog : append-only, memory-mapped columnar log of decoded telemetry.
+ *
+ * Layout: one 4 KiB header followed by fixed-size blocks of BLOCK_ROWS rows.
+ * Inside a block every column is contiguous:
+ *
+ *   uint64_t timestamp[BLOCK_ROWS]   host receive time, ns since epoch
+ *   uint64_t present[BLOCK_ROWS]     bit n set when column n was in the frame
+ *   int32_t  column_0[BLOCK_ROWS]
+ *   ...
+ *   int32_t  column_N-1[BLOCK_ROWS]
+ *
+ * header.rows is written after the row data, so a reader (or a crash) never
+ * sees a partially written row. Timestamps are non-decreasing, which makes a
+ * time range lookup a binary search. Rows recorded while the board clock was
+ * synchronised carry the board's sample time mapped to host time instead of
+ * the receive time; synced_rows and sync_err_max_ns tell how many and how well.
+ */
+#ifndef HB_LOG_H
+#define HB_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HB_LOG_MAGIC "HBLOG01"
+#define HB_LOG_MAX_COLUMNS 64
+#define HB_LOG_NAME_LEN 24
+
+struct HbLogHeader
+{
+    char magic[8];
+    uint32_t header_size;
+    uint32_t block_rows;
+    uint32_t n_columns;
+    uint32_t reserved;
+    uint64_t created_ns;
+    volatile uint64_t rows; // committed rows
+    // link statistics, updated while recording
+    uint64_t frames;        // frame delimiters seen
+    uint64_t bytes;
+    uint64_t cobs_errors;
+    uint64_t crc_errors;
+    uint64_t decode_errors; // Envelope or HoverboardEvent did not decode
+    uint64_t oversize;      // frame longer than the receive buffer
+    uint64_t overruns;      // kernel / UART receive overruns
+    uint64_t other_msgs;    // valid frames that are not HoverboardEvent
+    char columns[HB_LOG_MAX_COLUMNS][HB_LOG_NAME_LEN];
+    uint64_t synced_rows;     // rows timestamped from the board clock
+    uint64_t sync_err_max_ns; // largest error bound among them
+};
+
+class HbLog
+{
+public:
+    static const uint32_t HEADER_SIZE = 4096;
+    static const uint32_t BLOCK_ROWS = 4096;
+
+    HbLog();
+    ~HbLog();
+
+    int create(const char *path, const char *const *columns, uint32_t n_columns);
+    int open(const char *path);
+    void close();
+
+    int append(uint64_t timestamp, uint64_t present, const int32_t *values);
+
+    HbLogHeader *header() { return _header; }
+    uint64_t rows() const { return _header->rows; }
+    uint32_t n_columns() const { return _header->n_columns; }
+    const char *column_name(uint32_t column) const { return _header->columns[column]; }
+    int column(const char *name) const;
+
+    uint64_t timestamp(uint64_t row) const { return block(row)[row % BLOCK_ROWS]; }
+    uint64_t present(uint64_t row) const { return block(row)[BLOCK_ROWS + row % BLOCK_ROWS]; }
+    int32_t value(uint64_t row, uint32_t column) const
+    {
+        return ((const int32_t *)(block(row) + 2 * BLOCK_ROWS))[column * BLOCK_ROWS + row % BLOCK_ROWS];
+    }
+
+    // first row with timestamp >= t, rows() if none
+    uint64_t lower_bound(uint64_t t) const;
+
+private:
+    int _fd;
+    bool _writable;
+    uint8_t *_map;
+    size_t _map_size;
+    size_t _file_size;
+    size_t _block_size;
+    HbLogHeader *_header;
+
+    uint64_t *block(uint64_t row) const
+    {
+        return (uint64_t *)(_map + HEADER_SIZE + (row / BLOCK_ROWS) * _block_size);
+    }
+    int grow(uint64_t rows);
+};
+
+#endif
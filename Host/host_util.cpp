@@ -0,0 +1,60 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <linux/serial.h>
+#include "host_util.h"
+
+static speed_t to_speed(long baud)
+{
+    switch (baud)
+    {
+    case 9600: return B9600;
+    case 19200: return B19200;
+    case 38400: return B38400;
+    case 57600: return B57600;
+    case 230400: return B230400;
+    case 460800: return B460800;
+    case 921600: return B921600;
+    default: return B115200;
+    }
+}
+
+int open_port(const char *path, long baud)
+{
+    int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0)
+    {
+        perror(path);
+        exit(1);
+    }
+    struct termios tio;
+    if (tcgetattr(fd, &tio) == 0)
+    {
+        cfmakeraw(&tio);
+        cfsetspeed(&tio, to_speed(baud));
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    return fd;
+}
+
+uint64_t wire_ns_per_byte(const char *path, long baud)
+{
+    char *real = realpath(path, NULL);
+    bool pty = real && strncmp(real, "/dev/pts/", 9) == 0;
+    free(real);
+    return pty || baud <= 0 ? 0 : 10ULL * 1000000000ULL / baud;
+}
+
+uint64_t port_overruns(int fd)
+{
+    struct serial_icounter_struct icount;
+    if (ioctl(fd, TIOCGICOUNT, &icount) != 0)
+    {
+        return 0;
+    }
+    return (uint64_t)icount.overrun + icount.buf_overrun;
+}
@@ -0,0 +1,26 @@
+/*
+ * Small helpers shared by the host tools.
+ */
+#ifndef HOST_UTIL_H
+#define HOST_UTIL_H
+
+#include <stdint.h>
+#include <time.h>
+
+static inline uint64_t now_ns(clockid_t clock = CLOCK_MONOTONIC)
+{
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Open a serial port or pty raw, non-blocking, at the given baud rate (ignored by a pty)
+int open_port(const char *path, long baud);
+
+// Time one byte takes on the wire at baud (8N1), 0 for a pty which delivers instantly
+uint64_t wire_ns_per_byte(const char *path, long baud);
+
+// Kernel receive overruns (UART FIFO + tty buffer) on a serial port, 0 on a pty
+uint64_t port_overruns(int fd);
+
+#endif
@@ -0,0 +1,445 @@
+/*
+ * limero_bench : drive HoverboardRequest traffic into a Limero endpoint and
+ * measure what comes back.
+ *
+ * Works against limero_sim (pty) as well as a real board on a serial port.
+ * Each request carries a unique speed tag with steer 0; the first
+ * HoverboardEvent reporting cmdl == tag closes the latency sample. On a real
+ * board the rate limiter and filter in the main loop smear the tag, so the
+ * latency figure is only meaningful against limero_sim.
+ *
+ * Firmware built with LIMERO_ACK answers every request with a GenericReply
+ * carrying the main loop tick it was applied at. From those the bench
+ * reports, every stats interval and at the end:
+ *   - loss: requests without a reply ACK_TIMEOUT after sending. Replies the
+ *     firmware dropped from its full reply queue (above 80 Hz, 16 per
+ *     telemetry frame) are counted apart as dropped, from the
+ *     tx_queue_dropped of the LinkDiagEvents received since the first one
+ *   - apply latency: send -> tick the main loop took the command over.
+ *     Board ticks are mapped to host time with the tightest offset seen
+ *     (the fastest request counts as 0 ms), so the figure is relative and
+ *     has DELAY_IN_MAIN_LOOP resolution; clock drift is not corrected.
+ *   - ack round trip: send -> reply received, includes the telemetry wait
+ *   - firmware counters: req_ids missing on arrival and requests
+ *     overwritten before the main loop ran
+ *
+ *   limero_bench [-r req_hz] [-d duration_sec] [-b baud] [-s stats_sec] <device>
+ */
+
+#include "config.h" // DELAY_IN_MAIN_LOOP
+
+#include <algorithm>
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+#include <limero/log.h>
+#include <limero/codec.h>
+#include <limero/msgs_hoverboard.h>
+#include "frame_reader.h"
+#include "host_util.h"
+
+Log logger(256);
+
+void panic_here(const char *s)
+{
+    fprintf(stderr, " ===> PANIC : %s\n", s);
+    abort();
+}
+
+#define TAG_MAX 1000         // speed tags cycle 1..TAG_MAX, inside the [-1000, 1000] input range
+#define ACK_WINDOW 4096      // requests in flight tracked for replies
+#define ACK_TIMEOUT 1000000000ULL // a request without reply after 1 s is lost
+#define LOOP_NS (DELAY_IN_MAIN_LOOP * 1000000ULL)
+
+struct Request
+{
+    uint32_t req_id;
+    uint64_t sent;
+    bool acked;
+};
+
+// applied request, latency resolved once the clock offset is known
+struct AckSample
+{
+    uint64_t sent;
+    uint32_t tick;
+    uint64_t rtt;
+};
+
+struct AckStats
+{
+    uint64_t acked = 0;
+    uint64_t lost = 0;
+    uint64_t dropped = 0; // applied, but the reply did not fit into the firmware queue
+    uint64_t late = 0; // reply for a request already counted as lost or unknown
+    std::vector<AckSample> samples;
+};
+
+struct BenchStats
+{
+    uint64_t tx_frames = 0;
+    uint64_t tx_bytes = 0;
+    uint64_t tx_cpu_ns = 0;
+    uint64_t rx_frames = 0;
+    uint64_t rx_bytes = 0;
+    uint64_t rx_events = 0;
+    uint64_t rx_acks = 0;
+    uint64_t rx_other = 0;
+    uint64_t rx_errors = 0; // COBS, CRC or CBOR failures
+    uint64_t rx_cpu_ns = 0;
+    std::vector<uint64_t> latency_ns;
+    // firmware sequence counters from the last HoverboardEvent
+    int32_t fw_req_gaps = -1;
+    int32_t fw_req_superseded = -1;
+    int64_t fw_queue_dropped = -1; // tx_queue_dropped from the last LinkDiagEvent
+};
+
+struct AckTracker
+{
+    Request window[ACK_WINDOW] = {};
+    uint32_t oldest = 1; // first req_id not yet resolved as acked or lost
+    uint32_t next = 1;
+    int64_t offset = INT64_MIN; // host ns - tick * LOOP_NS, lower bound
+    uint64_t drop_credit = 0;   // firmware queue drops not yet matched to an unacked request
+    AckStats total, interval;
+
+    void sent(uint32_t req_id, uint64_t now)
+    {
+        window[req_id % ACK_WINDOW] = {req_id, now, false};
+        next = req_id + 1;
+    }
+
+    void reply(uint32_t req_id, uint32_t tick, uint64_t now)
+    {
+        Request &r = window[req_id % ACK_WINDOW];
+        if (r.req_id != req_id || r.acked || req_id < oldest)
+        {
+            total.late++;
+            interval.late++;
+            return;
+        }
+        r.acked = true;
+        // applied no earlier than sent: every sample bounds the offset from below
+        offset = std::max(offset, (int64_t)r.sent - (int64_t)(tick * LOOP_NS));
+        AckSample s = {r.sent, tick, now - r.sent};
+        total.samples.push_back(s);
+        interval.samples.push_back(s);
+    }
+
+    // resolve requests whose reply is due
+    void expire(uint64_t now)
+    {
+        while (oldest < next)
+        {
+            Request &r = window[oldest % ACK_WINDOW];
+            if (r.sent + ACK_TIMEOUT > now)
+            {
+                break;
+            }
+            if (r.acked)
+            {
+                total.acked++;
+                interval.acked++;
+            }
+            else if (drop_credit)
+            {
+                // the firmware counts the drop when it applies the request, well before ACK_TIMEOUT
+                drop_credit--;
+                total.dropped++;
+                interval.dropped++;
+            }
+            else
+            {
+                total.lost++;
+                interval.lost++;
+            }
+            oldest++;
+        }
+    }
+
+    uint64_t apply_ns(const AckSample &s) const
+    {
+        return (uint64_t)((int64_t)(s.tick * LOOP_NS) + offset - (int64_t)s.sent);
+    }
+};
+
+static uint32_t encode_request(uint32_t req_id, int32_t speed, uint8_t **frame)
+{
+    static Buffer payload(64);
+    static Buffer envelope_buffer(128);
+    HoverboardRequest request;
+    request.req_id = req_id;
+    request.speed = speed;
+    request.steer = 0;
+    if (request.encode(payload) != 0)
+    {
+        return 0;
+    }
+    Envelope envelope;
+    envelope.src = FNV("limero_bench");
+    envelope.dst = FNV("hoverboard");
+    envelope.msg_type = HoverboardRequest::MSG_ID;
+    envelope.payload = payload.to_vector();
+    if (envelope.encode(envelope_buffer) != 0)
+    {
+        return 0;
+    }
+    FrameEncoder frame_encoder(envelope_buffer.data(), envelope_buffer.capacity(), envelope_buffer.size());
+    if (frame_encoder.add_crc().is_err() || frame_encoder.add_cobs().is_err())
+    {
+        return 0;
+    }
+    *frame = frame_encoder.data();
+    return frame_encoder.size();
+}
+
+static void handle_msg(BenchStats &stats, AckTracker &acks, uint64_t *tag_sent, uint64_t now, uint32_t msg_type, const Buffer &payload)
+{
+    if (msg_type == GenericReply::MSG_ID)
+    {
+        GenericReply reply;
+        if (reply.decode(payload) != 0 || !reply.req_id || !reply.tick)
+        {
+            stats.rx_errors++;
+            return;
+        }
+        stats.rx_acks++;
+        acks.reply(*reply.req_id, *reply.tick, now);
+        return;
+    }
+    if (msg_type == LinkDiagEvent::MSG_ID)
+    {
+        LinkDiagEvent diag;
+        if (diag.decode(payload) != 0)
+        {
+            stats.rx_errors++;
+            return;
+        }
+        stats.rx_other++;
+        // cumulative since boot: only the increase since the first event counts, a reboot restarts it
+        diag.tx_queue_dropped.inspect([&](const uint32_t &v)
+                                      {
+            if (stats.fw_queue_dropped >= 0 && v >= stats.fw_queue_dropped)
+            {
+                acks.drop_credit += v - stats.fw_queue_dropped;
+            }
+            stats.fw_queue_dropped = v; });
+        return;
+    }
+    if (msg_type != HoverboardEvent::MSG_ID)
+    {
+        stats.rx_other++;
+        return;
+    }
+    HoverboardEvent event;
+    if (event.decode(payload) != 0)
+    {
+        stats.rx_errors++;
+        return;
+    }
+    stats.rx_events++;
+    event.req_gaps.inspect([&](const int32_t &v)
+                           { stats.fw_req_gaps = v; });
+    event.req_superseded.inspect([&](const int32_t &v)
+                                 { stats.fw_req_superseded = v; });
+    event.cmdl.inspect([&](const int32_t &cmdl)
+                       {
+        if (cmdl > 0 && cmdl <= TAG_MAX && tag_sent[cmdl])
+        {
+            stats.latency_ns.push_back(now - tag_sent[cmdl]);
+            tag_sent[cmdl] = 0;
+        } });
+}
+
+static double percentile_ms(const std::vector<uint64_t> &sorted, uint32_t pct)
+{
+    return sorted[std::min(sorted.size() - 1, sorted.size() * pct / 100)] / 1e6;
+}
+
+static void print_latency(FILE *out, const char *label, std::vector<uint64_t> &lat)
+{
+    if (lat.empty())
+    {
+        fprintf(out, "%-9s no samples\n", label);
+        return;
+    }
+    std::sort(lat.begin(), lat.end());
+    uint64_t sum = 0;
+    for (uint64_t l : lat)
+    {
+        sum += l;
+    }
+    fprintf(out, "%-9s %8zu samples  min %.2f  avg %.2f  p50 %.2f  p99 %.2f  max %.2f ms\n",
+            label, lat.size(), lat.front() / 1e6, sum / 1e6 / lat.size(), percentile_ms(lat, 50),
+            percentile_ms(lat, 99), lat.back() / 1e6);
+}
+
+static void print_interval(const BenchStats &stats, AckTracker &acks, double t)
+{
+    AckStats &a = acks.interval;
+    uint64_t resolved = a.acked + a.lost + a.dropped;
+    fprintf(stderr, "%7.1f s  acked %5llu lost %4llu (%5.1f %%) dropped %4llu",
+            t, (unsigned long long)a.acked, (unsigned long long)a.lost,
+            resolved ? 100.0 * a.lost / resolved : 0.0, (unsigned long long)a.dropped);
+    if (!a.samples.empty())
+    {
+        std::vector<uint64_t> apply, rtt;
+        for (const AckSample &s : a.samples)
+        {
+            apply.push_back(acks.apply_ns(s));
+            rtt.push_back(s.rtt);
+        }
+        std::sort(apply.begin(), apply.end());
+        std::sort(rtt.begin(), rtt.end());
+        fprintf(stderr, " | apply p50 %6.2f p99 %6.2f max %6.2f ms | rtt p50 %6.2f p99 %6.2f ms",
+                percentile_ms(apply, 50), percentile_ms(apply, 99), apply.back() / 1e6,
+                percentile_ms(rtt, 50), percentile_ms(rtt, 99));
+    }
+    if (stats.fw_req_gaps >= 0)
+    {
+        fprintf(stderr, " | fw gaps %d superseded %d", stats.fw_req_gaps, stats.fw_req_superseded);
+    }
+    fprintf(stderr, "\n");
+    a = AckStats();
+}
+
+static int usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-r req_hz] [-d duration_sec] [-b baud] [-s stats_sec] <device>\n", prog);
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    double req_hz = 50;
+    double duration_sec = 10;
+    double stats_sec = 1;
+    long baud = 115200;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "r:d:b:s:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'r': req_hz = atof(optarg); break;
+        case 'd': duration_sec = atof(optarg); break;
+        case 'b': baud = atol(optarg); break;
+        case 's': stats_sec = atof(optarg); break;
+        default: return usage(argv[0]);
+        }
+    }
+    if (optind != argc - 1 || req_hz <= 0 || stats_sec <= 0)
+    {
+        return usage(argv[0]);
+    }
+
+    int fd = open_port(argv[optind], baud);
+    FrameReader reader(2048);
+    BenchStats stats;
+    static AckTracker acks;
+    static uint64_t tag_sent[TAG_MAX + 1];
+    uint32_t req_id = 1; // 0 asks for no reply
+
+    const uint64_t req_period = (uint64_t)(1e9 / req_hz);
+    const uint64_t stats_period = (uint64_t)(stats_sec * 1e9);
+    uint64_t start = now_ns();
+    uint64_t end = start + (uint64_t)(duration_sec * 1e9);
+    uint64_t next_req = start;
+    uint64_t next_stats = start + stats_period;
+    uint8_t rx_buf[256];
+
+    for (uint64_t now = start; now < end; now = now_ns())
+    {
+        if (now >= next_req)
+        {
+            uint32_t tag = (req_id - 1) % TAG_MAX + 1;
+            uint8_t *frame = NULL;
+            uint64_t t0 = now_ns(CLOCK_THREAD_CPUTIME_ID);
+            uint32_t len = encode_request(req_id, tag, &frame);
+            stats.tx_cpu_ns += now_ns(CLOCK_THREAD_CPUTIME_ID) - t0;
+            if (len && write(fd, frame, len) == (ssize_t)len)
+            {
+                tag_sent[tag] = now;
+                stats.tx_frames++;
+                stats.tx_bytes += len;
+            }
+            // a request that never made it out still counts: the id gap is what the firmware sees
+            acks.sent(req_id, now);
+            req_id++;
+            next_req += req_period;
+        }
+        if (now >= next_stats)
+        {
+            acks.expire(now);
+            print_interval(stats, acks, (now - start) / 1e9);
+            next_stats += stats_period;
+        }
+
+        uint64_t deadline = std::min(std::min(next_req, next_stats), end);
+        uint64_t wait = deadline - std::min(now_ns(), deadline);
+        struct timespec ts = {(time_t)(wait / 1000000000ULL), (long)(wait % 1000000000ULL)};
+        struct pollfd pfd = {fd, POLLIN, 0};
+        if (ppoll(&pfd, 1, &ts, NULL) <= 0 || !(pfd.revents & POLLIN))
+        {
+            continue;
+        }
+        ssize_t n = read(fd, rx_buf, sizeof(rx_buf));
+        uint64_t rx_time = now_ns();
+        uint64_t t0 = now_ns(CLOCK_THREAD_CPUTIME_ID);
+        if (n > 0)
+        {
+            reader.feed(rx_buf, n, [&](uint32_t msg_type, const Buffer &payload)
+                        { handle_msg(stats, acks, tag_sent, rx_time, msg_type, payload); });
+        }
+        stats.rx_cpu_ns += now_ns(CLOCK_THREAD_CPUTIME_ID) - t0;
+    }
+    const FrameStats &fs = reader.stats();
+    stats.rx_frames = fs.frames;
+    stats.rx_bytes = fs.bytes;
+    stats.rx_errors += fs.cobs_errors + fs.crc_errors + fs.decode_errors + fs.oversize;
+
+    double secs = (now_ns() - start) / 1e9;
+    printf("requests  %8llu frames %7.1f fps %8.0f B/s  cpu %6.2f us/frame\n",
+           (unsigned long long)stats.tx_frames, stats.tx_frames / secs, stats.tx_bytes / secs,
+           stats.tx_frames ? stats.tx_cpu_ns / 1000.0 / stats.tx_frames : 0.0);
+    printf("received  %8llu frames %7.1f fps %8.0f B/s  cpu %6.2f us/frame  events %llu acks %llu other %llu errors %llu\n",
+           (unsigned long long)stats.rx_frames, stats.rx_frames / secs, stats.rx_bytes / secs,
+           stats.rx_frames ? stats.rx_cpu_ns / 1000.0 / stats.rx_frames : 0.0,
+           (unsigned long long)stats.rx_events, (unsigned long long)stats.rx_acks,
+           (unsigned long long)stats.rx_other, (unsigned long long)stats.rx_errors);
+    print_latency(stdout, "latency", stats.latency_ns);
+
+    if (stats.rx_acks == 0)
+    {
+        printf("acks      none, firmware without LIMERO_ACK?\n");
+        return 0;
+    }
+    // replies to the last ACK_TIMEOUT worth of requests may still be on the way, leave them out
+    acks.expire(now_ns());
+    AckStats &a = acks.total;
+    uint64_t resolved = a.acked + a.lost + a.dropped;
+    printf("acks      %8llu acked  %llu lost (%.2f %%)  %llu dropped from the reply queue  %llu late or unknown",
+           (unsigned long long)a.acked, (unsigned long long)a.lost,
+           resolved ? 100.0 * a.lost / resolved : 0.0, (unsigned long long)a.dropped, (unsigned long long)a.late);
+    if (stats.fw_req_gaps >= 0)
+    {
+        printf("  firmware: gaps %d superseded %d", stats.fw_req_gaps, stats.fw_req_superseded);
+    }
+    printf("\n");
+    std::vector<uint64_t> apply, rtt;
+    for (const AckSample &s : a.samples)
+    {
+        apply.push_back(acks.apply_ns(s));
+        rtt.push_back(s.rtt);
+    }
+    print_latency(stdout, "apply", apply);
+    print_latency(stdout, "ack rtt", rtt);
+    return 0;
+}
@@ -0,0 +1,882 @@
+/*
+ * limero_rec : record HoverboardEvent telemetry into an HbLog and get it back.
+ *
+ *   limero_rec record [-b baud] [-p ping_hz] <device> <file>
+ *   limero_rec info <file>
+ *   limero_rec query [-f from_sec] [-t to_sec] [-c col,col,...] <file>
+ *   limero_rec replay [-f from_sec] [-t to_sec] [-x speed] [-b baud] <file> <device>
+ *   limero_rec trace [-b baud] [-d duration_sec] <device>
+ *   limero_rec stats [-b baud] [-d duration_sec] <device>
+ *   limero_rec energy [-b baud] [-d duration_sec] <device>
+ *
+ * Times given to -f/-t are seconds from the first recorded row. query prints
+ * CSV, replay re-encodes the rows as Limero frames with the original spacing
+ * (-x 0 sends as fast as the port accepts).
+ *
+ * While recording, PingRequests (-p, 1 Hz, 0 = off) synchronise the board
+ * clock with CLOCK_REALTIME. Once synced, a row's timestamp is the board time
+ * the event was sampled at (HoverboardEvent.time_us) mapped to host time.
+ * Without sync, it is the time the frame arrived.
+ *
+ * trace prints the TraceEvent columns of a LIMERO_TRACE build as CSV, one
+ * line per main loop sample, and what the packing saved on the wire. stats
+ * prints the LIMERO_STATS min/max/mean/RMS of every HoverboardEvent as CSV,
+ * one line per event. energy does the same for the ENERGY_COUNT EnergyEvents.
+ *
+ * Decoding a frame takes a few microseconds against ~14 ms of wire time for a
+ * HoverboardEvent at 115200 baud, so a single thread keeps up with the UART;
+ * anything lost is counted in the log header instead.
+ */
+
+#include <algorithm>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+
+#include <limero/log.h>
+#include <limero/codec.h>
+#include <limero/msgs_hoverboard.h>
+#include <limero/column_pack.h>
+#include <limero/trace_channels.h>
+#include "isr_stats.h"
+#include "hb_event_columns.h"
+#include "frame_reader.h"
+#include "hb_log.h"
+#include "host_util.h"
+#include "time_sync.h"
+
+Log logger(256);
+
+void panic_here(const char *s)
+{
+    fprintf(stderr, " ===> PANIC : %s\n", s);
+    abort();
+}
+
+#define FRAME_BUFFER_SIZE 2048 // txd_envelope_buffer in serial.cpp
+
+// log columns are 32 bit cells; unsigned fields (time_us) are stored bit for bit
+template <typename T>
+static bool hb_get(const Option<T> &field, int32_t *value)
+{
+    *value = field ? (int32_t)*field : 0;
+    return (bool)field;
+}
+
+template <typename T>
+static void hb_set(Option<T> &field, int32_t value)
+{
+    field = (T)value;
+}
+
+struct HbColumn
+{
+    bool (*get)(const HoverboardEvent &event, int32_t *value);
+    void (*set)(HoverboardEvent &event, int32_t value);
+};
+
+#define HB_COLUMN_MEMBER(name) {[](const HoverboardEvent &e, int32_t *v) { return hb_get(e.name, v); }, \
+                                [](HoverboardEvent &e, int32_t v) { hb_set(e.name, v); }},
+#define HB_COLUMN_NAME(name) #name,
+static const HbColumn hb_members[] = {HB_EVENT_COLUMNS(HB_COLUMN_MEMBER)};
+static const char *const hb_names[] = {HB_EVENT_COLUMNS(HB_COLUMN_NAME)};
+static const uint32_t HB_COLUMNS = sizeof(hb_names) / sizeof(hb_names[0]);
+
+static volatile sig_atomic_t running = 1;
+
+static void on_signal(int)
+{
+    running = 0;
+}
+
+static int usage()
+{
+    fprintf(stderr,
+            "usage: limero_rec record [-b baud] [-p ping_hz] <device> <file>\n"
+            "       limero_rec info <file>\n"
+            "       limero_rec query [-f from_sec] [-t to_sec] [-c col,col,...] <file>\n"
+            "       limero_rec replay [-f from_sec] [-t to_sec] [-x speed] [-b baud] <file> <device>\n"
+            "       limero_rec trace [-b baud] [-d duration_sec] <device>\n"
+            "       limero_rec stats [-b baud] [-d duration_sec] <device>\n"
+            "       limero_rec energy [-b baud] [-d duration_sec] <device>\n");
+    return 1;
+}
+
+static void print_counters(const HbLogHeader *h)
+{
+    fprintf(stderr, "rows %llu frames %llu bytes %llu | cobs %llu crc %llu decode %llu oversize %llu overrun %llu | other %llu\n",
+            (unsigned long long)h->rows, (unsigned long long)h->frames, (unsigned long long)h->bytes,
+            (unsigned long long)h->cobs_errors, (unsigned long long)h->crc_errors,
+            (unsigned long long)h->decode_errors, (unsigned long long)h->oversize,
+            (unsigned long long)h->overruns, (unsigned long long)h->other_msgs);
+    if (h->synced_rows)
+    {
+        fprintf(stderr, "synced rows %llu, error bound up to %.3f ms\n",
+                (unsigned long long)h->synced_rows, h->sync_err_max_ns / 1e6);
+    }
+}
+
+//================================================================
+
+static uint64_t event_decode_errors = 0; // frame was fine, HoverboardEvent was not
+static LinkDiagEvent board_link;          // the board's view of the link, last LinkDiagEvent
+
+static uint32_t or0(const Option<uint32_t> &v)
+{
+    return v ? *v : 0;
+}
+
+static void print_board_link(const LinkDiagEvent &d)
+{
+    if (!d.rx_bytes)
+    {
+        return;
+    }
+    fprintf(stderr, "board rx %u B %u frames | cobs %u crc %u overflow %u decode %u unknown %u | tx %u frames dropped %u max %u B queue %u dropped %u\n",
+            *d.rx_bytes, or0(d.rx_frames), or0(d.rx_cobs_errors), or0(d.rx_crc_errors),
+            or0(d.rx_overflows), or0(d.rx_decode_errors), or0(d.rx_unknown_msgs),
+            or0(d.tx_frames), or0(d.tx_dropped), or0(d.tx_frame_max),
+            or0(d.tx_queue_max), or0(d.tx_queue_dropped));
+}
+
+// Clock synchronisation state of a recording
+struct Sync
+{
+    TimeSync clock;
+    uint64_t ns_per_byte = 0; // wire time correction, 0 on a pty
+    uint32_t next_req_id = 1;
+    // outstanding pings: host time the request's last byte reached the wire
+    uint64_t sent_ns[16] = {};
+    uint32_t sent_id[16] = {};
+    uint64_t last_ts = 0; // keeps synced timestamps non-decreasing as the fit moves
+};
+
+static int send_ping(int fd, Sync &sync)
+{
+    static Buffer payload(32);
+    static Buffer envelope_buffer(64);
+    PingRequest ping;
+    uint32_t req_id = sync.next_req_id++;
+    uint64_t now = now_ns(CLOCK_REALTIME);
+    ping.req_id = req_id;
+    ping.timestamp = now / 1000000;
+    Envelope envelope;
+    envelope.src = FNV("limero_rec");
+    envelope.dst = FNV("hoverboard");
+    envelope.msg_type = PingRequest::MSG_ID;
+    if (ping.encode(payload) != 0)
+    {
+        return EINVAL;
+    }
+    envelope.payload = payload.to_vector();
+    if (envelope.encode(envelope_buffer) != 0)
+    {
+        return EINVAL;
+    }
+    FrameEncoder frame(envelope_buffer.data(), envelope_buffer.capacity(), envelope_buffer.size());
+    if (frame.add_crc().is_err() || frame.add_cobs().is_err())
+    {
+        return EINVAL;
+    }
+    now = now_ns(CLOCK_REALTIME);
+    if (write(fd, frame.data(), frame.size()) != (ssize_t)frame.size())
+    {
+        return errno;
+    }
+    sync.sent_id[req_id % 16] = req_id;
+    // the board stamps the request when the UART reports the line idle, one character after the last byte
+    sync.sent_ns[req_id % 16] = now + (frame.size() + 1) * sync.ns_per_byte;
+    return 0;
+}
+
+static void handle_ping_reply(Sync &sync, uint64_t rx_time, uint32_t frame_bytes, const Buffer &payload)
+{
+    PingReply reply;
+    if (reply.decode(payload) != 0 || !reply.req_id || !reply.rx_us || !reply.tx_us)
+    {
+        return;
+    }
+    uint32_t slot = *reply.req_id % 16;
+    if (sync.sent_id[slot] != *reply.req_id)
+    {
+        return;
+    }
+    sync.sent_id[slot] = 0;
+    // t4 moved back to when the first byte of the reply frame went out
+    sync.clock.add(sync.sent_ns[slot], *reply.rx_us, *reply.tx_us, rx_time - frame_bytes * sync.ns_per_byte);
+}
+
+static void record_msg(HbLog &log, Sync &sync, uint64_t rx_time, uint32_t frame_bytes, uint32_t msg_type, const Buffer &payload)
+{
+    if (msg_type == PingReply::MSG_ID)
+    {
+        handle_ping_reply(sync, rx_time, frame_bytes, payload);
+        return;
+    }
+    if (msg_type == LinkDiagEvent::MSG_ID)
+    {
+        LinkDiagEvent diag;
+        if (diag.decode(payload) == 0)
+        {
+            board_link = diag;
+        }
+        return;
+    }
+    if (msg_type != HoverboardEvent::MSG_ID)
+    {
+        log.header()->other_msgs++;
+        return;
+    }
+    HoverboardEvent event;
+    if (event.decode(payload) != 0)
+    {
+        event_decode_errors++;
+        return;
+    }
+    int32_t values[HB_COLUMNS];
+    uint64_t present = 0;
+    for (uint32_t c = 0; c < HB_COLUMNS; c++)
+    {
+        present |= hb_members[c].get(event, &values[c]) ? (1ULL << c) : 0;
+    }
+    uint64_t timestamp = rx_time;
+    if (sync.clock.valid() && event.time_us)
+    {
+        HbLogHeader *h = log.header();
+        uint64_t err;
+        timestamp = std::max(sync.clock.to_host(sync.clock.unwrap(*event.time_us), &err), sync.last_ts);
+        sync.last_ts = timestamp;
+        h->synced_rows++;
+        h->sync_err_max_ns = std::max(h->sync_err_max_ns, err);
+    }
+    int rc = log.append(timestamp, present, values);
+    if (rc)
+    {
+        fprintf(stderr, "limero_rec: append failed: %s\n", strerror(rc));
+        running = 0;
+    }
+}
+
+static int cmd_record(int argc, char **argv)
+{
+    long baud = 115200;
+    double ping_hz = 1;
+    int opt;
+    while ((opt = getopt(argc, argv, "b:p:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'b': baud = atol(optarg); break;
+        case 'p': ping_hz = atof(optarg); break;
+        default: return usage();
+        }
+    }
+    if (optind != argc - 2)
+    {
+        return usage();
+    }
+    int fd = open_port(argv[optind], baud);
+    HbLog log;
+    int rc = log.create(argv[optind + 1], hb_names, HB_COLUMNS);
+    if (rc)
+    {
+        fprintf(stderr, "limero_rec: %s: %s\n", argv[optind + 1], strerror(rc));
+        return 1;
+    }
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    HbLogHeader *h = log.header();
+    FrameReader reader(FRAME_BUFFER_SIZE);
+    static Sync sync;
+    sync.ns_per_byte = wire_ns_per_byte(argv[optind], baud);
+    const uint64_t ping_period = ping_hz > 0 ? (uint64_t)(1e9 / ping_hz) : 0;
+    uint64_t next_ping = now_ns();
+    uint64_t overruns_at_start = port_overruns(fd);
+    uint64_t next_status = now_ns() + 5000000000ULL;
+    uint8_t rx_buf[4096];
+
+    while (running)
+    {
+        struct pollfd pfd = {fd, POLLIN, 0};
+        if (ping_period && now_ns() >= next_ping)
+        {
+            send_ping(fd, sync);
+            next_ping += ping_period;
+        }
+        int timeout_ms = ping_period ? (int)std::min<uint64_t>(1000, (next_ping - std::min(next_ping, now_ns())) / 1000000 + 1) : 1000;
+        if (poll(&pfd, 1, timeout_ms) > 0 && (pfd.revents & POLLIN))
+        {
+            ssize_t n = read(fd, rx_buf, sizeof(rx_buf));
+            uint64_t rx_time = now_ns(CLOCK_REALTIME);
+            if (n > 0)
+            {
+                reader.feed(rx_buf, n, [&](uint32_t msg_type, const Buffer &payload)
+                            { record_msg(log, sync, rx_time, reader.frame_bytes(), msg_type, payload); });
+                const FrameStats &fs = reader.stats();
+                h->frames = fs.frames;
+                h->bytes = fs.bytes;
+                h->cobs_errors = fs.cobs_errors;
+                h->crc_errors = fs.crc_errors;
+                h->decode_errors = event_decode_errors + fs.decode_errors;
+                h->oversize = fs.oversize;
+            }
+        }
+        uint64_t now = now_ns();
+        if (now >= next_status)
+        {
+            h->overruns = port_overruns(fd) - overruns_at_start;
+            print_counters(h);
+            if (sync.clock.valid())
+            {
+                fprintf(stderr, "clock offset %+.3f ms drift %+.1f ppm error %.3f ms (%u pings)\n",
+                        sync.clock.offset_ns() / 1e6, sync.clock.drift_ppm(), sync.clock.error_ns() / 1e6,
+                        sync.clock.samples());
+            }
+            print_board_link(board_link);
+            next_status = now + 5000000000ULL;
+        }
+    }
+    h->overruns = port_overruns(fd) - overruns_at_start;
+    print_counters(h);
+    print_board_link(board_link);
+    log.close();
+    return 0;
+}
+
+//================================================================
+
+static int open_log(HbLog &log, const char *path)
+{
+    int rc = log.open(path);
+    if (rc)
+    {
+        fprintf(stderr, "limero_rec: %s: %s\n", path, strerror(rc));
+    }
+    return rc;
+}
+
+// Translate -f/-t (seconds from the first row) into a row range
+static void row_range(const HbLog &log, double from_sec, double to_sec, uint64_t &first, uint64_t &last)
+{
+    first = 0;
+    last = log.rows();
+    if (last == 0)
+    {
+        return;
+    }
+    uint64_t t0 = log.timestamp(0);
+    if (from_sec > 0)
+    {
+        first = log.lower_bound(t0 + (uint64_t)(from_sec * 1e9));
+    }
+    if (to_sec > 0)
+    {
+        last = log.lower_bound(t0 + (uint64_t)(to_sec * 1e9));
+    }
+}
+
+static int cmd_info(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        return usage();
+    }
+    HbLog log;
+    if (open_log(log, argv[1]))
+    {
+        return 1;
+    }
+    HbLogHeader *h = log.header();
+    print_counters(h);
+    if (log.rows())
+    {
+        double secs = (log.timestamp(log.rows() - 1) - log.timestamp(0)) / 1e9;
+        fprintf(stderr, "duration %.1f s, %.1f rows/s\n", secs, secs > 0 ? log.rows() / secs : 0.0);
+    }
+    fprintf(stderr, "columns");
+    for (uint32_t c = 0; c < log.n_columns(); c++)
+    {
+        fprintf(stderr, " %s", log.column_name(c));
+    }
+    fprintf(stderr, "\n");
+    return 0;
+}
+
+static int cmd_query(int argc, char **argv)
+{
+    double from_sec = 0, to_sec = 0;
+    char *cols = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "f:t:c:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'f': from_sec = atof(optarg); break;
+        case 't': to_sec = atof(optarg); break;
+        case 'c': cols = optarg; break;
+        default: return usage();
+        }
+    }
+    if (optind != argc - 1)
+    {
+        return usage();
+    }
+    HbLog log;
+    if (open_log(log, argv[optind]))
+    {
+        return 1;
+    }
+
+    std::vector<uint32_t> selected;
+    if (cols)
+    {
+        for (char *name = strtok(cols, ","); name; name = strtok(NULL, ","))
+        {
+            int c = log.column(name);
+            if (c < 0)
+            {
+                fprintf(stderr, "limero_rec: no column %s\n", name);
+                return 1;
+            }
+            selected.push_back(c);
+        }
+    }
+    else
+    {
+        for (uint32_t c = 0; c < log.n_columns(); c++)
+        {
+            selected.push_back(c);
+        }
+    }
+
+    uint64_t first, last;
+    row_range(log, from_sec, to_sec, first, last);
+    printf("time");
+    std::vector<bool> is_unsigned(log.n_columns(), false);
+    for (uint32_t c : selected)
+    {
+        printf(",%s", log.column_name(c));
+        is_unsigned[c] = strncmp(log.column_name(c), "time_us", HB_LOG_NAME_LEN) == 0;
+    }
+    printf("\n");
+    uint64_t t0 = log.rows() ? log.timestamp(0) : 0;
+    for (uint64_t row = first; row < last; row++)
+    {
+        printf("%.6f", (log.timestamp(row) - t0) / 1e9);
+        uint64_t present = log.present(row);
+        for (uint32_t c : selected)
+        {
+            if (present & (1ULL << c))
+            {
+                printf(is_unsigned[c] ? ",%u" : ",%d", log.value(row, c));
+            }
+            else
+            {
+                printf(",");
+            }
+        }
+        printf("\n");
+    }
+    return 0;
+}
+
+static uint32_t encode_row(const HbLog &log, uint64_t row, const std::vector<int> &member_of, uint8_t **frame)
+{
+    static Buffer payload(256);
+    static Buffer envelope_buffer(FRAME_BUFFER_SIZE);
+    HoverboardEvent event;
+    uint64_t present = log.present(row);
+    for (uint32_t c = 0; c < log.n_columns(); c++)
+    {
+        if (member_of[c] >= 0 && (present & (1ULL << c)))
+        {
+            hb_members[member_of[c]].set(event, log.value(row, c));
+        }
+    }
+    if (event.encode(payload) != 0)
+    {
+        return 0;
+    }
+    Envelope envelope;
+    envelope.src = FNV("hoverboard");
+    envelope.msg_type = HoverboardEvent::MSG_ID;
+    envelope.payload = payload.to_vector();
+    if (envelope.encode(envelope_buffer) != 0)
+    {
+        return 0;
+    }
+    FrameEncoder frame_encoder(envelope_buffer.data(), envelope_buffer.capacity(), envelope_buffer.size());
+    if (frame_encoder.add_crc().is_err() || frame_encoder.add_cobs().is_err())
+    {
+        return 0;
+    }
+    *frame = frame_encoder.data();
+    return frame_encoder.size();
+}
+
+static int cmd_replay(int argc, char **argv)
+{
+    double from_sec = 0, to_sec = 0, speed = 1;
+    long baud = 115200;
+    int opt;
+    while ((opt = getopt(argc, argv, "f:t:x:b:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'f': from_sec = atof(optarg); break;
+        case 't': to_sec = atof(optarg); break;
+        case 'x': speed = atof(optarg); break;
+        case 'b': baud = atol(optarg); break;
+        default: return usage();
+        }
+    }
+    if (optind != argc - 2)
+    {
+        return usage();
+    }
+    HbLog log;
+    if (open_log(log, argv[optind]))
+    {
+        return 1;
+    }
+    int fd = open_port(argv[optind + 1], baud);
+    signal(SIGINT, on_signal);
+
+    // file columns -> HoverboardEvent members, by name
+    std::vector<int> member_of(log.n_columns(), -1);
+    for (uint32_t c = 0; c < log.n_columns(); c++)
+    {
+        for (uint32_t m = 0; m < HB_COLUMNS; m++)
+        {
+            if (strncmp(log.column_name(c), hb_names[m], HB_LOG_NAME_LEN) == 0)
+            {
+                member_of[c] = m;
+            }
+        }
+    }
+
+    uint64_t first, last;
+    row_range(log, from_sec, to_sec, first, last);
+    uint64_t start = now_ns();
+    uint64_t sent = 0;
+    for (uint64_t row = first; row < last && running; row++)
+    {
+        if (speed > 0)
+        {
+            uint64_t due = start + (uint64_t)((log.timestamp(row) - log.timestamp(first)) / speed);
+            uint64_t now = now_ns();
+            if (due > now)
+            {
+                usleep((due - now) / 1000);
+            }
+        }
+        uint8_t *frame = NULL;
+        uint32_t len = encode_row(log, row, member_of, &frame);
+        for (uint32_t off = 0; off < len && running;)
+        {
+            ssize_t n = write(fd, frame + off, len - off);
+            if (n > 0)
+            {
+                off += n;
+            }
+            else
+            {
+                struct pollfd pfd = {fd, POLLOUT, 0};
+                poll(&pfd, 1, 100);
+            }
+        }
+        sent++;
+    }
+    double secs = (now_ns() - start) / 1e9;
+    fprintf(stderr, "replayed %llu rows in %.2f s (%.0f rows/s)\n", (unsigned long long)sent, secs,
+            secs > 0 ? sent / secs : 0.0);
+    return 0;
+}
+
+//================================================================
+
+#define TRACE_NAME(name, value, shift) #name,
+static const char *const trace_names[] = {TRACE_CHANNELS(TRACE_NAME)};
+static const uint32_t TRACE_NAMES = sizeof(trace_names) / sizeof(trace_names[0]);
+
+// bytes of one value in a CBOR map keyed by field id: key plus integer
+static uint32_t cbor_field_size(int32_t value)
+{
+    uint32_t magnitude = value < 0 ? -(value + 1) : value;
+    return 1 + (magnitude < 24 ? 1 : magnitude < 0x100 ? 2 : magnitude < 0x10000 ? 3 : 5);
+}
+
+struct TraceStats
+{
+    uint64_t events = 0;
+    uint64_t rows = 0;
+    uint64_t packed_bytes = 0; // TraceEvent payloads, header fields included
+    uint64_t map_bytes = 0;    // the same rows as one CBOR map each
+    uint32_t skipped = 0;
+};
+
+static void print_trace(TraceStats &stats, const TraceEvent &event, size_t payload_size)
+{
+    if (!event.tick || !event.rows || !event.channels || !event.shifts || !event.columns)
+    {
+        event_decode_errors++;
+        return;
+    }
+    uint32_t mask = *event.channels;
+    uint32_t n_ch = __builtin_popcount(mask);
+    uint32_t rows = *event.rows;
+    std::vector<int32_t> values(rows * n_ch);
+    if (event.shifts->size() != n_ch ||
+        column_unpack(event.columns->data(), event.columns->size(), n_ch, rows, event.shifts->data(), values.data()) == 0)
+    {
+        event_decode_errors++;
+        return;
+    }
+    if (stats.events++ == 0)
+    {
+        printf("tick");
+        for (uint32_t c = 0; c < 32; c++)
+        {
+            if (mask & (1U << c))
+            {
+                printf(",%s", c < TRACE_NAMES ? trace_names[c] : "?");
+            }
+        }
+        printf("\n");
+    }
+    uint32_t interval = event.interval ? *event.interval : 1;
+    for (uint32_t r = 0; r < rows; r++)
+    {
+        printf("%u", *event.tick + r * interval);
+        uint32_t map_bytes = 1;
+        for (uint32_t c = 0; c < n_ch; c++)
+        {
+            int32_t value = values[r * n_ch + c];
+            printf(",%d", value);
+            map_bytes += cbor_field_size(value);
+        }
+        printf("\n");
+        stats.map_bytes += map_bytes;
+    }
+    stats.rows += rows;
+    stats.packed_bytes += payload_size;
+    stats.skipped = event.skipped ? *event.skipped : 0;
+}
+
+// Opens the device of a trace/stats command line and feeds its frames to on_msg until -d or a signal
+template <typename F>
+static int read_device(int argc, char **argv, double &secs, F on_msg)
+{
+    long baud = 115200;
+    double duration_sec = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "b:d:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'b': baud = atol(optarg); break;
+        case 'd': duration_sec = atof(optarg); break;
+        default: return usage();
+        }
+    }
+    if (optind != argc - 1)
+    {
+        return usage();
+    }
+    int fd = open_port(argv[optind], baud);
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    FrameReader reader(FRAME_BUFFER_SIZE);
+    uint64_t start = now_ns();
+    uint64_t end = duration_sec > 0 ? start + (uint64_t)(duration_sec * 1e9) : UINT64_MAX;
+    uint8_t rx_buf[4096];
+    while (running && now_ns() < end)
+    {
+        struct pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, 100) > 0 && (pfd.revents & POLLIN))
+        {
+            ssize_t n = read(fd, rx_buf, sizeof(rx_buf));
+            if (n > 0)
+            {
+                reader.feed(rx_buf, n, on_msg);
+            }
+        }
+    }
+    secs = (now_ns() - start) / 1e9;
+    return 0;
+}
+
+static int cmd_trace(int argc, char **argv)
+{
+    TraceStats stats;
+    double secs = 0;
+    int rc = read_device(argc, argv, secs, [&](uint32_t msg_type, const Buffer &payload)
+                         {
+        if (msg_type != TraceEvent::MSG_ID)
+        {
+            return;
+        }
+        TraceEvent event;
+        if (event.decode(payload) != 0)
+        {
+            event_decode_errors++;
+            return;
+        }
+        print_trace(stats, event, payload.size()); });
+    if (rc != 0)
+    {
+        return rc;
+    }
+    fprintf(stderr, "trace %llu rows in %llu events, %.1f rows/s, %llu skipped on the board, %llu decode errors\n",
+            (unsigned long long)stats.rows, (unsigned long long)stats.events, stats.rows / secs,
+            (unsigned long long)stats.skipped, (unsigned long long)event_decode_errors);
+    if (stats.rows)
+    {
+        fprintf(stderr, "%.1f bytes/row packed, %.1f bytes/row as CBOR maps: %.1fx\n",
+                (double)stats.packed_bytes / stats.rows, (double)stats.map_bytes / stats.rows,
+                (double)stats.map_bytes / stats.packed_bytes);
+    }
+    return 0;
+}
+
+//================================================================
+
+// IsrStatsChannel order
+static const char *const stats_names[] = {
+    "curl_phaa", "curl_phab", "curl_dc", "curr_phab", "curr_phac", "curr_dc",
+    "iq_l", "id_l", "iq_r", "id_r", "batt"};
+static_assert(sizeof(stats_names) / sizeof(stats_names[0]) == ISR_STATS_COUNT, "stats_names out of date");
+
+static int cmd_stats(int argc, char **argv)
+{
+    uint64_t events = 0;
+    double secs = 0;
+    int rc = read_device(argc, argv, secs, [&](uint32_t msg_type, const Buffer &payload)
+                         {
+        if (msg_type != HoverboardEvent::MSG_ID)
+        {
+            return;
+        }
+        HoverboardEvent event;
+        if (event.decode(payload) != 0)
+        {
+            event_decode_errors++;
+            return;
+        }
+        if (!event.isr_stats || !event.isr_stats_periods || event.isr_stats->size() != ISR_STATS_COUNT * 8)
+        {
+            return; // not a LIMERO_STATS build
+        }
+        if (events++ == 0)
+        {
+            printf("time_us,periods");
+            for (const char *name : stats_names)
+            {
+                printf(",%s_min,%s_max,%s_mean,%s_rms", name, name, name, name);
+            }
+            printf("\n");
+        }
+        printf("%u,%d", event.time_us ? *event.time_us : 0, *event.isr_stats_periods);
+        const uint8_t *p = event.isr_stats->data();
+        for (uint32_t i = 0; i < ISR_STATS_COUNT * 4; i++, p += 2)
+        {
+            uint16_t v = (uint16_t)(p[0] | p[1] << 8);
+            printf(",%d", i % 4 == 3 ? (int)v : (int)(int16_t)v);
+        }
+        printf("\n"); });
+    if (rc != 0)
+    {
+        return rc;
+    }
+    fprintf(stderr, "stats %llu events in %.1f s, %llu decode errors\n",
+            (unsigned long long)events, secs, (unsigned long long)event_decode_errors);
+    return 0;
+}
+
+static int cmd_energy(int argc, char **argv)
+{
+    uint64_t events = 0;
+    double secs = 0;
+    int rc = read_device(argc, argv, secs, [&](uint32_t msg_type, const Buffer &payload)
+                         {
+        if (msg_type != EnergyEvent::MSG_ID)
+        {
+            return;
+        }
+        EnergyEvent e;
+        if (e.decode(payload) != 0)
+        {
+            event_decode_errors++;
+            return;
+        }
+        if (events++ == 0)
+        {
+            printf("host_s,left_used_mah,left_regen_mah,left_used_mwh,left_regen_mwh,"
+                   "right_used_mah,right_regen_mah,right_used_mwh,right_regen_mwh,"
+                   "total_used_mah,total_regen_mah,total_used_mwh,total_regen_mwh\n");
+        }
+        const Option<uint32_t> *v[] = {&e.left_used_mah, &e.left_regen_mah, &e.left_used_mwh, &e.left_regen_mwh,
+                                       &e.right_used_mah, &e.right_regen_mah, &e.right_used_mwh, &e.right_regen_mwh,
+                                       &e.total_used_mah, &e.total_regen_mah, &e.total_used_mwh, &e.total_regen_mwh};
+        printf("%.3f", now_ns(CLOCK_REALTIME) / 1e9);
+        for (const Option<uint32_t> *o : v)
+        {
+            printf(",%u", *o ? **o : 0);
+        }
+        printf("\n"); });
+    if (rc != 0)
+    {
+        return rc;
+    }
+    fprintf(stderr, "energy %llu events in %.1f s, %llu decode errors\n",
+            (unsigned long long)events, secs, (unsigned long long)event_decode_errors);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        return usage();
+    }
+    const char *cmd = argv[1];
+    argc--;
+    argv++;
+    if (strcmp(cmd, "record") == 0)
+    {
+        return cmd_record(argc, argv);
+    }
+    if (strcmp(cmd, "info") == 0)
+    {
+        return cmd_info(argc, argv);
+    }
+    if (strcmp(cmd, "query") == 0)
+    {
+        return cmd_query(argc, argv);
+    }
+    if (strcmp(cmd, "replay") == 0)
+    {
+        return cmd_replay(argc, argv);
+    }
+    if (strcmp(cmd, "trace") == 0)
+    {
+        return cmd_trace(argc, argv);
+    }
+    if (strcmp(cmd, "stats") == 0)
+    {
+        return cmd_stats(argc, argv);
+    }
+    if (strcmp(cmd, "energy") == 0)
+    {
+        return cmd_energy(argc, argv);
+    }
+    return usage();
+}
@@ -0,0 +1,389 @@
+/*
+ * limero_scope : arm a LIMERO_SCOPE capture on the board and save it as CSV.
+ *
+ *   limero_scope [-b baud] [-c ch,ch,...] [-n decimation] [-t trigger] [-T channel]
+ *                [-l level] [-p pre_samples] [-w timeout_sec] <device> [file.csv]
+ *
+ *   -c  up to SCOPE_CHANNELS_MAX (10) channels by name (curl_phaa,curl_phab)
+ *   -n  keep one sample in this many 16 kHz periods (1)
+ *   -t  host (trigger at once), rising, falling or error (host)
+ *   -T  channel the rising/falling trigger looks at (first of -c)
+ *   -l  trigger level in the channel's raw units (0)
+ *   -p  samples per channel before the trigger (capture size / 4)
+ *   -w  give up after this many seconds without a finished capture (30)
+ *
+ * The board sends the finished capture one chunk per telemetry frame.
+ * Chunks lost on the way are asked for again with ScopeRequest.resend.
+ * The CSV has one row per sample: time relative to the trigger in
+ * microseconds, then one column per channel.
+ */
+
+#include "config.h" // PWM_FREQ
+#include "scope.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+
+#include <limero/log.h>
+#include <limero/codec.h>
+#include <limero/msgs_hoverboard.h>
+#include "frame_reader.h"
+#include "host_util.h"
+
+Log logger(256);
+
+void panic_here(const char *s)
+{
+    fprintf(stderr, " ===> PANIC : %s\n", s);
+    abort();
+}
+
+// ScopeChannel order
+static const char *const channel_names[] = {
+    "curl_phaa", "curl_phab", "curl_dc",
+    "curr_phab", "curr_phac", "curr_dc",
+    "iq_l", "id_l", "iq_r", "id_r",
+    "angle_l", "angle_r",
+    "speed_l", "speed_r",
+    "ctl_l", "tgt_l", "ctl_r", "tgt_r",
+};
+static_assert(sizeof(channel_names) / sizeof(channel_names[0]) == SCOPE_CH_COUNT, "channel_names out of sync with ScopeChannel");
+
+static const char *const trigger_names[] = {"host", "rising", "falling", "error"};
+
+static int lookup(const char *name, const char *const *names, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (strcmp(name, names[i]) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int send_request(int fd, const ScopeRequest &request)
+{
+    static Buffer payload(64);
+    static Buffer envelope_buffer(128);
+    if (request.encode(payload) != 0)
+    {
+        return EINVAL;
+    }
+    Envelope envelope;
+    envelope.src = FNV("limero_scope");
+    envelope.dst = FNV("hoverboard");
+    envelope.msg_type = ScopeRequest::MSG_ID;
+    envelope.payload = payload.to_vector();
+    if (envelope.encode(envelope_buffer) != 0)
+    {
+        return EINVAL;
+    }
+    FrameEncoder frame(envelope_buffer.data(), envelope_buffer.capacity(), envelope_buffer.size());
+    if (frame.add_crc().is_err() || frame.add_cobs().is_err())
+    {
+        return EINVAL;
+    }
+    if (write(fd, frame.data(), frame.size()) != (ssize_t)frame.size())
+    {
+        return errno;
+    }
+    return 0;
+}
+
+struct Capture
+{
+    uint32_t id = 0;        // 0 until the board reports the capture armed by us
+    uint32_t state = SCOPE_IDLE;
+    uint32_t channels = 0;
+    uint32_t decimation = 1;
+    uint32_t pre_samples = 0;
+    uint32_t samples = 0;
+    uint32_t n_ch = 0;
+    std::vector<int16_t> data;
+    std::vector<bool> have;  // per sample
+    uint32_t received = 0;
+
+    uint32_t first_missing() const
+    {
+        for (uint32_t i = 0; i < samples; i++)
+        {
+            if (!have[i])
+            {
+                return i;
+            }
+        }
+        return samples;
+    }
+};
+
+static void handle_event(Capture &capture, const ScopeEvent &event)
+{
+    if (!event.capture_id || !event.state || !event.channels || !event.samples)
+    {
+        return;
+    }
+    if (capture.id == 0)
+    {
+        capture.id = *event.capture_id;
+        capture.channels = *event.channels;
+        capture.decimation = event.decimation ? *event.decimation : 1;
+        capture.pre_samples = event.pre_samples ? *event.pre_samples : 0;
+        capture.samples = *event.samples;
+        capture.n_ch = __builtin_popcount(capture.channels);
+        capture.data.assign(capture.samples * capture.n_ch, 0);
+        capture.have.assign(capture.samples, false);
+    }
+    if (*event.capture_id != capture.id)
+    {
+        return; // someone else re-armed the board
+    }
+    capture.state = *event.state;
+    if (!event.offset || !event.data)
+    {
+        return;
+    }
+    const std::vector<uint8_t> &bytes = *event.data;
+    uint32_t rows = bytes.size() / 2 / capture.n_ch;
+    for (uint32_t r = 0; r < rows && *event.offset + r < capture.samples; r++)
+    {
+        uint32_t sample = *event.offset + r;
+        for (uint32_t c = 0; c < capture.n_ch; c++)
+        {
+            size_t i = (r * capture.n_ch + c) * 2;
+            capture.data[sample * capture.n_ch + c] = (int16_t)(bytes[i] | bytes[i + 1] << 8);
+        }
+        if (!capture.have[sample])
+        {
+            capture.have[sample] = true;
+            capture.received++;
+        }
+    }
+}
+
+static void write_csv(FILE *out, const Capture &capture)
+{
+    fprintf(out, "time_us");
+    for (uint32_t ch = 0; ch < SCOPE_CH_COUNT; ch++)
+    {
+        if (capture.channels & (1U << ch))
+        {
+            fprintf(out, ",%s", channel_names[ch]);
+        }
+    }
+    fprintf(out, "\n");
+    const double period_us = 1e6 / PWM_FREQ * capture.decimation;
+    for (uint32_t s = 0; s < capture.samples; s++)
+    {
+        fprintf(out, "%.1f", ((int32_t)s - (int32_t)capture.pre_samples) * period_us);
+        for (uint32_t c = 0; c < capture.n_ch; c++)
+        {
+            fprintf(out, ",%d", capture.data[s * capture.n_ch + c]);
+        }
+        fprintf(out, "\n");
+    }
+}
+
+static int usage(const char *argv0)
+{
+    fprintf(stderr, "usage: %s [-b baud] [-c ch,ch,...] [-n decimation] [-t host|rising|falling|error] [-T channel]\n"
+                    "       [-l level] [-p pre_samples] [-w timeout_sec] <device> [file.csv]\n"
+                    "channels:",
+            argv0);
+    for (const char *name : channel_names)
+    {
+        fprintf(stderr, " %s", name);
+    }
+    fprintf(stderr, "\n");
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    long baud = 115200;
+    uint32_t channels = 0;
+    uint32_t decimation = 1;
+    int trigger = SCOPE_TRIG_HOST;
+    int trigger_channel = -1;
+    int32_t level = 0;
+    int pre_samples = -1;
+    double timeout_sec = 30;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "b:c:n:t:T:l:p:w:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'b': baud = atol(optarg); break;
+        case 'c':
+            for (char *name = strtok(optarg, ","); name; name = strtok(NULL, ","))
+            {
+                int ch = lookup(name, channel_names, SCOPE_CH_COUNT);
+                if (ch < 0)
+                {
+                    fprintf(stderr, "%s: unknown channel %s\n", argv[0], name);
+                    return usage(argv[0]);
+                }
+                channels |= 1U << ch;
+            }
+            break;
+        case 'n': decimation = atoi(optarg); break;
+        case 't':
+            trigger = lookup(optarg, trigger_names, 4);
+            if (trigger < 0)
+            {
+                return usage(argv[0]);
+            }
+            break;
+        case 'T':
+            trigger_channel = lookup(optarg, channel_names, SCOPE_CH_COUNT);
+            if (trigger_channel < 0)
+            {
+                return usage(argv[0]);
+            }
+            break;
+        case 'l': level = atoi(optarg); break;
+        case 'p': pre_samples = atoi(optarg); break;
+        case 'w': timeout_sec = atof(optarg); break;
+        default: return usage(argv[0]);
+        }
+    }
+    if (optind != argc - 1 && optind != argc - 2)
+    {
+        return usage(argv[0]);
+    }
+    if (channels == 0)
+    {
+        channels = 1U << SCOPE_CH_CURL_PHAA | 1U << SCOPE_CH_CURL_PHAB;
+    }
+    uint32_t n_ch = __builtin_popcount(channels);
+    if (n_ch > SCOPE_CHANNELS_MAX)
+    {
+        fprintf(stderr, "%s: at most %d channels\n", argv[0], SCOPE_CHANNELS_MAX);
+        return 1;
+    }
+    if (trigger_channel < 0)
+    {
+        trigger_channel = __builtin_ctz(channels);
+    }
+    if (pre_samples < 0)
+    {
+        pre_samples = SCOPE_BUFFER_SIZE / n_ch / 4;
+    }
+
+    int fd = open_port(argv[optind], baud);
+    FILE *out = optind == argc - 2 ? fopen(argv[optind + 1], "w") : stdout;
+    if (!out)
+    {
+        fprintf(stderr, "%s: %s: %s\n", argv[0], argv[optind + 1], strerror(errno));
+        return 1;
+    }
+
+    const uint32_t req_id = 1;
+    ScopeRequest arm;
+    arm.req_id = req_id;
+    arm.channels = channels;
+    arm.decimation = decimation;
+    arm.trigger = trigger;
+    arm.trigger_channel = trigger_channel;
+    arm.level = level;
+    arm.pre_samples = pre_samples;
+    arm.force = trigger == SCOPE_TRIG_HOST ? 1 : 0;
+
+    FrameReader reader(2048);
+    Capture capture;
+    bool armed = false;
+    uint64_t start = now_ns();
+    uint64_t deadline = start + (uint64_t)(timeout_sec * 1e9);
+    uint64_t next_arm = start;
+    uint64_t last_progress = start;
+    uint8_t rx_buf[1024];
+    int rc = 0;
+
+    for (uint64_t now = start;; now = now_ns())
+    {
+        if (now >= deadline)
+        {
+            fprintf(stderr, "%s: timeout, capture %s\n", argv[0],
+                    !armed ? "not armed" : capture.state == SCOPE_DONE ? "incomplete" : "not triggered");
+            rc = 1;
+            break;
+        }
+        if (!armed && now >= next_arm)
+        {
+            send_request(fd, arm);
+            next_arm = now + 1000000000ULL;
+        }
+        struct pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, 100) > 0 && (pfd.revents & POLLIN))
+        {
+            ssize_t n = read(fd, rx_buf, sizeof(rx_buf));
+            if (n <= 0)
+            {
+                continue;
+            }
+            reader.feed(rx_buf, n, [&](uint32_t msg_type, const Buffer &payload)
+                        {
+                if (msg_type == GenericReply::MSG_ID)
+                {
+                    GenericReply reply;
+                    if (reply.decode(payload) == 0 && reply.req_id == req_id && reply.msg_type == ScopeRequest::MSG_ID)
+                    {
+                        if (reply.error_code && *reply.error_code)
+                        {
+                            fprintf(stderr, "limero_scope: board rejected the capture settings\n");
+                            rc = 1;
+                        }
+                        armed = true;
+                    }
+                }
+                else if (msg_type == ScopeEvent::MSG_ID && armed)
+                {
+                    ScopeEvent event;
+                    uint32_t received = capture.received;
+                    if (event.decode(payload) == 0)
+                    {
+                        handle_event(capture, event);
+                    }
+                    if (capture.received != received)
+                    {
+                        last_progress = now_ns();
+                    }
+                } });
+        }
+        if (rc)
+        {
+            break;
+        }
+        if (capture.id && capture.received == capture.samples)
+        {
+            break;
+        }
+        // the board sends each chunk once, ask again from the first gap when the stream stalls
+        if (capture.state == SCOPE_DONE && now_ns() - last_progress > 1000000000ULL)
+        {
+            ScopeRequest resend;
+            resend.resend = capture.first_missing();
+            send_request(fd, resend);
+            last_progress = now_ns();
+        }
+    }
+    if (rc == 0)
+    {
+        write_csv(out, capture);
+        fprintf(stderr, "capture %u: %u samples x %u channels, %.1f us per sample, trigger at sample %u\n",
+                capture.id, capture.samples, capture.n_ch, 1e6 / PWM_FREQ * capture.decimation, capture.pre_samples);
+    }
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+    return rc;
+}
@@ -0,0 +1,285 @@
+/*
+ * limero_sim : the firmware Limero endpoint running on Linux.
+ *
+ * Src/limero/serial.cpp is compiled unchanged and attached to a pseudo
+ * terminal. The main loop of the board is emulated at DELAY_IN_MAIN_LOOP,
+ * telemetry is sent at a configurable rate and every received byte goes
+ * through handle_rxd() exactly as it does from usart2_rx_check().
+ *
+ *   limero_sim [-r tx_hz] [-b baud] [-l link] [-s stats_sec] [-d duration_sec] [-k ppm]
+ *
+ *   -r  telemetry frames per second, 0 = as fast as the wire allows (5)
+ *   -b  emulated USART baud rate, 0 = unpaced (USART2_BAUD)
+ *   -l  create a symlink to the slave side of the pty
+ *   -s  statistics interval in seconds (1)
+ *   -d  stop after this many seconds, 0 = run until SIGINT (0)
+ *   -k  board clock error in ppm, for checking clock synchronisation (0)
+ */
+
+// firmware headers first: <termios.h> defines names (CR1, ...) used as register fields
+#include "stm32f1xx_hal.h"
+#include "config.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "host_util.h"
+
+extern "C"
+{
+    uint32_t get_txd(uint8_t **buffer);
+    void limero_tx_busy(void);
+    void handle_rxd(uint8_t *buffer, size_t size);
+    void board_init(void);
+    void board_step(void);
+    void limero_trace(uint32_t tick);
+    extern volatile uint32_t main_loop_counter;
+    extern uint32_t board_cmd_count;
+    extern double board_clock_ppm;
+}
+
+static volatile sig_atomic_t running = 1;
+
+static void on_signal(int)
+{
+    running = 0;
+}
+
+struct SimStats
+{
+    uint64_t tx_frames = 0;
+    uint64_t tx_bytes = 0;
+    uint64_t tx_busy = 0;    // frame due while the previous one was still on the wire
+    uint64_t tx_cpu_ns = 0;  // thread CPU spent in get_txd()
+    uint64_t rx_frames = 0;  // frame delimiters seen
+    uint64_t rx_bytes = 0;
+    uint64_t rx_cpu_ns = 0;  // thread CPU spent in handle_rxd()
+    uint64_t cmds = 0;       // HoverboardRequests applied by the main loop
+};
+
+static void print_stats(const SimStats &s, const SimStats &prev, double secs)
+{
+    uint64_t tx = s.tx_frames - prev.tx_frames;
+    uint64_t rx = s.rx_frames - prev.rx_frames;
+    fprintf(stderr,
+            "tx %7.1f fps %8.0f B/s busy %-6llu | rx %7.1f fps %8.0f B/s cmd %-6llu | cpu get_txd %6.2f us handle_rxd %6.2f us\n",
+            tx / secs, (s.tx_bytes - prev.tx_bytes) / secs,
+            (unsigned long long)(s.tx_busy - prev.tx_busy),
+            rx / secs, (s.rx_bytes - prev.rx_bytes) / secs,
+            (unsigned long long)(s.cmds - prev.cmds),
+            tx ? (s.tx_cpu_ns - prev.tx_cpu_ns) / 1000.0 / tx : 0.0,
+            rx ? (s.rx_cpu_ns - prev.rx_cpu_ns) / 1000.0 / rx : 0.0);
+}
+
+static int open_pty(const char *link)
+{
+    int master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+    {
+        perror("posix_openpt");
+        exit(1);
+    }
+    struct termios tio;
+    tcgetattr(master, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(master, TCSANOW, &tio);
+
+    const char *slave = ptsname(master);
+    fprintf(stderr, "limero_sim: endpoint on %s\n", slave);
+    if (link)
+    {
+        unlink(link);
+        if (symlink(slave, link) != 0)
+        {
+            perror("symlink");
+        }
+        else
+        {
+            fprintf(stderr, "limero_sim: linked as %s\n", link);
+        }
+    }
+    // keep a slave handle open so the master does not report POLLHUP while no client is attached
+    if (open(slave, O_RDWR | O_NOCTTY) < 0)
+    {
+        perror("open slave");
+        exit(1);
+    }
+    return master;
+}
+
+int main(int argc, char **argv)
+{
+    double tx_hz = 5;
+    long baud = USART2_BAUD;
+    const char *link = NULL;
+    double stats_sec = 1;
+    double duration_sec = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "r:b:l:s:d:k:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'r': tx_hz = atof(optarg); break;
+        case 'b': baud = atol(optarg); break;
+        case 'l': link = optarg; break;
+        case 's': stats_sec = atof(optarg); break;
+        case 'd': duration_sec = atof(optarg); break;
+        case 'k': board_clock_ppm = atof(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-r tx_hz] [-b baud] [-l link] [-s stats_sec] [-d duration_sec] [-k ppm]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    int fd = open_pty(link);
+    board_init();
+
+    const uint64_t loop_period = DELAY_IN_MAIN_LOOP * 1000000ULL;
+    const uint64_t tx_period = tx_hz > 0 ? (uint64_t)(1e9 / tx_hz) : 0;
+    const uint64_t ns_per_byte = baud > 0 ? 10ULL * 1000000000ULL / baud : 0; // 8N1
+
+    uint64_t start = now_ns();
+    uint64_t next_loop = start;
+    uint64_t next_tx = start;
+    uint64_t next_stats = start + (uint64_t)(stats_sec * 1e9);
+    uint64_t last_stats = start;
+    uint64_t wire_free = start;
+
+    uint8_t *pending = NULL; // frame handed to the "DMA" but not yet fully written
+    uint32_t pending_len = 0;
+
+    SimStats stats, prev;
+    uint8_t rx_buf[256];
+
+    while (running)
+    {
+        uint64_t now = now_ns();
+        if (duration_sec > 0 && now - start >= (uint64_t)(duration_sec * 1e9))
+        {
+            break;
+        }
+
+        // main loop ticks
+        while (now >= next_loop)
+        {
+            board_step();
+#ifdef LIMERO_TRACE
+            limero_trace(main_loop_counter);
+#endif
+            next_loop += loop_period;
+        }
+        stats.cmds = board_cmd_count;
+
+        // telemetry, skipped like main.c does while the previous DMA transfer is running
+        if (tx_period == 0 || now >= next_tx)
+        {
+            if (pending_len || now < wire_free)
+            {
+                if (tx_period)
+                {
+                    stats.tx_busy++;
+                    limero_tx_busy();
+                }
+            }
+            else
+            {
+                uint64_t t0 = now_ns(CLOCK_THREAD_CPUTIME_ID);
+                pending_len = get_txd(&pending);
+                stats.tx_cpu_ns += now_ns(CLOCK_THREAD_CPUTIME_ID) - t0;
+                if (pending_len)
+                {
+                    stats.tx_frames++;
+                    stats.tx_bytes += pending_len;
+                    wire_free = now + pending_len * ns_per_byte;
+                }
+            }
+            if (tx_period)
+            {
+                next_tx += tx_period;
+                if (next_tx < now)
+                {
+                    next_tx = now + tx_period;
+                }
+            }
+        }
+        if (pending_len)
+        {
+            ssize_t n = write(fd, pending, pending_len);
+            if (n > 0)
+            {
+                pending += n;
+                pending_len -= n;
+            }
+        }
+
+        if (now >= next_stats)
+        {
+            print_stats(stats, prev, (now - last_stats) / 1e9);
+            prev = stats;
+            last_stats = now;
+            next_stats += (uint64_t)(stats_sec * 1e9);
+        }
+
+        // sleep until the next deadline or until bytes arrive
+        uint64_t deadline = next_loop;
+        if (tx_period && next_tx < deadline)
+        {
+            deadline = next_tx;
+        }
+        if (tx_period == 0 && wire_free > now && wire_free < deadline)
+        {
+            deadline = wire_free;
+        }
+        struct pollfd pfd = {fd, POLLIN, 0};
+        if (pending_len || (tx_period == 0 && wire_free <= now))
+        {
+            pfd.events |= POLLOUT;
+        }
+        now = now_ns();
+        uint64_t wait = deadline > now ? deadline - now : 0;
+        struct timespec ts = {(time_t)(wait / 1000000000ULL), (long)(wait % 1000000000ULL)};
+        if (ppoll(&pfd, 1, &ts, NULL) < 0 && errno != EINTR)
+        {
+            perror("ppoll");
+            break;
+        }
+        if (pfd.revents & POLLIN)
+        {
+            ssize_t n = read(fd, rx_buf, sizeof(rx_buf));
+            if (n > 0)
+            {
+                uint64_t t0 = now_ns(CLOCK_THREAD_CPUTIME_ID);
+                handle_rxd(rx_buf, n);
+                stats.rx_cpu_ns += now_ns(CLOCK_THREAD_CPUTIME_ID) - t0;
+                stats.rx_bytes += n;
+                for (ssize_t i = 0; i < n; i++)
+                {
+                    if (rx_buf[i] == 0x00)
+                    {
+                        stats.rx_frames++;
+                    }
+                }
+            }
+        }
+    }
+
+    fprintf(stderr, "limero_sim: total ");
+    print_stats(stats, SimStats(), (now_ns() - start) / 1e9);
+    if (link)
+    {
+        unlink(link);
+    }
+    return 0;
+}
@@ -0,0 +1,146 @@
+/*
+ * Plant model of one hoverboard hub motor, see motor_model.h.
+ */
+
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+#include "config.h"   // A2BIT_CONV, PWM_FREQ
+#include "motor_model.h"
+
+#define PWM_RES   (64000000 / 2 / PWM_FREQ)   // pwm_res in setup.c
+#define SQRT3     1.7320508075688772
+
+// hall levels for hall positions 0..5, the inverse of vec_hallToPos in BLDC_controller_data.c
+static const uint8_t hall_of_pos[6] = {2, 3, 1, 5, 4, 6};
+
+void motor_params_default(MotorParams *p)
+{
+  // a 6.5" hoverboard wheel: 15 pole pairs, ~25 rpm/V
+  p->pole_pairs  = 15;
+  p->r_phase     = 0.15;
+  p->l_phase     = 0.3e-3;
+  p->psi         = 0.022;
+  p->inertia     = 0.01;
+  p->friction    = 0.05;
+  p->damping     = 0.0005;
+  p->load        = 0;
+  p->v_bat       = 36.0;
+  p->hall_offset = 330;   // SIN runs equally fast both ways, FOC holds id at 0 under load
+  p->substeps    = 4;
+}
+
+int motor_param_set(MotorParams *p, const char *name, double value)
+{
+  static const struct { const char *name; size_t offset; } fields[] = {
+    {"pole_pairs",  offsetof(MotorParams, pole_pairs)},
+    {"r_phase",     offsetof(MotorParams, r_phase)},
+    {"l_phase",     offsetof(MotorParams, l_phase)},
+    {"psi",         offsetof(MotorParams, psi)},
+    {"inertia",     offsetof(MotorParams, inertia)},
+    {"friction",    offsetof(MotorParams, friction)},
+    {"damping",     offsetof(MotorParams, damping)},
+    {"load",        offsetof(MotorParams, load)},
+    {"v_bat",       offsetof(MotorParams, v_bat)},
+    {"hall_offset", offsetof(MotorParams, hall_offset)},
+  };
+  if (strcmp(name, "substeps") == 0) {
+    p->substeps = value < 1 ? 1 : (int)value;
+    return 0;
+  }
+  for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+    if (strcmp(name, fields[i].name) == 0) {
+      *(double *)((char *)p + fields[i].offset) = value;
+      return 0;
+    }
+  }
+  return -1;
+}
+
+void motor_init(Motor *m, const MotorParams *p)
+{
+  memset(m, 0, sizeof(*m));
+  m->p = *p;
+}
+
+void motor_step(Motor *m, int16_t dc_a, int16_t dc_b, int16_t dc_c, int enabled, double dt)
+{
+  const MotorParams *p = &m->p;
+  // leg duties, clamped like the timer compare values
+  double d_a = (dc_a + PWM_RES / 2) / (double)PWM_RES;
+  double d_b = (dc_b + PWM_RES / 2) / (double)PWM_RES;
+  double d_c = (dc_c + PWM_RES / 2) / (double)PWM_RES;
+  d_a = d_a < 0 ? 0 : d_a > 1 ? 1 : d_a;
+  d_b = d_b < 0 ? 0 : d_b > 1 ? 1 : d_b;
+  d_c = d_c < 0 ? 0 : d_c > 1 ? 1 : d_c;
+  // the common mode drops out against the floating star point
+  double v_alpha = p->v_bat * (2 * d_a - d_b - d_c) / 3;
+  double v_beta  = p->v_bat * (d_b - d_c) / SQRT3;
+
+  double h = dt / p->substeps;
+  double i_dc = 0;
+  for (int k = 0; k < p->substeps; k++) {
+    double omega_e = m->omega * p->pole_pairs;
+    double s = sin(m->theta);
+    double c = cos(m->theta);
+    if (enabled) {
+      double e_alpha = -p->psi * omega_e * s;
+      double e_beta  =  p->psi * omega_e * c;
+      m->i_alpha += h * (v_alpha - p->r_phase * m->i_alpha - e_alpha) / p->l_phase;
+      m->i_beta  += h * (v_beta  - p->r_phase * m->i_beta  - e_beta)  / p->l_phase;
+    } else {
+      // all switches open: below the battery voltage the back-EMF cannot drive the diodes
+      m->i_alpha = 0;
+      m->i_beta  = 0;
+    }
+    m->torque = 1.5 * p->pole_pairs * p->psi * (m->i_beta * c - m->i_alpha * s);
+
+    double t_fric = p->damping * m->omega;
+    if (m->omega > 1e-3) {
+      t_fric += p->friction + p->load;
+    } else if (m->omega < -1e-3) {
+      t_fric -= p->friction + p->load;
+    } else {
+      // standing still: static friction holds up to its limit
+      double t_hold = p->friction + p->load;
+      t_fric = fabs(m->torque) <= t_hold ? m->torque : (m->torque > 0 ? t_hold : -t_hold);
+    }
+    m->omega += h * (m->torque - t_fric) / p->inertia;
+    m->theta = fmod(m->theta + h * m->omega * p->pole_pairs, 2 * M_PI);
+    if (m->theta < 0) {
+      m->theta += 2 * M_PI;
+    }
+
+    double i_a = m->i_alpha;
+    double i_b = -0.5 * m->i_alpha + 0.5 * SQRT3 * m->i_beta;
+    double i_c = -i_a - i_b;
+    i_dc += d_a * i_a + d_b * i_b + d_c * i_c;
+  }
+  m->i_dc = i_dc / p->substeps;
+}
+
+void motor_sensors(const Motor *m, MotorSensors *s)
+{
+  double deg = m->theta * (180 / M_PI) + m->p.hall_offset;
+  int pos = (int)floor(deg / 60) % 6;
+  if (pos < 0) {
+    pos += 6;
+  }
+  uint8_t hall = hall_of_pos[pos];
+  s->hall_a = (hall >> 2) & 1;
+  s->hall_b = (hall >> 1) & 1;
+  s->hall_c = hall & 1;
+
+  double i_a = m->i_alpha;
+  double i_b = -0.5 * m->i_alpha + 0.5 * SQRT3 * m->i_beta;
+  double i_c = -i_a - i_b;
+  s->i_pha_a = (int16_t)lround(A2BIT_CONV * i_a);
+  s->i_pha_b = (int16_t)lround(A2BIT_CONV * i_b);
+  s->i_pha_c = (int16_t)lround(A2BIT_CONV * i_c);
+  s->i_dc    = (int16_t)lround(-A2BIT_CONV * m->i_dc);  // main.c: dc_curr = -curL_DC / A2BIT_CONV
+}
+
+double motor_rpm(const Motor *m)
+{
+  return m->omega * (60 / (2 * M_PI));
+}
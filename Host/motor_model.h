@@ -0,0 +1,67 @@
+/*
+ * Plant model of one hoverboard hub motor for the host simulator.
+ *
+ * A surface magnet PMSM with a sinusoidal back-EMF, simulated in the
+ * stationary alpha/beta frame. The bridge is averaged over a PWM period: the
+ * three DC_phaX outputs of BLDC_controller_step() set the duty of each leg
+ * and the phase voltages follow from the battery voltage. One call of
+ * motor_step() advances the model one 16 kHz control period with a few
+ * explicit Euler substeps.
+ *
+ * The outputs are what the ISR in bldc.c hands to the controller: the three
+ * hall levels, the phase currents in ADC bits (A2BIT_CONV per amp) and the
+ * DC link current, with the signs of curL_phaA/curR_phaB etc.
+ */
+
+#ifndef MOTOR_MODEL_H
+#define MOTOR_MODEL_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  double pole_pairs;    // [-]
+  double r_phase;       // [Ohm] phase resistance, star equivalent
+  double l_phase;       // [H] phase inductance
+  double psi;           // [Wb] rotor flux linkage, peak per phase
+  double inertia;       // [kg m^2] wheel and whatever it carries
+  double friction;      // [Nm] coulomb friction
+  double damping;       // [Nm s/rad] viscous friction
+  double load;          // [Nm] external load torque, always against the motion like rolling resistance
+  double v_bat;         // [V] DC link voltage
+  double hall_offset;   // [deg el] hall edge position relative to the rotor flux
+  int    substeps;      // Euler steps per control period
+} MotorParams;
+
+typedef struct {
+  MotorParams p;
+  double i_alpha, i_beta;   // [A]
+  double omega;             // [rad/s] mechanical
+  double theta;             // [rad] electrical, [0, 2 pi)
+  double torque;            // [Nm] electromagnetic, last substep
+  double i_dc;              // [A] DC link, averaged over the last period
+} Motor;
+
+typedef struct {
+  uint8_t hall_a, hall_b, hall_c;
+  int16_t i_pha_a, i_pha_b, i_pha_c;  // [bit] A2BIT_CONV per amp, bldc.c sign
+  int16_t i_dc;                       // [bit] A2BIT_CONV per amp, bldc.c sign
+} MotorSensors;
+
+void motor_params_default(MotorParams *p);
+// 0 on success, -1 for an unknown name
+int  motor_param_set(MotorParams *p, const char *name, double value);
+void motor_init(Motor *m, const MotorParams *p);
+// dc_a..dc_c: DC_phaA..DC_phaC, -pwm_res/2..pwm_res/2; enabled = 0 opens all switches
+void motor_step(Motor *m, int16_t dc_a, int16_t dc_b, int16_t dc_c, int enabled, double dt);
+void motor_sensors(const Motor *m, MotorSensors *s);
+double motor_rpm(const Motor *m);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
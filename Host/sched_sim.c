@@ -0,0 +1,197 @@
+/*
+ * sched_sim : command latency of Src/scheduler.c on a simulated main loop.
+ *
+ *   sched_sim [-r rate_hz] [-j jitter_us] [-t telemetry_us] [-s seconds]
+ *
+ * The tasks of main.c run with assumed costs on a 64 MHz cycle clock that
+ * also drives DWT->CYCCNT and buzzerTimer. Commands arrive at -r Hz
+ * (default 50), spread uniformly by +- -j us (default 1000), each one in the
+ * USART interrupt during whatever task runs, and call sched_trigger(). The
+ * command task takes the commands that are in after its first 10 us, the
+ * mixer stamps them at its end. -t sets the cost of a telemetry run
+ * (default 500 us), -s the simulated time (default 600 s).
+ *
+ * The summary has the latency percentiles from arrival to the end of the
+ * mixer run and the scheduler's own figures: mixer runs, events,
+ * latencyMax and schedLatHist[]. sched_sim follows COMMAND_EVENT as
+ * config.h sets it, sched_sim_event is built with it.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "stm32f1xx_hal.h"
+
+// scheduler.c reads the cycle counter of the simulation
+static DWT_Type       simDwt;
+static CoreDebug_Type simCoreDebug;
+#undef  DWT
+#undef  CoreDebug
+#define DWT       (&simDwt)
+#define CoreDebug (&simCoreDebug)
+
+volatile uint32_t buzzerTimer = 0;
+
+#include "../Src/scheduler.c"
+
+#define CYCLES_US   64
+#define CYCLES_TICK (CYCLES_US * 1000000 / PWM_FREQ)
+#define MAX_PENDING 64
+
+// assumed task costs [us]
+#define COST_COMMAND_READ   10    // until readCommand() has taken the command over
+#define COST_COMMAND        30    // the rest of the command task
+#define COST_MIXER          30
+#define COST_SIDEBOARD      5
+#define COST_MEASURE        60
+#define COST_SAFETY         20
+#define COST_OTHER          20    // feedback, debug, lcd
+
+static uint64_t cycles = 0;
+static uint64_t nextCommand;
+static double   periodUs, jitterUs;
+static uint32_t telemetryUs = 500;
+
+static uint64_t arrived[MAX_PENDING];   // in the USART buffer, not read yet
+static int      nArrived = 0;
+static uint64_t taken[MAX_PENDING];     // read by the command task, not mixed yet
+static int      nTaken = 0;
+static double  *latency;
+static long     nLatency = 0, maxLatency;
+
+static void command_next(void)
+{
+  double j = 2 * jitterUs * rand() / RAND_MAX;
+  nextCommand += (uint64_t)((periodUs - jitterUs + j) * CYCLES_US);
+}
+
+// runs the clock, with the USART interrupts that fall in
+static void spend(uint64_t n)
+{
+  uint64_t end = cycles + n;
+  while (nextCommand <= end) {
+    cycles         = nextCommand;
+    DWT->CYCCNT    = (uint32_t)cycles;
+    buzzerTimer    = (uint32_t)(cycles / CYCLES_TICK);
+    if (nArrived < MAX_PENDING) {
+      arrived[nArrived++] = cycles;
+    }
+    sched_trigger(TASK_COMMAND);
+    command_next();
+  }
+  cycles      = end;
+  DWT->CYCCNT = (uint32_t)cycles;
+  buzzerTimer = (uint32_t)(cycles / CYCLES_TICK);
+}
+
+static void spend_us(uint32_t us)
+{
+  spend((uint64_t)us * CYCLES_US);
+}
+
+static void taskCommand(void)
+{
+  spend_us(COST_COMMAND_READ);
+  for (int i = 0; i < nArrived && nTaken < MAX_PENDING; i++) {
+    taken[nTaken++] = arrived[i];
+  }
+  nArrived = 0;
+  spend_us(COST_COMMAND);
+}
+
+static void taskMixer(void)
+{
+  spend_us(COST_MIXER);
+  for (int i = 0; i < nTaken && nLatency < maxLatency; i++) {
+    latency[nLatency++] = (double)(cycles - taken[i]) / CYCLES_US;
+  }
+  nTaken = 0;
+}
+
+static void taskSideboard(void) { spend_us(COST_SIDEBOARD); }
+static void taskMeasure(void)   { spend_us(COST_MEASURE); }
+static void taskSafety(void)    { spend_us(COST_SAFETY); }
+static void taskTelemetry(void) { spend_us(telemetryUs); }
+static void taskOther(void)     { spend_us(COST_OTHER); }
+
+// the table of main.c with feedback, debug and lcd off
+SchedTask schedTasks[TASK_COUNT] = {
+  // Name       ,Function       ,Period [ms]        ,Deadline [ms]      ,Next
+  {"command"    ,taskCommand    ,DELAY_IN_MAIN_LOOP ,DELAY_IN_MAIN_LOOP ,TASK_MIXER},
+  {"mixer"      ,taskMixer      ,DELAY_IN_MAIN_LOOP ,DELAY_IN_MAIN_LOOP ,0},
+  {"sideboard"  ,taskSideboard  ,DELAY_IN_MAIN_LOOP ,DELAY_IN_MAIN_LOOP ,0},
+  {"measure"    ,taskMeasure    ,DELAY_IN_MAIN_LOOP ,DELAY_IN_MAIN_LOOP ,0},
+  {"safety"     ,taskSafety     ,DELAY_IN_MAIN_LOOP ,DELAY_IN_MAIN_LOOP ,0},
+  {"feedback"   ,taskOther      ,0                  ,0                  ,0},
+  {"telemetry"  ,taskTelemetry  ,TASK_TELEMETRY_MS  ,TASK_TELEMETRY_MS  ,0},
+  {"debug"      ,taskOther      ,0                  ,0                  ,0},
+  {"lcd"        ,taskOther      ,0                  ,0                  ,0},
+};
+
+static int compare(const void *a, const void *b)
+{
+  double d = *(const double *)a - *(const double *)b;
+  return d < 0 ? -1 : d > 0;
+}
+
+int main(int argc, char **argv)
+{
+  double rate = 50, seconds = 600;
+  jitterUs = 1000;
+  int opt;
+  while ((opt = getopt(argc, argv, "r:j:t:s:")) != -1) {
+    switch (opt) {
+    case 'r': rate = atof(optarg); break;
+    case 'j': jitterUs = atof(optarg); break;
+    case 't': telemetryUs = (uint32_t)atoi(optarg); break;
+    case 's': seconds = atof(optarg); break;
+    default:
+      fprintf(stderr, "usage: %s [-r rate_hz] [-j jitter_us] [-t telemetry_us] [-s seconds]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (rate <= 0 || seconds <= 0 || jitterUs < 0 || jitterUs >= 1e6 / rate) {
+    fprintf(stderr, "sched_sim: rate and seconds must be positive, the jitter below one period\n");
+    return 1;
+  }
+  periodUs   = 1e6 / rate;
+  maxLatency = (long)(rate * seconds) + MAX_PENDING;
+  latency    = malloc(maxLatency * sizeof(double));
+  if (latency == NULL) {
+    fprintf(stderr, "sched_sim: out of memory\n");
+    return 1;
+  }
+
+  srand(1);
+  nextCommand = 1000 * CYCLES_US + 12345;
+  sched_init(schedTasks, TASK_COUNT);
+  const uint64_t end = (uint64_t)(seconds * 1e6) * CYCLES_US;
+  while (cycles < end) {
+    if (!sched_run()) {
+      spend_us(1);                  // idle main loop
+    }
+  }
+  if (nLatency == 0) {
+    fprintf(stderr, "sched_sim: no command was mixed\n");
+    return 1;
+  }
+
+  qsort(latency, nLatency, sizeof(double), compare);
+#if defined(COMMAND_EVENT)
+  const char *mode = "COMMAND_EVENT";
+#else
+  const char *mode = "periodic";
+#endif
+  printf("%s, %.0f Hz +- %.0f us, telemetry %u us: %ld commands\n", mode, rate, jitterUs, telemetryUs, nLatency);
+  printf("  latency p50 %.0f p99 %.0f p99.9 %.0f max %.0f us\n", latency[nLatency / 2],
+         latency[nLatency * 99 / 100], latency[nLatency * 999 / 1000], latency[nLatency - 1]);
+  printf("  mixer runs %u events %u latencyMax %u us, schedLatHist", schedTasks[TASK_MIXER].runs,
+         schedTasks[TASK_MIXER].events, schedTasks[TASK_MIXER].latencyMax);
+  for (int i = 0; i < SCHED_LAT_BINS; i++) {
+    printf(" %u", schedLatHist[i]);
+  }
+  printf("\n");
+  free(latency);
+  return 0;
+}
@@ -0,0 +1,80 @@
+#include <algorithm>
+#include <math.h>
+#include "time_sync.h"
+
+TimeSync::TimeSync() : _count(0), _next(0), _last_board_us(0), _ref_ns(0), _intercept(0), _slope(0), _error(0)
+{
+}
+
+void TimeSync::add(uint64_t t1_ns, uint64_t t2_us, uint64_t t3_us, uint64_t t4_ns)
+{
+    uint64_t t2_ns = t2_us * 1000, t3_ns = t3_us * 1000;
+    if (t3_ns < t2_ns || t4_ns < t1_ns)
+    {
+        return;
+    }
+    int64_t round_trip = (int64_t)(t4_ns - t1_ns) - (int64_t)(t3_ns - t2_ns);
+    Sample &s = _window[_next];
+    s.board_ns = t2_ns + (t3_ns - t2_ns) / 2;
+    s.diff_ns = (int64_t)(t1_ns + (t4_ns - t1_ns) / 2) - (int64_t)s.board_ns;
+    s.delay_ns = round_trip > 0 ? round_trip : 0;
+    _next = (_next + 1) % WINDOW;
+    _count = std::min(_count + 1, WINDOW);
+    _last_board_us = t3_us;
+    fit();
+}
+
+void TimeSync::fit()
+{
+    // queuing only ever adds delay, so the quickest exchanges carry the offset
+    Sample best[WINDOW];
+    std::copy(_window, _window + _count, best);
+    std::sort(best, best + _count, [](const Sample &a, const Sample &b)
+              { return a.delay_ns < b.delay_ns; });
+    uint32_t n = std::max(1u, _count / 2);
+
+    _ref_ns = best[0].board_ns;
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        double x = (double)(int64_t)(best[i].board_ns - _ref_ns);
+        double y = (double)(best[i].diff_ns - best[0].diff_ns);
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+    }
+    double denom = n * sxx - sx * sx;
+    // a drift needs a spread in time, a few seconds of exchanges
+    _slope = (n >= 4 && denom > 0 && sxx / n > 1e18) ? (n * sxy - sx * sy) / denom : 0;
+    double intercept = (sy - _slope * sx) / n;
+    _intercept = best[0].diff_ns + (int64_t)llround(intercept);
+
+    double residual = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        double x = (double)(int64_t)(best[i].board_ns - _ref_ns);
+        double model = _intercept + _slope * x;
+        residual = std::max(residual, fabs((double)best[i].diff_ns - model));
+    }
+    _error = best[0].delay_ns / 2 + (uint64_t)residual;
+}
+
+uint64_t TimeSync::to_host(uint64_t board_us, uint64_t *err_ns) const
+{
+    uint64_t board_ns = board_us * 1000;
+    double x = (double)(int64_t)(board_ns - _ref_ns);
+    if (err_ns)
+    {
+        // extrapolating far from the fitted exchanges adds the drift uncertainty, counted as 1 ppm
+        *err_ns = _error + (uint64_t)(fabs(x) * 1e-6);
+    }
+    return board_ns + _intercept + (int64_t)llround(_slope * x);
+}
+
+uint64_t TimeSync::unwrap(uint32_t board_us) const
+{
+    // the 32 bit value closest to the last exchange, +-35 minutes
+    int32_t delta = (int32_t)(board_us - (uint32_t)_last_board_us);
+    return _last_board_us + delta;
+}
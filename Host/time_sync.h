@@ -0,0 +1,63 @@
+/*
+ * TimeSync : map the board clock (us since boot) to a host clock (ns).
+ *
+ * Fed with PingRequest/PingReply exchanges, NTP style:
+ *   t1 host sends, t2 board receives, t3 board sends, t4 host receives.
+ * The caller removes the known wire time of both frames (t1 moved to the
+ * last byte of the request, t4 back to the first byte of the reply). Then
+ *   offset = ((t2 - t1) + (t3 - t4)) / 2   board - host
+ *   delay  = (t4 - t1) - (t3 - t2)         what is left of the round trip
+ * and the true offset lies within offset +- delay / 2.
+ *
+ * Offset and drift come from a least-squares line through the lower-delay
+ * half of the last WINDOW exchanges. A converted time is returned with an
+ * error bound: half the smallest delay used plus the largest fit residual.
+ */
+#ifndef TIME_SYNC_H
+#define TIME_SYNC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+class TimeSync
+{
+public:
+    static const uint32_t WINDOW = 64;
+
+    TimeSync();
+
+    void add(uint64_t t1_ns, uint64_t t2_us, uint64_t t3_us, uint64_t t4_ns);
+    bool valid() const { return _count > 0; }
+    uint32_t samples() const { return _count; }
+
+    // host time of a board time; err_ns receives the error bound
+    uint64_t to_host(uint64_t board_us, uint64_t *err_ns = NULL) const;
+    // 64 bit board time from its low 32 bits (HoverboardEvent.time_us), taken near the last exchange
+    uint64_t unwrap(uint32_t board_us) const;
+
+    double drift_ppm() const { return -_slope * 1e6; } // board clock rate error, > 0 runs fast
+    int64_t offset_ns() const { return -_intercept; } // board - host at the quickest exchange
+    uint64_t error_ns() const { return _error; }
+
+private:
+    struct Sample
+    {
+        uint64_t board_ns; // board side midpoint
+        int64_t diff_ns;   // host - board at that point
+        uint64_t delay_ns;
+    };
+    Sample _window[WINDOW];
+    uint32_t _count;
+    uint32_t _next;
+    uint64_t _last_board_us;
+
+    // host - board = _intercept + _slope * (board_ns - _ref_ns)
+    uint64_t _ref_ns;
+    int64_t _intercept;
+    double _slope;
+    uint64_t _error;
+
+    void fit();
+};
+
+#endif
@@ -0,0 +1,120 @@
+/*
+ * time_sync_check : HoverboardEvent.time_us across the 32 bit wrap.
+ *
+ *   time_sync_check [-v]
+ *
+ * The board clock is 64 bit, the event carries its low 32 bits, which wrap
+ * every 71.6 minutes (and pass 2^31, the sign bit of an int32, after 35.8).
+ * A simulated board runs from 20 s before to 20 s after each boundary with
+ * a drifting clock; it answers a ping every 250 ms and sends an event every
+ * 10 ms, some of them sampled before the last ping. Each event goes through
+ * the wire (encode, decode) and the limero_rec path (unwrap, to_host), and
+ * the result is compared with the true board and host times. -v prints
+ * every 100th event.
+ *
+ * Exits with 1 if a decoded time_us differs from what was sent, an unwrapped
+ * time is not the true 64 bit board time or a host time is off by more
+ * than its error bound.
+ */
+
+#include <algorithm>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <limero/msgs.h>
+#include <limero/msgs_hoverboard.h>
+#include "time_sync.h"
+
+#define DRIFT_PPM 40       // board clock runs fast
+#define OFFSET_NS 123456789 // host - board at boot
+#define PING_US 250000
+#define EVENT_US 10000
+#define SPAN_US 20000000ULL
+
+Log logger(256);
+
+void panic_here(const char *s)
+{
+    fprintf(stderr, " ===> PANIC : %s\n", s);
+    abort();
+}
+
+static uint64_t host_ns(uint64_t board_us)
+{
+    return board_us * 1000 - board_us * DRIFT_PPM / 1000 + OFFSET_NS;
+}
+
+static int run(const char *name, uint64_t boundary, bool verbose)
+{
+    static Buffer payload(256);
+    TimeSync clock;
+    uint32_t events = 0, errors = 0;
+    uint64_t err_max = 0;
+    uint64_t start = boundary - SPAN_US, end = boundary + SPAN_US;
+    srand(1);
+    for (uint64_t t = start; t < end; t += EVENT_US)
+    {
+        if ((t - start) % PING_US == 0)
+        {
+            // t1 .. t4 with a few 100 us of queuing on either side
+            uint64_t t2 = t + rand() % 300, t3 = t2 + 50;
+            uint64_t t1 = host_ns(t2) - 200000 - rand() % 300000;
+            uint64_t t4 = host_ns(t3) + 200000 + rand() % 300000;
+            clock.add(t1, t2, t3, t4);
+        }
+        // events queue in the batch for up to a few ms, so some predate the ping
+        uint64_t sampled = t >= start + 5000 ? t - rand() % 5000 : t;
+
+        HoverboardEvent sent, received;
+        sent.time_us = (uint32_t)sampled;
+        payload.clear();
+        if (sent.encode(payload) != 0 || received.decode(payload) != 0 || !received.time_us)
+        {
+            printf("%s: event %u does not encode\n", name, events);
+            return 1;
+        }
+        if (*received.time_us != *sent.time_us)
+        {
+            errors++;
+        }
+        uint64_t board = clock.unwrap(*received.time_us);
+        uint64_t err;
+        uint64_t host = clock.to_host(board, &err);
+        int64_t off = (int64_t)(host - host_ns(sampled));
+        err_max = std::max(err_max, (uint64_t)llabs(off));
+        if (board != sampled || (uint64_t)llabs(off) > err)
+        {
+            errors++;
+        }
+        if (verbose && events % 100 == 0)
+        {
+            printf("  %-10s time_us %10" PRIu32 " board %12" PRIu64 " host %+7" PRId64 " ns (+-%" PRIu64 ")\n",
+                   name, *received.time_us, board, off, err);
+        }
+        events++;
+    }
+    printf("%-10s %6u events  max host error %6" PRIu64 " ns  %s\n", name, events, err_max, errors ? "FAIL" : "ok");
+    return errors ? 1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    bool verbose = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "v")) != -1)
+    {
+        switch (opt)
+        {
+        case 'v': verbose = true; break;
+        default:
+            fprintf(stderr, "Usage: %s [-v]\n", argv[0]);
+            return 1;
+        }
+    }
+    int rc = 0;
+    rc |= run("int32 sign", 1ULL << 31, verbose);
+    rc |= run("32 bit", 1ULL << 32, verbose);
+    rc |= run("2nd wrap", 2ULL << 32, verbose);
+    return rc;
+}
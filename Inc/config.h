@@ -32,6 +32,10 @@
 #else
 #define DELAY_IN_MAIN_LOOP    5     // in ms. default 5. it is independent of all the timing critical stuff. do not touch if you do not know what you are doing.
 #endif
+#define TASK_FEEDBACK_MS     (20 * DELAY_IN_MAIN_LOOP)    // [ms] serial feedback period. The control tasks run every DELAY_IN_MAIN_LOOP ms, see scheduler.h
+#define TASK_TELEMETRY_MS    (40 * DELAY_IN_MAIN_LOOP)    // [ms] Limero telemetry frame period
+#define TASK_DEBUG_MS        (25 * DELAY_IN_MAIN_LOOP)    // [ms] debug output period
+#define TASK_LCD_MS          (100 * DELAY_IN_MAIN_LOOP)   // [ms] transpotter LCD period
 #define TIMEOUT                20     // number of wrong / missing input commands before emergency off
 #define A2BIT_CONV             50     // A to bit for current conversion on ADC. Example: 1 A = 50, 2 A = 100, etc
 // #define PRINTF_FLOAT_SUPPORT          // [-] Uncomment this for printf to support float on Serial Debug. It will increase code size! Better to avoid it!
@@ -163,6 +167,41 @@
 #define FIELD_WEAK_HI   1000            // (1000, 1500] Input target High threshold for reaching maximum Field Weakening / Phase Advance. Do NOT set this higher than 1500.
 #define FIELD_WEAK_LO   750             // ( 500, 1000] Input target Low threshold for starting Field Weakening / Phase Advance. Do NOT set this higher than 1000.
 
+// Control ISR overrun: the next ADC conversion completed before DMA1_Channel1_IRQHandler() was done with the previous one
+#define OVERRUN_POLICY      0           // [-] Reaction after OVERRUN_DEGRADE_RUN overruns in a row: 0 = count only (default), 1 = disable field weakening and beep, 2 = also FOC_CTRL -> SIN_CTRL, 3 = also disable the motors
+#define OVERRUN_DEGRADE_RUN 16          // [-] Consecutive overrunning periods (16 = 1 ms) that trigger OVERRUN_POLICY
+
+// Current offsets: after the boot calibration they keep following the ADC while both bridges are off at standstill
+// #define OFFSET_TRACK                 // [-] Enable offset tracking. Commented out: the boot calibration is kept until power off.
+#define OFFSET_TRACK_SETTLE 160         // [-] Periods (160 = 10 ms) the bridges must be off and the motors below OFFSET_TRACK_RPM before tracking starts, lets the phase currents decay
+#define OFFSET_TRACK_RPM    20          // [rpm] Max speed of both motors while tracking
+#define OFFSET_TRACK_SHIFT  12          // [-] Low-pass time constant 2^12 periods = 256 ms
+#define OFFSET_TRACK_SLEW   410         // [-] Max offset change per period in 1/65536 ADC counts (410 = 100 counts/s)
+#define OFFSET_TRACK_RANGE  200         // [-] Max distance of a tracked offset from the boot calibration, ADC counts
+
+// Fast boot: the current offsets of the last run are stored in the EEPROM emulation and checked instead of calibrated
+// #define FAST_BOOT                    // [-] Enable fast boot. Also plays the power-on melody and the enable beeps without blocking the main loop
+#define FAST_BOOT_CHECK_SAMPLES 100     // [-] Periods (100 = 6.25 ms) averaged to check the stored offsets, the full calibration takes 2000
+#define FAST_BOOT_CHECK_TOL     30      // [-] Max distance of the average from a stored offset, ADC counts. Above it the full calibration runs
+
+// Hall edges: stamped by EXTI interrupts with the DWT cycle counter instead of read once per 16 kHz period, see hall_speed.h
+// #define HALL_CAPTURE                 // [-] Enable hall edge capture. Uses EXTI5..7 and EXTI10..12, so not together with CONTROL_PPM_RIGHT or CONTROL_PWM_RIGHT
+#define HALL_CAPTURE_ANGLE      1       // [-] 1 = the controllers run on the interpolated angle (a_mechAngle, b_angleMeasEna), 0 = the speed is only used by calcAvgSpeed() and telemetry
+#define HALL_CAPTURE_TIMEOUT    1000    // [ms] Time without a hall edge until the speed reads 0. 1000 ms = below 0.67 rpm with 15 pole pairs
+
+// Energy counters: drawn and regenerated Ah and Wh per motor, integrated every 16 kHz period, lifetime totals stored in the EEPROM emulation at power off
+// #define ENERGY_COUNT                 // [-] Enable the energy counters, sent as EnergyEvent by FEEDBACK_LIMERO with LIMERO_BATCH
+#define ENERGY_DEADBAND         2       // [-] DC link currents up to this many ADC counts (A2BIT_CONV per A) are not counted, keeps the offset noise at standstill out
+
+// Battery and temperature: every 16 kHz sample is summed and decimated, to 1 kHz for the battery and 100 Hz for the temperature filter, see oversample.h
+// #define ADC_OVERSAMPLE               // [-] Enable oversampling. Off: one battery sample every 1000 periods and one temperature sample per main loop. Only tried on synthetic ripple, not on a board yet
+
+// Command events: a new Limero or serial command runs the command and mixer tasks at once instead of at their next DELAY_IN_MAIN_LOOP release, see scheduler.h
+// #define COMMAND_EVENT                // [-] Enable command events. Commands faster than DELAY_IN_MAIN_LOOP then step the rate limiter and filters once each, so they ramp faster
+
+// Controller code
+// #define BLDC_FAST_HELPERS            // [-] Replace the generated fixed-point helpers (PI controllers, filters, prelookups) with the bit-exact ones of BLDC_controller_fast.c. Off until compared on the board with ISR_PROFILE
+
 // Extra functionality
 // #define STANDSTILL_HOLD_ENABLE          // [-] Flag to hold the position when standtill is reached. Only available and makes sense for VOLTAGE or TORQUE mode.
 // #define ELECTRIC_BRAKE_ENABLE           // [-] Flag to enable electric brake and replace the motor "freewheel" with a constant braking when the input torque request is 0. Only available and makes sense for TORQUE mode.
@@ -252,6 +291,7 @@
 // #define DEBUG_SERIAL_USART2          // left sensor board cable, disable if ADC or PPM is used!
 // #define DEBUG_SERIAL_USART3          // right sensor board cable, disable if I2C (nunchuk or lcd) is used!
 // #define DEBUG_SERIAL_PROTOCOL        // uncomment this to send user commands to the board, change parameters and print specific signals (see comms.c for the user commands)
+// #define ISR_PROFILE                  // count DWT cycles of the 16 kHz interrupt per stage, shown as ISR_* variables by DEBUG_SERIAL_PROTOCOL and sent as IsrProfileEvent by FEEDBACK_LIMERO
 // ########################### END OF DEBUG SERIAL ############################
 
 
@@ -315,6 +355,11 @@
 // #define CONTROL_SERIAL_USART2  0    // left sensor board cable, disable if ADC or PPM is used! For Arduino control check the hoverSerial.ino
 // #define FEEDBACK_SERIAL_USART2      // left sensor board cable, disable if ADC or PPM is used!
 #define CONTROL_LIMERO 1  // provide CBOR serial data via USART2
+#define LIMERO_BATCH      // send the messages due in one telemetry cycle as a single BatchEnvelope frame
+#define LIMERO_ACK        // answer HoverboardRequests with req_id != 0 by a GenericReply carrying the main loop tick they were applied at
+// #define LIMERO_SCOPE   // triggered 16 kHz capture of currents, iq/id, angle, speed and controller inputs, armed by a ScopeRequest and sent in ScopeEvent chunks. Adds scope_sample() to the DMA interrupt and a 4 KB ring, its ISR cost is not measured on a board yet
+// #define LIMERO_TRACE   // sample TRACE_CHANNELS every main loop and send them column packed in a TraceEvent with each telemetry frame. Opt-in like the other Limero diagnostics
+// #define LIMERO_STATS   // min/max/mean/RMS of the currents, iq/id and battery ADC over every 16 kHz period since the last HoverboardEvent, sent in it as isr_stats. Adds isr_stats_sample() to the DMA interrupt, its ISR cost is not measured on a board yet
 
 // #define SIDEBOARD_SERIAL_USART3 0
 // #define CONTROL_SERIAL_USART3  0    // right sensor board cable. Number indicates priority for dual-input. Disable if I2C (nunchuk or lcd) is used! For Arduino control check the hoverSerial.ino
@@ -793,6 +838,55 @@
 #if (defined(CONTROL_PPM_LEFT) || defined(CONTROL_PPM_RIGHT)) && !defined(PPM_NUM_CHANNELS)
 #error Total number of PPM channels needs to be set
 #endif
+
+#if defined(LIMERO_ACK) && !(defined(CONTROL_LIMERO) && defined(FEEDBACK_LIMERO) && defined(LIMERO_BATCH))
+#error LIMERO_ACK needs CONTROL_LIMERO, FEEDBACK_LIMERO and LIMERO_BATCH. Replies share the telemetry frame.
+#endif
+
+#if defined(LIMERO_SCOPE) && !(defined(CONTROL_LIMERO) && defined(FEEDBACK_LIMERO) && defined(LIMERO_BATCH))
+#error LIMERO_SCOPE needs CONTROL_LIMERO, FEEDBACK_LIMERO and LIMERO_BATCH. Capture chunks share the telemetry frame.
+#endif
+
+#if defined(LIMERO_TRACE) && !(defined(FEEDBACK_LIMERO) && defined(LIMERO_BATCH))
+#error LIMERO_TRACE needs FEEDBACK_LIMERO and LIMERO_BATCH. Traces share the telemetry frame.
+#endif
+
+#if defined(LIMERO_STATS) && !(defined(FEEDBACK_LIMERO) && defined(LIMERO_BATCH))
+#error LIMERO_STATS needs FEEDBACK_LIMERO and LIMERO_BATCH. The statistics only fit the batched HoverboardEvent.
+#endif
+
+#if OVERRUN_POLICY < 0 || OVERRUN_POLICY > 3
+  #error OVERRUN_POLICY must be 0, 1, 2 or 3.
+#endif
+
+#if defined(OFFSET_TRACK) && (OFFSET_TRACK_SHIFT < 1 || OFFSET_TRACK_SHIFT > 15)
+  #error OFFSET_TRACK_SHIFT must be between 1 and 15.
+#endif
+
+#if defined(FAST_BOOT) && (defined(VARIANT_HOVERBOARD) || defined(VARIANT_TRANSPOTTER))
+  #error FAST_BOOT needs the EEPROM emulation, which VARIANT_HOVERBOARD and VARIANT_TRANSPOTTER do not provide.
+#endif
+
+#if defined(FAST_BOOT) && (FAST_BOOT_CHECK_SAMPLES < 1 || FAST_BOOT_CHECK_SAMPLES >= 2000)
+  #error FAST_BOOT_CHECK_SAMPLES must be between 1 and 1999.
+#endif
+
+#if defined(HALL_CAPTURE) && (defined(CONTROL_PPM_RIGHT) || defined(CONTROL_PWM_RIGHT))
+  #error HALL_CAPTURE uses EXTI10..12 for the right hall sensors, CONTROL_PPM_RIGHT and CONTROL_PWM_RIGHT cannot be used with it.
+#endif
+
+#if defined(HALL_CAPTURE) && (HALL_CAPTURE_TIMEOUT < 1 || HALL_CAPTURE_TIMEOUT > 60000)
+  #error HALL_CAPTURE_TIMEOUT must be between 1 and 60000 ms.
+#endif
+
+#if defined(ENERGY_COUNT) && (defined(VARIANT_HOVERBOARD) || defined(VARIANT_TRANSPOTTER))
+  #error ENERGY_COUNT needs the EEPROM emulation, which VARIANT_HOVERBOARD and VARIANT_TRANSPOTTER do not provide.
+#endif
+
+#if defined(ENERGY_COUNT) && (ENERGY_DEADBAND < 0 || ENERGY_DEADBAND > 100)
+  #error ENERGY_DEADBAND must be between 0 and 100 ADC counts.
+#endif
+
 // ############################# END OF VALIDATE SETTINGS ############################
 
 #endif
@@ -211,6 +211,13 @@
 #define ARRAY_LEN(x) (uint32_t)(sizeof(x) / sizeof(*(x)))
 #define MAP(x, in_min, in_max, out_min, out_max) (((((x) - (in_min)) * ((out_max) - (out_min))) / ((in_max) - (in_min))) + (out_min))
 
+// Copied to SRAM by the startup code and run from there, see .ramfunc in STM32F103RCTx_FLASH.ld
+#if defined(__GNUC__)
+  #define RAMFUNC __attribute__((section(".ramfunc"), noinline))
+#else
+  #define RAMFUNC
+#endif
+
 #if defined(PRINTF_FLOAT_SUPPORT) && (defined(DEBUG_SERIAL_USART2) || defined(DEBUG_SERIAL_USART3)) && defined(__GNUC__)
     asm(".global _printf_float");     // this is the magic trick for printf to support float. Warning: It will increase code considerably! Better to avoid!
 #endif
@@ -245,6 +252,11 @@ void PWM_Init(void);
 void PWM_ISR_CH1_Callback(void);
 void PWM_ISR_CH2_Callback(void);
 
+// Hall edge capture (HALL_CAPTURE), bldc.c
+void hall_capture_init(void);
+void hall_capture_left(void);
+void hall_capture_right(void);
+
 // Sideboard definitions
 #define LED1_SET            (0x01)
 #define LED2_SET            (0x02)
@@ -42,6 +42,7 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "stm32f1xx_hal.h"
+#include "config.h"
 
 /* Exported constants --------------------------------------------------------*/
 /* Base address of the Flash sectors */
@@ -208,8 +209,21 @@
 /* Page full define */
 #define PAGE_FULL             ((uint8_t)0x80)
 
-/* Variables' number */
-#define NB_OF_VAR             ((uint8_t)0x13)       /* 19 Variables */
+/* Variables' number: the 19 settings, then the ones of FAST_BOOT and ENERGY_COUNT
+   if enabled, so other builds keep the original layout */
+#ifdef FAST_BOOT
+#define EE_FAST_BOOT_NB       6                     /* current offsets */
+#else
+#define EE_FAST_BOOT_NB       0
+#endif
+#ifdef ENERGY_COUNT
+#define EE_ENERGY_NB          8                     /* energy totals, low and high half */
+#else
+#define EE_ENERGY_NB          0
+#endif
+#define EE_FAST_BOOT_IDX      19                    /* VirtAddVarTab index of the first FAST_BOOT variable */
+#define EE_ENERGY_IDX         (EE_FAST_BOOT_IDX + EE_FAST_BOOT_NB)
+#define NB_OF_VAR             ((uint8_t)(EE_ENERGY_IDX + EE_ENERGY_NB))
 
 /* Exported types ------------------------------------------------------------*/
 /* Exported macro ------------------------------------------------------------*/
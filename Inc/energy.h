@@ -0,0 +1,42 @@
+/*
+ * Charge and energy counters, built with ENERGY_COUNT.
+ *
+ * energy_sample() runs at the end of DMA1_Channel1_IRQHandler() and adds the
+ * DC link current of each motor, and its product with the battery ADC, to
+ * 64-bit sums. Drawn and regenerated current go to separate sums, so regen
+ * braking shows up instead of only lowering the net. Every 16 kHz period is
+ * counted, unlike the 200 ms telemetry samples.
+ *
+ * The sums stay in ADC units. energy_read() converts them to mAh and mWh in
+ * the main loop. util.c keeps the lifetime totals in the EEPROM emulation
+ * (energyLoad() at boot, energySave() at power-off).
+ */
+
+// Define to prevent recursive inclusion
+#ifndef ENERGY_H
+#define ENERGY_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  uint32_t usedMah;         // drawn from the battery
+  uint32_t regenMah;        // fed back into the battery
+  uint32_t usedMwh;
+  uint32_t regenMwh;
+} EnergyTotals;
+
+extern EnergyTotals energyStored;   // lifetime totals up to this boot, from energyLoad()
+
+void energy_sample(void);
+void energy_read(EnergyTotals motor[2]);
+void energy_total(EnergyTotals *total);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
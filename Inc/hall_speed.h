@@ -0,0 +1,58 @@
+/*
+ * Motor speed and rotor angle from timestamped hall edges, built with HALL_CAPTURE.
+ *
+ * The EXTI interrupts of the six hall inputs stamp every edge with the DWT
+ * cycle counter and hand it to hall_speed_edge(). The DMA interrupt calls
+ * hall_speed_update() once per period:
+ *  - the speed is one sector (60 deg el) per the mean sector time of the last
+ *    HALL_SPEED_EDGES sectors. Six cover one electrical revolution, so the
+ *    mounting errors of the three sensors cancel.
+ *  - once the next edge is overdue, the speed is capped at one sector per
+ *    time since the last edge. A stopping wheel therefore reads a falling
+ *    speed instead of its last one, and 0 after the timeout.
+ *  - the electrical angle is interpolated within the sector like the
+ *    controller does (F01_05_Electrical_Angle_Estimation), from the sector
+ *    time instead of the 16 kHz counter.
+ *
+ * Nothing here touches the hardware, Host/hall_check runs it on synthetic
+ * hall traces.
+ */
+
+// Define to prevent recursive inclusion
+#ifndef HALL_SPEED_H
+#define HALL_SPEED_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HALL_SPEED_EDGES    6               // sectors averaged for the speed
+#define HALL_TICK_HZ        64000000        // DWT->CYCCNT at SystemCoreClock
+
+// Edge history, written by hall_speed_edge() only
+typedef struct {
+  uint32_t time[HALL_SPEED_EDGES + 1];  // ring of edge timestamps [ticks]
+  volatile uint32_t edges;              // edges seen, changes with every ring update
+  uint8_t  idx;                         // slot of the latest edge
+  uint8_t  pos;                         // vec_hallToPos of the current hall state
+  int8_t   dir;                         // direction of the latest edge like the controller: 1, -1, 0 = unknown
+  uint8_t  run;                         // timed sectors in dir since the last reversal, at most HALL_SPEED_EDGES
+} HallEdges;
+
+typedef struct {
+  int16_t  rpm;                         // [rpm] fixdt(1,16,4), signed like n_mot
+  int16_t  angle;                       // [deg] electrical fixdt(1,16,4), [0, 360)
+  int16_t  mechAngle;                   // [deg] fixdt(1,16,4) for rtU.a_mechAngle, see hall_speed_update()
+} HallSpeed;
+
+void hall_speed_init(HallEdges *e, uint8_t hall);
+void hall_speed_edge(HallEdges *e, uint8_t hall, uint32_t t);
+void hall_speed_update(const HallEdges *e, uint32_t now, uint32_t timeout, uint8_t polePairs, HallSpeed *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
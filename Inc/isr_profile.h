@@ -0,0 +1,78 @@
+/*
+ * Cycle profile of DMA1_Channel1_IRQHandler(), built with ISR_PROFILE.
+ *
+ * The DWT cycle counter is read at the handler entry, around both
+ * BLDC_controller_step() calls, after each motor's PWM compare registers are
+ * written and at the handler exit. Every control period then updates the
+ * statistics of each stage. At 64 MHz one period is PROF_BUDGET_CYCLES.
+ * PendSV_Handler(), which the interrupt pends for its deferred work, is
+ * profiled as a stage of its own.
+ *
+ * The statistics are plain uint32 so the debug protocol can show them as
+ * VARIABLEs and serial.cpp can send them in IsrProfileEvents. Each field is
+ * read atomically, a reader may see fields of two consecutive periods.
+ */
+
+// Define to prevent recursive inclusion
+#ifndef ISR_PROFILE_H
+#define ISR_PROFILE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PROF_BUDGET_CYCLES  (64000000 / PWM_FREQ)   // one control period, 4000 cycles at 16 kHz
+#define PROF_HIST_BINS      16
+#define PROF_HIST_SHIFT     8       // 256 cycles (4 us) per bin, the last bin also takes everything longer
+#define PROF_AVG_SHIFT      10      // avg is taken over 1024 periods (64 ms)
+
+typedef enum {
+  PROF_REST = 0,    // total minus both controller steps: current reads, chopping, PWM writes, scope
+  PROF_LEFT,        // BLDC_controller_step(rtM_Left)
+  PROF_RIGHT,       // BLDC_controller_step(rtM_Right)
+  PROF_TOTAL,       // handler entry to exit
+  PROF_PWM_L,       // handler entry to the left PWM compare registers written
+  PROF_PWM_R,       // handler entry to the right PWM compare registers written
+  PROF_DEFERRED,    // PendSV_Handler(): battery filter, buzzer, pwm_margin; includes DMA interrupts preempting it
+  PROF_STAGES
+} ProfStage;
+
+typedef struct {
+  uint32_t min;
+  uint32_t avg;           // mean of the last completed 1 << PROF_AVG_SHIFT periods
+  uint32_t max;
+  uint32_t last;
+  uint32_t count;
+  uint32_t sum;           // running sum of the current average window
+  uint32_t hist[PROF_HIST_BINS];
+} ProfStats;
+
+extern ProfStats isr_prof[PROF_STAGES];
+
+#if defined(ISR_PROFILE)
+  // isr_prof_stamp[] holds the start count of a stage until it is stopped, its length afterwards
+  extern uint32_t isr_prof_stamp[PROF_STAGES];
+  #define PROF_START(stage)   (isr_prof_stamp[stage] = DWT->CYCCNT)
+  #define PROF_STOP(stage)    (isr_prof_stamp[stage] = DWT->CYCCNT - isr_prof_stamp[stage])
+  #define PROF_MARK(stage)    (isr_prof_stamp[stage] = DWT->CYCCNT - isr_prof_stamp[PROF_TOTAL])  // since PROF_START(PROF_TOTAL)
+  #define PROF_END()          isr_profile_end()
+  #define PROF_RECORD(stage)  isr_profile_record(stage)                       // since PROF_START(stage), outside the DMA interrupt
+#else
+  #define PROF_START(stage)
+  #define PROF_STOP(stage)
+  #define PROF_MARK(stage)
+  #define PROF_END()
+  #define PROF_RECORD(stage)
+#endif
+
+void isr_profile_init(void);
+void isr_profile_end(void);
+void isr_profile_record(ProfStage stage);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
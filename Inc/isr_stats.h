@@ -0,0 +1,62 @@
+/*
+ * Statistics of control loop signals over one telemetry period.
+ *
+ * isr_stats_sample() runs at the end of DMA1_Channel1_IRQHandler() and adds
+ * every channel to a running sum, sum of squares, min and max. Telemetry
+ * samples the same signals once per frame and misses what happens between
+ * two frames. These statistics cover every period.
+ *
+ * isr_stats_take() in the main loop switches the ISR to the other of two
+ * accumulator banks and reduces the finished one to min/max/mean/RMS. It
+ * does not wait for the ISR: the ISR preempts the main loop, never the other
+ * way round, so the bank index changes between two periods.
+ */
+
+// Define to prevent recursive inclusion
+#ifndef ISR_STATS_H
+#define ISR_STATS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ISR_STATS_PERIODS_MAX 65535   // periods accumulated at most (4 s), the int32 sums cannot overflow
+
+// Accumulated signals, in the order of HoverboardEvent.isr_stats
+typedef enum {
+  ISR_STATS_CURL_PHAA = 0,  // left phase A current  [ADC counts]
+  ISR_STATS_CURL_PHAB,      // left phase B current
+  ISR_STATS_CURL_DC,        // left DC link current
+  ISR_STATS_CURR_PHAB,      // right phase B current
+  ISR_STATS_CURR_PHAC,      // right phase C current
+  ISR_STATS_CURR_DC,        // right DC link current
+  ISR_STATS_IQ_L,           // left iq
+  ISR_STATS_ID_L,           // left id
+  ISR_STATS_IQ_R,           // right iq
+  ISR_STATS_ID_R,           // right id
+  ISR_STATS_BATT,           // battery voltage [ADC counts], unfiltered
+  ISR_STATS_COUNT
+} IsrStatsChannel;
+
+typedef struct {
+  int16_t  min;
+  int16_t  max;
+  int16_t  mean;
+  uint16_t rms;
+} IsrStatsValue;
+
+typedef struct {
+  uint32_t      periods;    // periods the values cover, 0 = none
+  IsrStatsValue value[ISR_STATS_COUNT];
+} IsrStats;
+
+void isr_stats_sample(void);
+void isr_stats_take(IsrStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
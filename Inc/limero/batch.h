@@ -0,0 +1,32 @@
+#ifndef _BATCH_H_
+#define _BATCH_H_
+#include <stdint.h>
+#include <functional>
+#include <vector>
+#include <limero/msgs_hoverboard.h>
+
+// Collects the messages due in one cycle and packs them into a single
+// BatchEnvelope: one header, one CRC and one COBS delimiter for all of them.
+// A lone message is sent as a plain Envelope, so single-message cycles look
+// the same on the wire as without batching.
+class BatchWriter
+{
+private:
+    Buffer _scratch;
+    BatchEnvelope _batch;
+    Envelope _single;
+    std::vector<uint32_t> _msg_types;
+    std::vector<uint8_t> _payloads;
+
+public:
+    BatchWriter(size_t scratch_size);
+    void clear();
+    int add(const Msg &msg);
+    uint32_t count() const { return _msg_types.size(); }
+    int encode(uint32_t src, Buffer &buffer);
+};
+
+// Calls handler(msg_type, payload) for every message in a BatchEnvelope
+int batch_for_each(const BatchEnvelope &batch, std::function<void(uint32_t, const Buffer &)> handler);
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef _COLUMN_PACK_H_
+#define _COLUMN_PACK_H_
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Packs rows of samples column by column for a TraceEvent. Each value is
+// shifted right by its channel's shift; the column holds the first value
+// and then the difference to the previous one, zigzag encoded (0, -1, 1,
+// -2 ... -> 0, 1, 2, 3 ...) as a little endian base-128 varint. A slowly
+// changing signal costs one byte per sample.
+//
+// Rows are appended one at a time, the columns live in one fixed buffer.
+class ColumnPacker
+{
+private:
+    uint8_t _channels;
+    size_t _column_capacity;
+    std::vector<uint8_t> _data; // _channels columns of _column_capacity bytes
+    std::vector<uint16_t> _length;
+    std::vector<int32_t> _prev;
+    std::vector<uint8_t> _shifts;
+    uint32_t _rows;
+
+public:
+    static const size_t VARINT_MAX = 5;
+
+    ColumnPacker(uint8_t channels, size_t column_capacity, const uint8_t *shifts);
+    const std::vector<uint8_t> &shifts() const { return _shifts; }
+    // false when a column might not hold the row, nothing is added then
+    bool add(const int32_t *row);
+    uint32_t rows() const { return _rows; }
+    void clear();
+    // the columns back to back
+    void pack(std::vector<uint8_t> &columns) const;
+};
+
+// Reverses ColumnPacker::pack: rows x channels values, row by row, shifted
+// back. Returns the bytes consumed, 0 when data ends early.
+size_t column_unpack(const uint8_t *data, size_t size, uint8_t channels, uint32_t rows,
+                     const uint8_t *shifts, int32_t *values);
+
+#endif
@@ -3,6 +3,7 @@
 #include <result.h>
 #include <option.h>
 #include <cbor.h>
+#include <assert.h>
 #include <errno.h>
 #include <log.h>
 
@@ -1,6 +1,7 @@
 // Auto-generated from robot.hcl — do not edit by hand.
 // Header file — class declarations for generated messages.
 // Every field is `Option<T>`; missing fields are omitted from encoded CBOR.
+// Each message is wrapped in `#if LIMERO_MSG(Name)` so an endpoint profile can leave it out.
 // Messages are encoded as CBOR maps keyed by field id.
 // Uses TinyCBOR for CBOR encoding/decoding.
 #ifndef HCL_CPP_TERA
@@ -13,6 +14,18 @@
 #include <unordered_map>
 #include <string>
 
+// ── Endpoint profile ───────────────────────────────────────────────────────
+// A profile limits the build to the messages one endpoint uses. Without one
+// every message is compiled.
+
+#if defined(LIMERO_PROFILE_HOVERBOARD)
+#include <limero/profile_hoverboard.h>
+#endif
+
+#ifndef LIMERO_MSG
+#define LIMERO_MSG(name) 1
+#endif
+
 // ── TinyCBOR helper ────────────────────────────────────────────────────────
 
 #define cbor_check(X) { \
@@ -32,6 +45,7 @@ const char *id_to_string(uint32_t msg_id);
 
 
 
+#if LIMERO_MSG(BrokerSubscribeRequest)
 class BrokerSubscribeRequest : public Msg {
 public:
 
@@ -54,9 +68,12 @@ public:
     /// Deserialize a BrokerSubscribeRequest from a CBOR map value.
     int decode(const Buffer& buffer);
 };
+#endif
+
 
 
 
+#if LIMERO_MSG(CompassEvent)
 class CompassEvent : public Msg {
 public:
 
@@ -93,9 +110,12 @@ public:
     /// Deserialize a CompassEvent from a CBOR map value.
     int decode(const Buffer& buffer);
 };
+#endif
+
 
 
 
+#if LIMERO_MSG(DeviceAliveEvent)
 class DeviceAliveEvent : public Msg {
 public:
 
@@ -120,9 +140,12 @@ public:
     /// Deserialize a DeviceAliveEvent from a CBOR map value.
     int decode(const Buffer& buffer);
 };
+#endif
 
 
 
+
+#if LIMERO_MSG(EndpointAnnounce)
 class EndpointAnnounce : public Msg {
 public:
 
@@ -155,9 +178,12 @@ public:
     /// Deserialize a EndpointAnnounce from a CBOR map value.
     int decode(const Buffer& buffer);
 };
+#endif
+
 
 
 
+#if LIMERO_MSG(EndpointAnnounceReply)
 class EndpointAnnounceReply : public Msg {
 public:
 
@@ -178,9 +204,12 @@ public:
     /// Deserialize a EndpointAnnounceReply from a CBOR map value.
     int decode(const Buffer& buffer);
 };
+#endif
+
 
 
 
+#if LIMERO_MSG(Envelope)
 class Envelope : public Msg {
 public:
 
@@ -211,9 +240,12 @@ public:
     /// Deserialize a Envelope from a CBOR map value.
     int decode(const Buffer& buffer);
 };
+#endif
 
 
 
+
+#if LIMERO_MSG(GenericReply)
 class GenericReply : public Msg {
 public:
 
@@ -240,9 +272,12 @@ public:
     /// Deserialize a GenericReply from a CBOR map value.
     int decode(const Buffer& buffer);
 };
+#endif
+
 
 
 
+#if LIMERO_MSG(HeatingEvent)
 class HeatingEvent : public Msg {
 public:
 
@@ -275,9 +310,12 @@ public:
     /// Deserialize a HeatingEvent from a CBOR map value.
     int decode(const Buffer& buffer);
 };
+#endif
+
 
 
 
+#if LIMERO_MSG(HeatingRequest)
 class HeatingRequest : public Msg {
 public:
 
@@ -308,9 +346,12 @@ public:
     /// Deserialize a HeatingRequest from a CBOR map value.
     int decode(const Buffer& buffer);
 };
+#endif
 
 
 
+
+#if LIMERO_MSG(HoverboardEvent)
 class HoverboardEvent : public Msg {
 public:
 
@@ -421,9 +462,12 @@ public:
     /// Deserialize a HoverboardEvent from a CBOR map value.
     int decode(const Buffer& buffer);
 };
+#endif
+
 
 
 
+#if LIMERO_MSG(HoverboardRequest)
 class HoverboardRequest : public Msg {
 public:
 
@@ -448,9 +492,12 @@ public:
     /// Deserialize a HoverboardRequest from a CBOR map value.
     int decode(const Buffer& buffer);
 };
+#endif
+
 
 
 
+#if LIMERO_MSG(ImuEvent)
 class ImuEvent : public Msg {
 public:
 
@@ -481,9 +528,12 @@ public:
     /// Deserialize a ImuEvent from a CBOR map value.
     int decode(const Buffer& buffer);
 };
+#endif
 
 
 
+
+#if LIMERO_MSG(Max31855Event)
 class Max31855Event : public Msg {
 public:
 
@@ -514,9 +564,12 @@ public:
     /// Deserialize a Max31855Event from a CBOR map value.
     int decode(const Buffer& buffer);
 };
+#endif
+
 
 
 
+#if LIMERO_MSG(PingReply)
 class PingReply : public Msg {
 public:
 
@@ -539,9 +592,12 @@ public:
     /// Deserialize a PingReply from a CBOR map value.
     int decode(const Buffer& buffer);
 };
+#endif
+
 
 
 
+#if LIMERO_MSG(PingRequest)
 class PingRequest : public Msg {
 public:
 
@@ -564,9 +620,12 @@ public:
     /// Deserialize a PingRequest from a CBOR map value.
     int decode(const Buffer& buffer);
 };
+#endif
 
 
 
+
+#if LIMERO_MSG(Ps4Event)
 class Ps4Event : public Msg {
 public:
 
@@ -651,9 +710,12 @@ public:
     /// Deserialize a Ps4Event from a CBOR map value.
     int decode(const Buffer& buffer);
 };
+#endif
+
 
 
 
+#if LIMERO_MSG(Ps4Request)
 class Ps4Request : public Msg {
 public:
 
@@ -688,9 +750,12 @@ public:
     /// Deserialize a Ps4Request from a CBOR map value.
     int decode(const Buffer& buffer);
 };
+#endif
+
 
 
 
+#if LIMERO_MSG(SysEvent)
 class SysEvent : public Msg {
 public:
 
@@ -721,9 +786,12 @@ public:
     /// Deserialize a SysEvent from a CBOR map value.
     int decode(const Buffer& buffer);
 };
+#endif
 
 
 
+
+#if LIMERO_MSG(SysReply)
 class SysReply : public Msg {
 public:
 
@@ -748,9 +816,12 @@ public:
     /// Deserialize a SysReply from a CBOR map value.
     int decode(const Buffer& buffer);
 };
+#endif
+
 
 
 
+#if LIMERO_MSG(SysRequest)
 class SysRequest : public Msg {
 public:
 
@@ -777,9 +848,12 @@ public:
     /// Deserialize a SysRequest from a CBOR map value.
     int decode(const Buffer& buffer);
 };
+#endif
+
 
 
 
+#if LIMERO_MSG(UsEvent)
 class UsEvent : public Msg {
 public:
 
@@ -804,9 +878,12 @@ public:
     /// Deserialize a UsEvent from a CBOR map value.
     int decode(const Buffer& buffer);
 };
+#endif
 
 
 
+
+#if LIMERO_MSG(WifiEvent)
 class WifiEvent : public Msg {
 public:
 
@@ -841,6 +918,8 @@ public:
     /// Deserialize a WifiEvent from a CBOR map value.
     int decode(const Buffer& buffer);
 };
+#endif
+
 
 
 #endif
@@ -0,0 +1,466 @@
+// Hoverboard messages: the ones this firmware added to the Limero set and its
+// versions of GenericReply, HoverboardEvent and PingReply with the fields it
+// added. Written by hand in the form of the generated msgs.h, so a
+// regeneration of msgs.h / msgs.cpp from robot.hcl leaves them alone.
+// profile_hoverboard.h leaves the generated versions of the three out.
+#ifndef LIMERO_MSGS_HOVERBOARD_H
+#define LIMERO_MSGS_HOVERBOARD_H
+
+#include <vector>
+#include <limero/msgs.h>
+
+#if !defined(LIMERO_PROFILE_HOVERBOARD)
+#error msgs_hoverboard.h replaces generated messages, build with -D LIMERO_PROFILE_HOVERBOARD
+#endif
+
+class BatchEnvelope : public Msg {
+public:
+
+    static const uint32_t MSG_ID = FNV("BatchEnvelope");
+    static constexpr const char *MSG_NAME ="BatchEnvelope";
+
+    virtual uint32_t msg_id() const { return MSG_ID; };
+    virtual const char *msg_name() const { return MSG_NAME; };
+
+    typedef enum FieldId {
+        SRC = 0,
+        DST = 1,
+        MSG_TYPES = 6,
+        PAYLOADS = 7,
+    } FieldId;
+    Option<uint32_t> src;// Source endpoint name
+    Option<uint32_t> dst;// Destination endpoint name
+    Option<std::vector<uint32_t>> msg_types;// Message type name per batched message
+    Option<std::vector<uint8_t>> payloads;// Serialized messages back to back, one CBOR map per msg_types entry
+
+    /// Serialize this message into a CBOR map keyed by field id.
+    int encode(Buffer& buffer) const;
+
+    /// Deserialize a BatchEnvelope from a CBOR map value.
+    int decode(const Buffer& buffer);
+};
+
+class EnergyEvent : public Msg {
+public:
+
+    static const uint32_t MSG_ID = FNV("EnergyEvent");
+    static constexpr const char *MSG_NAME ="EnergyEvent";
+
+    virtual uint32_t msg_id() const { return MSG_ID; };
+    virtual const char *msg_name() const { return MSG_NAME; };
+
+    typedef enum FieldId {
+        LEFT_USED_MAH = 0,
+        LEFT_REGEN_MAH = 1,
+        LEFT_USED_MWH = 2,
+        LEFT_REGEN_MWH = 3,
+        RIGHT_USED_MAH = 4,
+        RIGHT_REGEN_MAH = 5,
+        RIGHT_USED_MWH = 6,
+        RIGHT_REGEN_MWH = 7,
+        TOTAL_USED_MAH = 8,
+        TOTAL_REGEN_MAH = 9,
+        TOTAL_USED_MWH = 10,
+        TOTAL_REGEN_MWH = 11,
+    } FieldId;
+    Option<uint32_t> left_used_mah;// left motor, drawn from the battery since boot
+    Option<uint32_t> left_regen_mah;// left motor, fed back into the battery since boot
+    Option<uint32_t> left_used_mwh;// left motor, drawn from the battery since boot
+    Option<uint32_t> left_regen_mwh;// left motor, fed back into the battery since boot
+    Option<uint32_t> right_used_mah;// right motor, as left_used_mah
+    Option<uint32_t> right_regen_mah;// right motor, as left_regen_mah
+    Option<uint32_t> right_used_mwh;// right motor, as left_used_mwh
+    Option<uint32_t> right_regen_mwh;// right motor, as left_regen_mwh
+    Option<uint32_t> total_used_mah;// both motors over the board lifetime, stored at power-off
+    Option<uint32_t> total_regen_mah;// both motors over the board lifetime
+    Option<uint32_t> total_used_mwh;// both motors over the board lifetime
+    Option<uint32_t> total_regen_mwh;// both motors over the board lifetime
+
+    /// Serialize this message into a CBOR map keyed by field id.
+    int encode(Buffer& buffer) const;
+
+    /// Deserialize a EnergyEvent from a CBOR map value.
+    int decode(const Buffer& buffer);
+};
+
+class GenericReply : public Msg {
+public:
+
+    static const uint32_t MSG_ID = FNV("GenericReply");
+    static constexpr const char *MSG_NAME ="GenericReply";
+
+    virtual uint32_t msg_id() const { return MSG_ID; };
+    virtual const char *msg_name() const { return MSG_NAME; };
+
+    typedef enum FieldId {
+        REQ_ID = 0,
+        ERROR_CODE = 1,
+        MESSAGE = 2,
+        MSG_TYPE = 3,
+        TICK = 4,
+    } FieldId;
+    Option<uint32_t> req_id;// For request/reply matching, 0 if not a request/reply
+    Option<uint32_t> error_code;// Error code, 0 if no error
+    Option<std::string> message;// Error message or additional information
+    Option<uint32_t> msg_type;// Message type identifier , the original request
+    Option<uint32_t> tick;// Main-loop tick at which the request took effect
+
+    /// Serialize this message into a CBOR map keyed by field id.
+    int encode(Buffer& buffer) const;
+
+    /// Deserialize a GenericReply from a CBOR map value.
+    int decode(const Buffer& buffer);
+};
+
+class HoverboardEvent : public Msg {
+public:
+
+    static const uint32_t MSG_ID = FNV("HoverboardEvent");
+    static constexpr const char *MSG_NAME ="HoverboardEvent";
+
+    virtual uint32_t msg_id() const { return MSG_ID; };
+    virtual const char *msg_name() const { return MSG_NAME; };
+
+    typedef enum FieldId {
+        CTRL_MOD = 0,
+        CTRL_TYP = 1,
+        CUR_MOT_MAX = 2,
+        RPM_MOT_MAX = 3,
+        FI_WEAK_ENA = 4,
+        FI_WEAK_HI = 5,
+        FI_WEAK_LO = 6,
+        FI_WEAK_MAX = 7,
+        PHASE_ADV_MAX_DEG = 8,
+        INPUT1_RAW = 9,
+        INPUT1_TYP = 10,
+        INPUT1_MIN = 11,
+        INPUT1_MID = 12,
+        INPUT1_MAX = 13,
+        INPUT1_CMD = 14,
+        INPUT2_RAW = 15,
+        INPUT2_TYP = 16,
+        INPUT2_MIN = 17,
+        INPUT2_MID = 18,
+        INPUT2_MAX = 19,
+        INPUT2_CMD = 20,
+        AUX_INPUT1_RAW = 21,
+        AUX_INPUT1_TYP = 22,
+        AUX_INPUT1_MIN = 23,
+        AUX_INPUT1_MID = 24,
+        AUX_INPUT1_MAX = 25,
+        AUX_INPUT1_CMD = 26,
+        AUX_INPUT2_RAW = 27,
+        AUX_INPUT2_TYP = 28,
+        AUX_INPUT2_MIN = 29,
+        AUX_INPUT2_MID = 30,
+        AUX_INPUT2_MAX = 31,
+        AUX_INPUT2_CMD = 32,
+        DC_CURR = 33,
+        RDC_CURR = 34,
+        LDC_CURR = 35,
+        CMDL = 36,
+        CMDR = 37,
+        SPD_AVG = 38,
+        SPDL = 39,
+        SPDR = 40,
+        FILTER_RATE = 41,
+        SPD_COEF = 42,
+        STR_COEF = 43,
+        BATV = 44,
+        TEMP = 45,
+        REQ_GAPS = 46,
+        REQ_SUPERSEDED = 47,
+        TIME_US = 48,
+        OVERRUNS = 49,
+        OVERRUN_RUN_MAX = 50,
+        OVERRUN_ERR = 51,
+        OFFSET_DRIFT = 52,
+        OFFSET_TRACK_MS = 53,
+        BOOT_MS = 54,
+        OFFSETS_STORED = 55,
+        HALL_RPM_L = 56,
+        HALL_RPM_R = 57,
+        ISR_STATS_PERIODS = 58,
+        ISR_STATS = 59,
+    } FieldId;
+    Option<int32_t> ctrl_mod;// 1:Voltage 2:Speed 3:Torque
+    Option<int32_t> ctrl_typ;// 0:Commutation 1:Sinusoidal 2:FOC
+    Option<int32_t> cur_mot_max;// Max phase current A
+    Option<int32_t> rpm_mot_max;// Max motor RPM
+    Option<int32_t> fi_weak_ena;// Enable field weak 0:OFF 1:ON
+    Option<int32_t> fi_weak_hi;// Field weak high RPM
+    Option<int32_t> fi_weak_lo;// Field weak low RPM
+    Option<int32_t> fi_weak_max;// Field weak max current A (FOC only)
+    Option<int32_t> phase_adv_max_deg;// Max Phase Adv angle Deg (SIN only)
+    Option<int32_t> input1_raw;// Input1 raw value
+    Option<int32_t> input1_typ;// Input1 type 0:Disabled, 1:Normal Pot, 2:Middle Resting Pot, 3:Auto-detect
+    Option<int32_t> input1_min;// Input1 minimum value
+    Option<int32_t> input1_mid;// Input1 middle value
+    Option<int32_t> input1_max;// Input1 maximum value
+    Option<int32_t> input1_cmd;// Input1 command value
+    Option<int32_t> input2_raw;// Input2 raw value
+    Option<int32_t> input2_typ;// Input2 type 0:Disabled, 1:Normal Pot, 2:Middle Resting Pot, 3:Auto-detect
+    Option<int32_t> input2_min;// Input2 minimum value
+    Option<int32_t> input2_mid;// Input2 middle value
+    Option<int32_t> input2_max;// Input2 maximum value
+    Option<int32_t> input2_cmd;// Input2 command value
+    Option<int32_t> aux_input1_raw;// Input1 raw value
+    Option<int32_t> aux_input1_typ;// Input1 type 0:Disabled, 1:Normal Pot, 2:Middle Resting Pot, 3:Auto-detect
+    Option<int32_t> aux_input1_min;// Input1 minimum value
+    Option<int32_t> aux_input1_mid;// Input1 middle value
+    Option<int32_t> aux_input1_max;// Input1 maximum value
+    Option<int32_t> aux_input1_cmd;// Input1 command value
+    Option<int32_t> aux_input2_raw;// Input2 raw value
+    Option<int32_t> aux_input2_typ;// Input2 type 0:Disabled, 1:Normal Pot, 2:Middle Resting Pot, 3:Auto-detect
+    Option<int32_t> aux_input2_min;// Input2 minimum value
+    Option<int32_t> aux_input2_mid;// Input2 middle value
+    Option<int32_t> aux_input2_max;// Input2 maximum value
+    Option<int32_t> aux_input2_cmd;// Input2 command value
+    Option<int32_t> dc_curr;// Total DC Link current A *100
+    Option<int32_t> rdc_curr;// Right DC Link current A *100
+    Option<int32_t> ldc_curr;// Left DC Link current A *100
+    Option<int32_t> cmdl;// Left Motor Command RPM
+    Option<int32_t> cmdr;// Right Motor Command RPM
+    Option<int32_t> spd_avg;// Motor Measured Avg RPM
+    Option<int32_t> spdl;// Left Motor Measured RPM
+    Option<int32_t> spdr;// Right Motor Measured RPM
+    Option<int32_t> filter_rate;// Rate *10
+    Option<int32_t> spd_coef;// Speed Coefficient *10
+    Option<int32_t> str_coef;// Steer Coefficient *10
+    Option<int32_t> batv;// Calibrated Battery Voltage *100
+    Option<int32_t> temp;// Calibrated Temperature C *10
+    Option<int32_t> req_gaps;// HoverboardRequest req_ids skipped in sequence (lost on the way in)
+    Option<int32_t> req_superseded;// HoverboardRequests overwritten before the main loop applied them
+    Option<uint32_t> time_us;// Board clock when the event was sampled, us since boot, low 32 bits
+    Option<int32_t> overruns;// Control ISR periods that overran into the next ADC conversion
+    Option<int32_t> overrun_run_max;// Longest run of consecutive control ISR overruns
+    Option<int32_t> overrun_err;// 1 once OVERRUN_POLICY degraded the control
+    Option<int32_t> offset_drift;// Largest distance of a current offset from its boot calibration, ADC counts
+    Option<int32_t> offset_track_ms;// Time the current offsets were re-zeroed with the bridges off, ms
+    Option<int32_t> boot_ms;// ms from reset to the first motor enable
+    Option<int32_t> offsets_stored;// 1 when the stored current offsets were used
+    Option<int32_t> hall_rpm_l;// [rpm] fixdt(1,16,4) left speed from the hall edge timestamps
+    Option<int32_t> hall_rpm_r;// [rpm] fixdt(1,16,4) right speed from the hall edge timestamps
+    Option<int32_t> isr_stats_periods;// 16 kHz periods isr_stats covers
+    Option<std::vector<uint8_t>> isr_stats;// min, max, mean, rms per channel in IsrStatsChannel order, int16 little endian (rms uint16)
+
+    /// Serialize this message into a CBOR map keyed by field id.
+    int encode(Buffer& buffer) const;
+
+    /// Deserialize a HoverboardEvent from a CBOR map value.
+    int decode(const Buffer& buffer);
+};
+
+class IsrProfileEvent : public Msg {
+public:
+
+    static const uint32_t MSG_ID = FNV("IsrProfileEvent");
+    static constexpr const char *MSG_NAME ="IsrProfileEvent";
+
+    virtual uint32_t msg_id() const { return MSG_ID; };
+    virtual const char *msg_name() const { return MSG_NAME; };
+
+    typedef enum FieldId {
+        STAGE = 0,
+        COUNT = 1,
+        MIN = 2,
+        AVG = 3,
+        MAX = 4,
+        LAST = 5,
+        HIST = 6,
+        BIN_CYCLES = 7,
+        BUDGET_CYCLES = 8,
+    } FieldId;
+    Option<uint32_t> stage;// ProfStage
+    Option<uint32_t> count;// profiled periods
+    Option<uint32_t> min;// cycles
+    Option<uint32_t> avg;// cycles, mean of the last 1024 periods
+    Option<uint32_t> max;// cycles
+    Option<uint32_t> last;// cycles of the latest period
+    Option<std::vector<uint8_t>> hist;// bin counts, little endian uint32
+    Option<uint32_t> bin_cycles;// histogram bin width
+    Option<uint32_t> budget_cycles;// cycles in one control period
+
+    /// Serialize this message into a CBOR map keyed by field id.
+    int encode(Buffer& buffer) const;
+
+    /// Deserialize a IsrProfileEvent from a CBOR map value.
+    int decode(const Buffer& buffer);
+};
+
+class LinkDiagEvent : public Msg {
+public:
+
+    static const uint32_t MSG_ID = FNV("LinkDiagEvent");
+    static constexpr const char *MSG_NAME ="LinkDiagEvent";
+
+    virtual uint32_t msg_id() const { return MSG_ID; };
+    virtual const char *msg_name() const { return MSG_NAME; };
+
+    typedef enum FieldId {
+        RX_BYTES = 0,
+        RX_FRAMES = 1,
+        RX_COBS_ERRORS = 2,
+        RX_CRC_ERRORS = 3,
+        RX_OVERFLOWS = 4,
+        RX_DECODE_ERRORS = 5,
+        RX_UNKNOWN_MSGS = 6,
+        TX_FRAMES = 7,
+        TX_DROPPED = 8,
+        TX_FRAME_MAX = 9,
+        TX_QUEUE_MAX = 10,
+        TX_QUEUE_DROPPED = 11,
+    } FieldId;
+    Option<uint32_t> rx_bytes;// bytes received on the Limero uart
+    Option<uint32_t> rx_frames;// frames received with a good COBS and CRC
+    Option<uint32_t> rx_cobs_errors;// frames dropped on a COBS error
+    Option<uint32_t> rx_crc_errors;// frames dropped on a CRC error
+    Option<uint32_t> rx_overflows;// frames longer than the receive buffer
+    Option<uint32_t> rx_decode_errors;// frames or payloads that failed to decode
+    Option<uint32_t> rx_unknown_msgs;// messages with a msg_type this endpoint does not handle
+    Option<uint32_t> tx_frames;// frames handed to the uart
+    Option<uint32_t> tx_dropped;// frames not sent, uart busy or encode failed
+    Option<uint32_t> tx_frame_max;// largest frame sent in bytes
+    Option<uint32_t> tx_queue_max;// high-water mark of the reply queues
+    Option<uint32_t> tx_queue_dropped;// replies dropped on a full queue
+
+    /// Serialize this message into a CBOR map keyed by field id.
+    int encode(Buffer& buffer) const;
+
+    /// Deserialize a LinkDiagEvent from a CBOR map value.
+    int decode(const Buffer& buffer);
+};
+
+class PingReply : public Msg {
+public:
+
+    static const uint32_t MSG_ID = FNV("PingReply");
+    static constexpr const char *MSG_NAME ="PingReply";
+
+    virtual uint32_t msg_id() const { return MSG_ID; };
+    virtual const char *msg_name() const { return MSG_NAME; };
+
+    typedef enum FieldId {
+        REQ_ID = 0,
+        TIMESTAMP = 1,
+        RX_US = 2,
+        TX_US = 3,
+    } FieldId;
+    Option<uint32_t> req_id;
+    Option<uint64_t> timestamp;// Timestamp in milliseconds since epoch
+    Option<uint64_t> rx_us;// Board clock when the request arrived, us since boot
+    Option<uint64_t> tx_us;// Board clock when the reply frame was handed to the UART, us since boot
+
+    /// Serialize this message into a CBOR map keyed by field id.
+    int encode(Buffer& buffer) const;
+
+    /// Deserialize a PingReply from a CBOR map value.
+    int decode(const Buffer& buffer);
+};
+
+class ScopeEvent : public Msg {
+public:
+
+    static const uint32_t MSG_ID = FNV("ScopeEvent");
+    static constexpr const char *MSG_NAME ="ScopeEvent";
+
+    virtual uint32_t msg_id() const { return MSG_ID; };
+    virtual const char *msg_name() const { return MSG_NAME; };
+
+    typedef enum FieldId {
+        CAPTURE_ID = 0,
+        STATE = 1,
+        CHANNELS = 2,
+        DECIMATION = 3,
+        PRE_SAMPLES = 4,
+        SAMPLES = 5,
+        OFFSET = 6,
+        DATA = 7,
+    } FieldId;
+    Option<uint32_t> capture_id;// increments with every armed capture
+    Option<uint32_t> state;// 0 idle, 1 armed, 2 triggered, 3 done
+    Option<uint32_t> channels;// bit mask of the captured channels
+    Option<uint32_t> decimation;// 16 kHz periods per sample
+    Option<uint32_t> pre_samples;// samples per channel before the trigger
+    Option<uint32_t> samples;// samples per channel in the capture
+    Option<uint32_t> offset;// index of the first sample in data
+    Option<std::vector<uint8_t>> data;// int16 little endian, one sample of every channel per row, channels in bit order
+
+    /// Serialize this message into a CBOR map keyed by field id.
+    int encode(Buffer& buffer) const;
+
+    /// Deserialize a ScopeEvent from a CBOR map value.
+    int decode(const Buffer& buffer);
+};
+
+class ScopeRequest : public Msg {
+public:
+
+    static const uint32_t MSG_ID = FNV("ScopeRequest");
+    static constexpr const char *MSG_NAME ="ScopeRequest";
+
+    virtual uint32_t msg_id() const { return MSG_ID; };
+    virtual const char *msg_name() const { return MSG_NAME; };
+
+    typedef enum FieldId {
+        REQ_ID = 0,
+        CHANNELS = 1,
+        DECIMATION = 2,
+        TRIGGER = 3,
+        TRIGGER_CHANNEL = 4,
+        LEVEL = 5,
+        PRE_SAMPLES = 6,
+        FORCE = 7,
+        RESEND = 8,
+    } FieldId;
+    Option<uint32_t> req_id;// request id
+    Option<uint32_t> channels;// bit mask of the channels to capture, at most 10, 0 stops the capture
+    Option<uint32_t> decimation;// keep one sample in this many 16 kHz periods
+    Option<uint32_t> trigger;// 0 host (force), 1 rising, 2 falling, 3 error code
+    Option<uint32_t> trigger_channel;// channel compared with level for a rising or falling trigger
+    Option<int32_t> level;// trigger threshold in the channel's raw units
+    Option<uint32_t> pre_samples;// samples per channel kept from before the trigger
+    Option<uint32_t> force;// 1 triggers an armed capture now
+    Option<uint32_t> resend;// restart sending a finished capture from this sample
+
+    /// Serialize this message into a CBOR map keyed by field id.
+    int encode(Buffer& buffer) const;
+
+    /// Deserialize a ScopeRequest from a CBOR map value.
+    int decode(const Buffer& buffer);
+};
+
+class TraceEvent : public Msg {
+public:
+
+    static const uint32_t MSG_ID = FNV("TraceEvent");
+    static constexpr const char *MSG_NAME ="TraceEvent";
+
+    virtual uint32_t msg_id() const { return MSG_ID; };
+    virtual const char *msg_name() const { return MSG_NAME; };
+
+    typedef enum FieldId {
+        TICK = 0,
+        INTERVAL = 1,
+        ROWS = 2,
+        CHANNELS = 3,
+        SHIFTS = 4,
+        COLUMNS = 5,
+        SKIPPED = 6,
+    } FieldId;
+    Option<uint32_t> tick;// main loop tick of the first row
+    Option<uint32_t> interval;// main loop ticks between rows
+    Option<uint32_t> rows;// samples per channel in columns
+    Option<uint32_t> channels;// bit mask of the traced channels, columns in bit order
+    Option<std::vector<uint8_t>> shifts;// right shift applied to each channel before packing, one byte per column
+    Option<std::vector<uint8_t>> columns;// per column: zigzag varint of the first value, then of each delta
+    Option<uint32_t> skipped;// rows dropped since boot because a column was full
+
+    /// Serialize this message into a CBOR map keyed by field id.
+    int encode(Buffer& buffer) const;
+
+    /// Deserialize a TraceEvent from a CBOR map value.
+    int decode(const Buffer& buffer);
+};
+
+#endif
@@ -0,0 +1,20 @@
+// Endpoint profile : hoverboard
+// Generated messages the firmware encodes or decodes: the Envelope and
+// EndpointAnnounce every endpoint needs, the HoverboardRequest it serves and
+// the PingRequest of the clock sync. Enabled with -D LIMERO_PROFILE_HOVERBOARD;
+// keep it in sync when serial.cpp starts handling another message.
+//
+// The messages the hoverboard added, and its versions of GenericReply,
+// HoverboardEvent and PingReply, are in msgs_hoverboard.h and not generated,
+// so the generated GenericReply, HoverboardEvent and PingReply stay out.
+#ifndef LIMERO_PROFILE_HOVERBOARD_H
+#define LIMERO_PROFILE_HOVERBOARD_H
+
+#define LIMERO_MSG(name) LIMERO_MSG_##name
+
+#define LIMERO_MSG_Envelope 1
+#define LIMERO_MSG_EndpointAnnounce 1
+#define LIMERO_MSG_HoverboardRequest 1
+#define LIMERO_MSG_PingRequest 1
+
+#endif
@@ -0,0 +1,21 @@
+/*
+ * Main loop signals sent in TraceEvents with LIMERO_TRACE:
+ * X(name, value, shift). Bit n of TraceEvent.channels is the n-th entry.
+ * A shift drops low bits that are noise anyway, so the deltas stay small.
+ * Append at the end, the host tools look columns up by position.
+ */
+#ifndef TRACE_CHANNELS_H
+#define TRACE_CHANNELS_H
+
+#define TRACE_CHANNELS(X) \
+    X(cmdl, cmdL, 0) \
+    X(cmdr, cmdR, 0) \
+    X(spdl, rtY_Left.n_mot, 0) \
+    X(spdr, rtY_Right.n_mot, 0) \
+    X(ldc_curr, left_dc_curr, 0) \
+    X(rdc_curr, right_dc_curr, 0) \
+    X(steer, input1[0].cmd, 0) \
+    X(speed, input2[0].cmd, 0) \
+    X(batv, batVoltageCalib, 2)
+
+#endif
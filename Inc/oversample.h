@@ -0,0 +1,40 @@
+/*
+ * Oversampled battery voltage and board temperature, built with ADC_OVERSAMPLE.
+ *
+ * The battery and temperature channels are converted in the same scan as the
+ * phase currents, every 16 kHz period. Without ADC_OVERSAMPLE the battery
+ * filter takes one of them every 1000 periods, so ripple from the motor
+ * currents aliases into it, and the temperature filter one per main loop.
+ *
+ * oversample_sample() runs at the end of DMA1_Channel1_IRQHandler() and adds
+ * both channels to boxcar sums (a first order CIC). The battery is decimated
+ * OVERSAMPLE_BATT_DECIM:1 to 1 kHz, the temperature another
+ * OVERSAMPLE_TEMP_DECIM:1 to 100 Hz. The means keep 4 fractional bits.
+ */
+
+// Define to prevent recursive inclusion
+#ifndef OVERSAMPLE_H
+#define OVERSAMPLE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OVERSAMPLE_BATT_DECIM 16    // periods per battery mean (1 kHz), 16 x 12 bit fill one 16-bit sum
+#define OVERSAMPLE_TEMP_DECIM 10    // battery means per temperature mean (100 Hz)
+
+extern volatile uint16_t ovsBatt;       // [battery ADC counts, fixdt(0,16,4)] mean of the last OVERSAMPLE_BATT_DECIM periods, 0 until the first
+extern volatile uint8_t  ovsBattNew;    // set with every new ovsBatt, cleared by its reader
+extern volatile uint16_t ovsTemp;       // [temperature ADC counts, fixdt(0,16,4)] 0 until the first mean
+
+void    oversample_sample(void);
+int16_t oversample_batt(void);
+int16_t oversample_temp(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
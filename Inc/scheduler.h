@@ -0,0 +1,88 @@
+/*
+ * Cooperative rate-monotonic scheduler of the main loop.
+ *
+ * Each task of the table has a period and a deadline in ms. Its releases lie
+ * on a fixed grid of buzzerTimer ticks, so a slow task neither shifts its own
+ * next release nor the releases of the others. sched_run() runs the most
+ * urgent released task to completion and returns: shorter periods first,
+ * equal periods in table order. A task more than a whole period late runs
+ * once and drops the releases it missed.
+ *
+ * Execution times are DWT cycles and include the interrupts that preempt the
+ * task, as PROF_DEFERRED does. Release and start times are buzzerTimer ticks,
+ * so the jitter has a resolution of 62.5 us. The statistics are plain uint32
+ * so the debug protocol can show them as VARIABLEs.
+ *
+ * An interrupt that brings new input for a task calls sched_trigger(), which
+ * stamps the DWT cycle counter. The next run of the task takes the stamp over
+ * and passes it on to the task in its next field, so the latency from the
+ * input to the end of a chain of tasks is measured: for the command path
+ * from the received frame to new pwml/pwmr. With COMMAND_EVENT a triggered
+ * task is also released at once. Its grid then restarts one period after
+ * the event run, so steady input at more than 1 / period replaces the
+ * periodic runs instead of adding to them.
+ */
+
+// Define to prevent recursive inclusion
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SCHED_TICKS_MS      (PWM_FREQ / 1000)   // buzzerTimer ticks per ms
+#define SCHED_CYCLES_US     64                  // DWT cycles per us at 64 MHz
+#define SCHED_LOAD_MS       1000                // window of the load figures
+#define SCHED_LAT_TASK      TASK_MIXER          // end of the command path, its latencies go to schedLatHist
+#define SCHED_LAT_BINS      6                   // < 250, 500, 1000, 2000, 5000 us and more
+
+typedef struct {
+  const char *name;
+  void      (*run)(void);
+  uint16_t    periodMs;     // 0 = task not built
+  uint16_t    deadlineMs;   // after the release, at most periodMs
+  uint8_t     next;         // task a trigger is passed on to, 0 = none (TASK_COMMAND starts chains)
+  uint32_t    release;      // [ticks] buzzerTimer at the pending release
+  uint32_t    execWin;      // [cycles] spent in the current load window
+  uint32_t    runs;
+  uint32_t    overruns;     // runs that ended after their deadline
+  uint32_t    skipped;      // releases dropped, the task was more than a period late
+  uint32_t    jitterMax;    // [us] latest start after a release
+  uint32_t    execMax;      // [us] longest run
+  uint32_t    load;         // [permille] CPU time in the last load window
+  volatile uint8_t  triggered;      // set by sched_trigger(), cleared by the next run
+  volatile uint32_t triggerCycles;  // [cycles] DWT at the first trigger since the last run
+  uint32_t    events;       // runs that took a trigger over
+  uint32_t    latencyMax;   // [us] longest trigger to end of run
+} SchedTask;
+
+// Main loop tasks, the order of schedTasks[] in main.c
+typedef enum {
+  TASK_COMMAND = 0,   // readCommand(), calcAvgSpeed(), offsets, motor enabling
+  TASK_MIXER,         // variant pedal logic, rate limiter, filters, mixer, pwml/pwmr
+  TASK_SIDEBOARD,     // sideboard sensors and LEDs
+  TASK_MEASURE,       // board temperature, calibrated battery voltage, DC link currents
+  TASK_SAFETY,        // overrun policy, beeps, emergency and inactivity poweroff
+  TASK_FEEDBACK,      // serial feedback frame
+  TASK_TELEMETRY,     // Limero telemetry frame
+  TASK_DEBUG,         // debug output or debug protocol
+  TASK_LCD,           // transpotter LCD
+  TASK_COUNT
+} TaskId;
+
+extern SchedTask schedTasks[TASK_COUNT];
+extern uint32_t  schedLoad;     // [permille] all tasks in the last load window
+extern uint32_t  schedLatHist[SCHED_LAT_BINS];  // runs of SCHED_LAT_TASK per latency bin
+
+void    sched_init(SchedTask *tasks, uint8_t count);
+uint8_t sched_run(void);
+void    sched_trigger(uint8_t id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
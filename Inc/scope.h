@@ -0,0 +1,88 @@
+/*
+ * Triggered capture of control loop signals at the 16 kHz DMA interrupt rate.
+ *
+ * scope_sample() runs at the end of DMA1_Channel1_IRQHandler() and copies up
+ * to SCOPE_CHANNELS_MAX signals into a RAM ring. Once armed it keeps
+ * pre-trigger samples, waits for the trigger and fills the rest of the ring.
+ * The finished capture stays put until it is armed again; serial.cpp sends it
+ * to the host in ScopeEvent chunks.
+ *
+ * The CTL/TGT channels together with the phase and DC currents are every
+ * ExtU input a controller step sees, so a decimation 1 capture of them can be
+ * replayed on the host (Host/bldc_replay -i).
+ */
+
+// Define to prevent recursive inclusion
+#ifndef SCOPE_H
+#define SCOPE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SCOPE_CHANNELS_MAX  10      // channels per capture, all controller inputs of both motors
+#define SCOPE_BUFFER_SIZE   2048    // int16 samples, shared by the selected channels
+
+// Capturable signals, bit n of the channel mask selects channel n
+typedef enum {
+  SCOPE_CH_CURL_PHAA = 0,   // left phase A current  [ADC counts]
+  SCOPE_CH_CURL_PHAB,       // left phase B current
+  SCOPE_CH_CURL_DC,         // left DC link current
+  SCOPE_CH_CURR_PHAB,       // right phase B current
+  SCOPE_CH_CURR_PHAC,       // right phase C current
+  SCOPE_CH_CURR_DC,         // right DC link current
+  SCOPE_CH_IQ_L,            // left iq
+  SCOPE_CH_ID_L,            // left id
+  SCOPE_CH_IQ_R,            // right iq
+  SCOPE_CH_ID_R,            // right id
+  SCOPE_CH_ANGLE_L,         // left electrical angle
+  SCOPE_CH_ANGLE_R,         // right electrical angle
+  SCOPE_CH_SPEED_L,         // left motor speed [rpm]
+  SCOPE_CH_SPEED_R,         // right motor speed
+  SCOPE_CH_CTL_L,           // left b_hallA | b_hallB << 1 | b_hallC << 2 | b_motEna << 3 | z_ctrlModReq << 4
+  SCOPE_CH_TGT_L,           // left r_inpTgt
+  SCOPE_CH_CTL_R,           // right, as SCOPE_CH_CTL_L
+  SCOPE_CH_TGT_R,           // right r_inpTgt
+  SCOPE_CH_COUNT
+} ScopeChannel;
+
+typedef enum {
+  SCOPE_TRIG_HOST = 0,      // only scope_force()
+  SCOPE_TRIG_RISING,        // trigger channel crosses level upwards
+  SCOPE_TRIG_FALLING,       // trigger channel crosses level downwards
+  SCOPE_TRIG_ERROR          // either motor reports a z_errCode
+} ScopeTrigger;
+
+typedef enum {
+  SCOPE_IDLE = 0,
+  SCOPE_ARMED,              // filling pre-trigger samples, then waiting for the trigger
+  SCOPE_TRIGGERED,          // filling post-trigger samples
+  SCOPE_DONE                // capture complete, ready to be read
+} ScopeState;
+
+typedef struct {
+  uint32_t  channels;       // channel mask
+  uint16_t  decimation;     // 16 kHz periods per sample
+  uint8_t   trigger;        // ScopeTrigger
+  uint8_t   trigger_channel;
+  int16_t   level;
+  uint16_t  pre_samples;    // samples per channel before the trigger
+} ScopeConfig;
+
+int      scope_arm(const ScopeConfig *config);
+void     scope_force(void);
+void     scope_stop(void);
+void     scope_sample(void);
+uint8_t  scope_state(void);
+uint32_t scope_capture_id(void);
+const ScopeConfig *scope_config(void);
+uint16_t scope_samples(void);
+uint16_t scope_read(uint16_t offset, int16_t *dst, uint16_t max_samples);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -23,6 +23,9 @@
 
 #include <stdint.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 // Rx Structures USART
 #if defined(CONTROL_SERIAL_USART2) || defined(CONTROL_SERIAL_USART3)
@@ -67,18 +70,37 @@ typedef struct {
   int16_t   dband;  // deadband
 } InputStruct;
 
+// Tone for playTones(), a list ends with ms = 0
+typedef struct {
+  uint8_t   freq;   // buzzerFreq, 0 = silence
+  uint16_t  ms;     // duration
+} BuzzerTone;
+
 // Initialization Functions
 void BLDC_Init(void);
+void BLDC_paramCommit(void);
+void BLDC_paramSwap(void);
 void Input_Lim_Init(void);
 void Input_Init(void);
 void UART_DisableRxErrors(UART_HandleTypeDef *huart);
+#ifdef FAST_BOOT
+void offsetsLoad(void);
+void offsetsSave(void);
+#endif
+#ifdef ENERGY_COUNT
+void energyLoad(void);
+void energySave(void);
+#endif
 
 // General Functions
 void poweronMelody(void);
+void playTones(const BuzzerTone *tones);
+uint8_t playTonesUpdate(void);
 void beepCount(uint8_t cnt, uint8_t freq, uint8_t pattern);
 void beepLong(uint8_t freq);
 void beepShort(uint8_t freq);
 void beepShortMany(uint8_t cnt, int8_t dir);
+uint64_t board_time_us(void);
 void calcAvgSpeed(void);
 void adcCalibLim(void);
 void updateCurSpdLim(void);
@@ -127,5 +149,8 @@ typedef struct {
 } MultipleTap;
 void multipleTapDet(int16_t u, uint32_t timeNow, MultipleTap *x);
 
+#ifdef __cplusplus
+}
 #endif
 
+#endif
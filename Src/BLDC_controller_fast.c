@@ -0,0 +1,186 @@
+/*
+ * Hand-optimized replacements for the fixed-point helpers of the generated
+ * BLDC_controller.c, built with BLDC_FAST_HELPERS.
+ *
+ * BLDC_controller_weak.c declares the generated helpers weak, so these
+ * definitions take their place at link time without touching the generated
+ * code. Every function returns the same bits and leaves the same state as
+ * the generated one for all inputs; Host/fixdt_check runs both against each
+ * other. The differences are:
+ *  - int16 saturation is one SSAT instead of two compares and branches
+ *  - the saturating int32 sums test the overflow flag instead of subtracting
+ *    from MIN/MAX_int32_T first
+ *  - the prelookups shift instead of divide when the breakpoint spacing is a
+ *    power of two (found with __CLZ), the angle tables are spaced 128
+ *  - div_nde_s32_floor() divides once instead of twice (quotient and remainder)
+ */
+
+#include "config.h"
+
+#ifdef BLDC_FAST_HELPERS
+
+#include "BLDC_controller.h"
+
+#if defined(__arm__)
+  #define SAT16(x)    __SSAT((x), 16)
+  #define CLZ32(x)    __CLZ(x)
+#else
+  // host builds of the check harness
+  static inline int32_T SAT16(int32_T x) { return x > 32767 ? 32767 : x < -32768 ? -32768 : x; }
+  #define CLZ32(x)    __builtin_clz(x)
+#endif
+
+// a + b, clamped to the int32 range
+static inline int32_T add_sat32(int32_T a, int32_T b)
+{
+  int32_T sum;
+  if (__builtin_add_overflow(a, b, &sum)) {
+    sum = a < 0 ? MIN_int32_T : MAX_int32_T;
+  }
+  return sum;
+}
+
+// floor(x / space) for x < 65536
+static inline uint32_T div_space(uint32_T x, uint16_T space)
+{
+  if ((space & (space - 1U)) == 0U) {
+    return x >> (31 - CLZ32(space));
+  }
+  return x / space;
+}
+
+static inline int32_T signum(int32_T x)
+{
+  return (x > 0) - (x < 0);
+}
+
+uint8_T plook_u8s16_evencka(int16_T u, int16_T bp0, uint16_T bpSpace, uint32_T maxIndex)
+{
+  if (u <= bp0) {
+    return 0U;
+  }
+  // the generated code keeps the quotient in 16 bits before the clip
+  uint32_T idx = (uint16_T)div_space((uint16_T)(u - bp0), bpSpace);
+  return (uint8_T)(idx < maxIndex ? idx : maxIndex);
+}
+
+uint8_T plook_u8u16_evencka(uint16_T u, uint16_T bp0, uint16_T bpSpace, uint32_T maxIndex)
+{
+  if (u <= bp0) {
+    return 0U;
+  }
+  uint32_T idx = (uint16_T)div_space((uint16_T)((uint32_T)u - bp0), bpSpace);
+  return (uint8_T)(idx < maxIndex ? idx : maxIndex);
+}
+
+int32_T div_nde_s32_floor(int32_T numerator, int32_T denominator)
+{
+  int32_T q = numerator / denominator;
+  // C truncates toward zero: step down when the signs differ and something was cut off
+  return q - (((numerator ^ denominator) < 0) && (q * denominator != numerator));
+}
+
+int16_T Counter(int16_T rtu_inc, int16_T rtu_max, boolean_T rtu_rst, DW_Counter *localDW)
+{
+  int16_T cnt = (int16_T)(rtu_inc + (rtu_rst ? 0 : localDW->UnitDelay_DSTATE));
+  localDW->UnitDelay_DSTATE = cnt < rtu_max ? cnt : rtu_max;
+  return cnt;
+}
+
+void Low_Pass_Filter(const int16_T rtu_u[2], uint16_T rtu_coef, int16_T rty_y[2],
+                     DW_Low_Pass_Filter *localDW)
+{
+  int32_T s0 = localDW->UnitDelay1_DSTATE[0];
+  int32_T s1 = localDW->UnitDelay1_DSTATE[1];
+  s0 += rtu_coef * SAT16(rtu_u[0] - (s0 >> 16));
+  s1 += rtu_coef * SAT16(rtu_u[1] - (s1 >> 16));
+  rty_y[0] = (int16_T)(s0 >> 16);
+  rty_y[1] = (int16_T)(s1 >> 16);
+  localDW->UnitDelay1_DSTATE[0] = s0;
+  localDW->UnitDelay1_DSTATE[1] = s1;
+}
+
+void I_backCalc_fixdt(int16_T rtu_err, uint16_T rtu_I, uint16_T rtu_Kb, int16_T rtu_satMax,
+                      int16_T rtu_satMin, int16_T *rty_out, DW_I_backCalc_fixdt *localDW)
+{
+  int32_T sum = add_sat32((rtu_err * rtu_I) >> 4, localDW->UnitDelay_DSTATE) + localDW->UnitDelay_DSTATE_m;
+  int16_T y = (int16_T)(sum >> 12);
+  int16_T out = y > rtu_satMax ? rtu_satMax : y < rtu_satMin ? rtu_satMin : y;
+  *rty_out = out;
+  localDW->UnitDelay_DSTATE = (int16_T)(out - y) * rtu_Kb;
+  localDW->UnitDelay_DSTATE_m = sum;
+}
+
+/*
+ * The three PI controllers differ only in how the integrator is kept:
+ * PI_clamp_fixdt and _l in int32 with 16 fractional bits (_l is
+ * initialized from an int16), _k in int16 with the increment rounded
+ * toward zero.
+ */
+
+// output of the P and I parts, saturated to int16 like Sum1 of the model
+static inline int32_T pi_sum(int16_T rtu_err, uint16_T rtu_P, int32_T integ16)
+{
+  int32_T p = SAT16((rtu_err * rtu_P) >> 11);
+  return SAT16(((integ16 << 1) + p) >> 1);
+}
+
+// clamp to [satMin, satMax] and tell whether the integrator has to stop
+static inline boolean_T pi_clamp(int32_T sum, int32_T inc, int16_T rtu_satMax, int16_T rtu_satMin,
+                                 int16_T *rty_out)
+{
+  int16_T y = (int16_T)sum;
+  boolean_T hi = y > rtu_satMax;
+  boolean_T lo = y < rtu_satMin;
+  *rty_out = hi ? rtu_satMax : lo ? rtu_satMin : y;
+  return (hi || lo) && signum(inc) == signum(y);
+}
+
+void PI_clamp_fixdt(int16_T rtu_err, uint16_T rtu_P, uint16_T rtu_I, int32_T rtu_init,
+                    int16_T rtu_satMax, int16_T rtu_satMin, int32_T rtu_ext_limProt,
+                    int16_T *rty_out, DW_PI_clamp_fixdt *localDW)
+{
+  int32_T inc = add_sat32(rtu_err * rtu_I, rtu_ext_limProt);
+  if (localDW->icLoad != 0) {
+    localDW->ResettableDelay_DSTATE = rtu_init;
+  }
+  int32_T integ = (localDW->UnitDelay1_DSTATE ? 0 : inc) + localDW->ResettableDelay_DSTATE;
+  int32_T sum = pi_sum(rtu_err, rtu_P, integ >> 16);
+  localDW->UnitDelay1_DSTATE = pi_clamp(sum, inc, rtu_satMax, rtu_satMin, rty_out);
+  localDW->icLoad = 0U;
+  localDW->ResettableDelay_DSTATE = integ;
+}
+
+void PI_clamp_fixdt_l(int16_T rtu_err, uint16_T rtu_P, uint16_T rtu_I, int16_T rtu_init,
+                      int16_T rtu_satMax, int16_T rtu_satMin, int32_T rtu_ext_limProt,
+                      int16_T *rty_out, DW_PI_clamp_fixdt_m *localDW)
+{
+  int32_T inc = add_sat32(rtu_err * rtu_I, rtu_ext_limProt);
+  if (localDW->icLoad != 0) {
+    localDW->ResettableDelay_DSTATE = rtu_init << 16;
+  }
+  int32_T integ = (localDW->UnitDelay1_DSTATE ? 0 : inc) + localDW->ResettableDelay_DSTATE;
+  int32_T sum = pi_sum(rtu_err, rtu_P, integ >> 16);
+  localDW->UnitDelay1_DSTATE = pi_clamp(sum, inc, rtu_satMax, rtu_satMin, rty_out);
+  localDW->icLoad = 0U;
+  localDW->ResettableDelay_DSTATE = integ;
+}
+
+void PI_clamp_fixdt_k(int16_T rtu_err, uint16_T rtu_P, uint16_T rtu_I, int16_T rtu_init,
+                      int16_T rtu_satMax, int16_T rtu_satMin, int32_T rtu_ext_limProt,
+                      int16_T *rty_out, DW_PI_clamp_fixdt_g *localDW)
+{
+  int32_T inc = add_sat32(rtu_err * rtu_I, rtu_ext_limProt);
+  if (localDW->icLoad != 0) {
+    localDW->ResettableDelay_DSTATE = rtu_init;
+  }
+  // inc / 65536 rounded toward zero
+  int16_T inc16 = localDW->UnitDelay1_DSTATE ? 0 : (int16_T)((inc + ((inc >> 31) & 0xFFFF)) >> 16);
+  int16_T integ = (int16_T)(inc16 + localDW->ResettableDelay_DSTATE);
+  int32_T sum = pi_sum(rtu_err, rtu_P, integ);
+  localDW->UnitDelay1_DSTATE = pi_clamp(sum, inc, rtu_satMax, rtu_satMin, rty_out);
+  localDW->icLoad = 0U;
+  localDW->ResettableDelay_DSTATE = integ;
+}
+
+#endif
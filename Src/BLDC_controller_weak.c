@@ -0,0 +1,32 @@
+/*
+ * The build unit of the generated BLDC_controller.c.
+ *
+ * Makefile and platformio.ini compile this file in place of BLDC_controller.c,
+ * which stays exactly as generated. With BLDC_FAST_HELPERS the helpers that
+ * BLDC_controller_fast.c replaces are declared weak before the generated
+ * definitions, so the linker takes the fast ones. The pragmas only affect
+ * this unit: the calls in BLDC_controller_step are not inlined and go
+ * through the symbols.
+ */
+
+#include "config.h"
+
+#ifdef BLDC_FAST_HELPERS
+#pragma weak plook_u8s16_evencka
+#pragma weak plook_u8u16_evencka
+#pragma weak div_nde_s32_floor
+#pragma weak Counter
+#pragma weak Low_Pass_Filter
+#pragma weak I_backCalc_fixdt
+#pragma weak PI_clamp_fixdt
+#pragma weak PI_clamp_fixdt_l
+#pragma weak PI_clamp_fixdt_k
+#endif
+
+// the generated file defines the control modes itself, with the same values
+#undef OPEN_MODE
+#undef VLT_MODE
+#undef SPD_MODE
+#undef TRQ_MODE
+
+#include "BLDC_controller.c"
@@ -27,6 +27,22 @@
 #include "setup.h"
 #include "config.h"
 #include "util.h"
+#include "isr_profile.h"
+#ifdef LIMERO_SCOPE
+#include "scope.h"
+#endif
+#ifdef LIMERO_STATS
+#include "isr_stats.h"
+#endif
+#ifdef ENERGY_COUNT
+#include "energy.h"
+#endif
+#ifdef ADC_OVERSAMPLE
+#include "oversample.h"
+#endif
+#ifdef HALL_CAPTURE
+#include "hall_speed.h"
+#endif
 
 // Matlab includes and defines - from auto-code generation
 // ###############################################################################
@@ -39,7 +55,7 @@ extern RT_MODEL *const rtM_Right;
 extern DW   rtDW_Left;                  /* Observable states */
 extern ExtU rtU_Left;                   /* External inputs */
 extern ExtY rtY_Left;                   /* External outputs */
-extern P    rtP_Left;
+extern volatile uint8_t rtP_pending;  /* Parameter set committed by the main loop */
 
 extern DW   rtDW_Right;                 /* Observable states */
 extern ExtU rtU_Right;                  /* External inputs */
@@ -62,12 +78,17 @@ volatile uint8_t buzzerFreq          = 0;
 volatile uint8_t buzzerPattern       = 0;
 volatile uint8_t buzzerCount         = 0;
 volatile uint32_t buzzerTimer = 0;
+static uint32_t buzzerLast  = 0;        // last buzzerTimer value PendSV_Handler() stepped the buzzer for
 static uint8_t  buzzerPrev  = 0;
 static uint8_t  buzzerIdx   = 0;
 
 volatile uint8_t        enable       = 0;        // initially motors are disabled for SAFETY
 static uint8_t enableFin    = 0;
 
+uint32_t overrunCnt    = 0;    // periods that ended after the next ADC conversion was already done
+uint16_t overrunRunMax = 0;    // longest run of consecutive overruns, main.c applies OVERRUN_POLICY
+static uint16_t overrunRun = 0;
+
 static const uint16_t pwm_res  = 64000000 / 2 / PWM_FREQ; // = 2000
 
 static uint16_t offsetcount = 0;
@@ -78,34 +99,195 @@ static int16_t offsetrrC    = 2000;
 static int16_t offsetdcl    = 2000;
 static int16_t offsetdcr    = 2000;
 
+#if defined(OFFSET_TRACK) || defined(FAST_BOOT)
+// The six offsets above and the ADC samples they belong to
+static int16_t *const offsetVal[6] = {&offsetrlA, &offsetrlB, &offsetrrB, &offsetrrC, &offsetdcl, &offsetdcr};
+static volatile uint16_t *const offsetAdc[6] = {&adc_buffer.rlA, &adc_buffer.rlB, &adc_buffer.rrB,
+                                                &adc_buffer.rrC, &adc_buffer.dcl, &adc_buffer.dcr};
+#endif
+
+#ifdef FAST_BOOT
+int16_t  offsetStored[6];               // offsets of the last run in the order of offsetVal[], from offsetsLoad() before the ADC starts
+uint8_t  offsetStoredValid = 0;
+uint8_t  offsetFastBoot    = 0;         // 1 when the stored offsets passed the check and the calibration was skipped
+volatile uint8_t offsetSaveReq = 0;     // a full calibration finished, the main loop stores its offsets
+#endif
+
+#ifdef OFFSET_TRACK
+// State of the offset tracker
+static int32_t  offsetFixdt[6];         // tracked offsets in fixdt(1,32,16)
+static int16_t  offsetBoot[6];          // boot calibration
+static uint16_t offsetSettle = 0;       // periods the bridges have been off at standstill
+int16_t  offsetDrift    = 0;            // largest |offset - boot calibration| of the six [ADC counts]
+uint32_t offsetTrackCnt = 0;            // periods the offsets were tracked
+#endif
+
+#ifdef OFFSET_TRACK
+// Boot calibration done: the tracker starts from it and stays within OFFSET_TRACK_RANGE of it
+static void offsetTrackInit(void) {
+  for (uint8_t i = 0; i < 6; i++) {
+    offsetBoot[i]  = *offsetVal[i];
+    offsetFixdt[i] = (int32_t)*offsetVal[i] << 16;
+  }
+}
+
+// With both bridges off (MOE cleared) the true currents are zero after the settle time, so
+// each ADC sample is a sample of its offset. Low-pass with a bounded slew, then round.
+// enableFin, not enable: it is what the controllers last ran with, and stays set until they stopped.
+static inline void offsetTrack(void) {
+  if (enableFin || ((LEFT_TIM->BDTR | RIGHT_TIM->BDTR) & TIM_BDTR_MOE) ||
+      ABS(rtY_Left.n_mot) > OFFSET_TRACK_RPM || ABS(rtY_Right.n_mot) > OFFSET_TRACK_RPM) {
+    offsetSettle = 0;
+    return;
+  }
+  if (offsetSettle < OFFSET_TRACK_SETTLE) {
+    offsetSettle++;
+    return;
+  }
+  int16_t drift = 0;
+  for (uint8_t i = 0; i < 6; i++) {
+    int32_t step = (((int32_t)*offsetAdc[i] << 16) - offsetFixdt[i]) >> OFFSET_TRACK_SHIFT;
+    offsetFixdt[i] += CLAMP(step, -OFFSET_TRACK_SLEW, OFFSET_TRACK_SLEW);
+    offsetFixdt[i]  = CLAMP(offsetFixdt[i], (int32_t)(offsetBoot[i] - OFFSET_TRACK_RANGE) << 16,
+                                            (int32_t)(offsetBoot[i] + OFFSET_TRACK_RANGE) << 16);
+    *offsetVal[i]   = (int16_t)((offsetFixdt[i] + (1 << 15)) >> 16);
+    drift = MAX(drift, ABS(*offsetVal[i] - offsetBoot[i]));
+  }
+  offsetDrift = drift;
+  offsetTrackCnt++;
+}
+#endif
+
+#ifdef FAST_BOOT
+// Checks the stored offsets against the mean of the first FAST_BOOT_CHECK_SAMPLES periods. Returns 1 while
+// checking and once they are taken over, 0 when one is off by more than FAST_BOOT_CHECK_TOL and the
+// full calibration has to run from the start.
+static uint8_t offsetFastCheck(void) {
+  static int32_t sum[6];
+  for (uint8_t i = 0; i < 6; i++) {
+    sum[i] += *offsetAdc[i];
+  }
+  if (offsetcount < FAST_BOOT_CHECK_SAMPLES) {
+    return 1;
+  }
+  for (uint8_t i = 0; i < 6; i++) {
+    if (ABS(sum[i] / FAST_BOOT_CHECK_SAMPLES - offsetStored[i]) > FAST_BOOT_CHECK_TOL) {
+      offsetStoredValid = 0;
+      offsetcount = 0;
+      return 0;
+    }
+  }
+  for (uint8_t i = 0; i < 6; i++) {
+    *offsetVal[i] = offsetStored[i];
+  }
+  offsetFastBoot = 1;
+  offsetcount = 2000;
+  #ifdef OFFSET_TRACK
+  offsetTrackInit();
+  #endif
+  return 1;
+}
+
+// Main loop: the offsets in use, in the order of offsetVal[]. Returns 0 while they are still being calibrated.
+uint8_t offsetsGet(int16_t offsets[6]) {
+  for (uint8_t i = 0; i < 6; i++) {
+    offsets[i] = *offsetVal[i];
+  }
+  return offsetcount >= 2000;
+}
+#endif
+
+#ifdef HALL_CAPTURE
+// Hall levels as the controller gets them, b_hallA << 2 | b_hallB << 1 | b_hallC
+#define HALL_LEFT()   ((!(LEFT_HALL_U_PORT->IDR & LEFT_HALL_U_PIN) << 2) | (!(LEFT_HALL_V_PORT->IDR & LEFT_HALL_V_PIN) << 1) | \
+                       !(LEFT_HALL_W_PORT->IDR & LEFT_HALL_W_PIN))
+#define HALL_RIGHT()  ((!(RIGHT_HALL_U_PORT->IDR & RIGHT_HALL_U_PIN) << 2) | (!(RIGHT_HALL_V_PORT->IDR & RIGHT_HALL_V_PIN) << 1) | \
+                       !(RIGHT_HALL_W_PORT->IDR & RIGHT_HALL_W_PIN))
+
+static HallEdges hallEdgesL, hallEdgesR;    // written by the EXTI interrupts only
+HallSpeed hallSpeedL, hallSpeedR;           // updated every period
+
+// main(), before the ADC starts the DMA interrupt
+void hall_capture_init(void) {
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;   // DWT needs trace enabled
+  DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
+  hall_speed_init(&hallEdgesL, HALL_LEFT());
+  hall_speed_init(&hallEdgesR, HALL_RIGHT());
+  __HAL_GPIO_EXTI_CLEAR_IT(LEFT_HALL_U_PIN | LEFT_HALL_V_PIN | LEFT_HALL_W_PIN | RIGHT_HALL_U_PIN | RIGHT_HALL_V_PIN | RIGHT_HALL_W_PIN);
+  // The edges preempt the DMA interrupt to be stamped on time. Nothing else may: what runs at
+  // priority 0 so far moves to 1 and keeps its order with the DMA interrupt.
+  HAL_NVIC_SetPriority(SysTick_IRQn, 1, 0);
+  for (int irq = WWDG_IRQn; irq <= DMA2_Channel4_5_IRQn; irq++) {
+    if (NVIC_GetPriority((IRQn_Type)irq) == 0) {
+      HAL_NVIC_SetPriority((IRQn_Type)irq, 1, 0);
+    }
+  }
+  HAL_NVIC_SetPriority(EXTI9_5_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(EXTI9_5_IRQn);
+  HAL_NVIC_SetPriority(EXTI15_10_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(EXTI15_10_IRQn);
+}
+
+// EXTI9_5_IRQHandler(): PB5..7. Cleared before the levels are read, a later edge interrupts again.
+void hall_capture_left(void) {
+  uint32_t t = DWT->CYCCNT;
+  __HAL_GPIO_EXTI_CLEAR_IT(LEFT_HALL_U_PIN | LEFT_HALL_V_PIN | LEFT_HALL_W_PIN);
+  hall_speed_edge(&hallEdgesL, HALL_LEFT(), t);
+}
+
+// EXTI15_10_IRQHandler(): PC10..12
+void hall_capture_right(void) {
+  uint32_t t = DWT->CYCCNT;
+  __HAL_GPIO_EXTI_CLEAR_IT(RIGHT_HALL_U_PIN | RIGHT_HALL_V_PIN | RIGHT_HALL_W_PIN);
+  hall_speed_edge(&hallEdgesR, HALL_RIGHT(), t);
+}
+#endif
+
 int16_t        batVoltage       = (400 * BAT_CELLS * BAT_CALIB_ADC) / BAT_CALIB_REAL_VOLTAGE;
 static int32_t batVoltageFixdt  = (400 * BAT_CELLS * BAT_CALIB_ADC) / BAT_CALIB_REAL_VOLTAGE << 16;  // Fixed-point filter output initialized at 400 V*100/cell = 4 V/cell converted to fixed-point
+#ifndef ADC_OVERSAMPLE
+static uint16_t          battCount     = 0;   // periods since the last battery sample
+static volatile uint16_t battSample    = 0;   // adc_buffer.batt1 of every 1000th period, latched in the DMA interrupt
+static volatile uint8_t  battSampleNew = 0;   // set with every new battSample, cleared by PendSV_Handler()
+#endif
+#ifdef ADC_OVERSAMPLE
+#define BAT_FILT_COEF_1K        ((BAT_FILT_COEF * 4096 + 500) / 1000) // fixdt(0,32,24): BAT_FILT_COEF is per 1000 periods, the 1 kHz means come every 16
+#endif
 
 // =================================
 // DMA interrupt frequency =~ 16 kHz
 // =================================
-void DMA1_Channel1_IRQHandler(void) {
+RAMFUNC void DMA1_Channel1_IRQHandler(void) {
 
+  PROF_START(PROF_TOTAL);
   DMA1->IFCR = DMA_IFCR_CTCIF1;
   // HAL_GPIO_WritePin(LED_PORT, LED_PIN, 1);
   // HAL_GPIO_TogglePin(LED_PORT, LED_PIN);
 
   if(offsetcount < 2000) {  // calibrate ADC offsets
     offsetcount++;
+    #ifdef FAST_BOOT
+    if (offsetStoredValid && offsetFastCheck()) {
+      return;
+    }
+    #endif
     offsetrlA = (adc_buffer.rlA + offsetrlA) / 2;
     offsetrlB = (adc_buffer.rlB + offsetrlB) / 2;
     offsetrrB = (adc_buffer.rrB + offsetrrB) / 2;
     offsetrrC = (adc_buffer.rrC + offsetrrC) / 2;
     offsetdcl = (adc_buffer.dcl + offsetdcl) / 2;
     offsetdcr = (adc_buffer.dcr + offsetdcr) / 2;
+    if (offsetcount == 2000) {
+      #ifdef OFFSET_TRACK
+      offsetTrackInit();
+      #endif
+      #ifdef FAST_BOOT
+      offsetSaveReq = 1;
+      #endif
+    }
     return;
   }
 
-  if (buzzerTimer % 1000 == 0) {  // Filter battery voltage at a slower sampling rate
-    filtLowPass32(adc_buffer.batt1, BAT_FILT_COEF, &batVoltageFixdt);
-    batVoltage = (int16_t)(batVoltageFixdt >> 16);  // convert fixed-point to integer
-  }
-
   // Get Left motor currents
   curL_phaA = (int16_t)(offsetrlA - adc_buffer.rlA);
   curL_phaB = (int16_t)(offsetrlB - adc_buffer.rlB);
@@ -130,32 +312,17 @@ void DMA1_Channel1_IRQHandler(void) {
     RIGHT_TIM->BDTR |= TIM_BDTR_MOE;
   }
 
-  // Create square wave for buzzer
-  buzzerTimer++;
-  if (buzzerFreq != 0 && (buzzerTimer / 5000) % (buzzerPattern + 1) == 0) {
-    if (buzzerPrev == 0) {
-      buzzerPrev = 1;
-      if (++buzzerIdx > (buzzerCount + 2)) {    // pause 2 periods
-        buzzerIdx = 1;
-      }
-    }
-    if (buzzerTimer % buzzerFreq == 0 && (buzzerIdx <= buzzerCount || buzzerCount == 0)) {
-      HAL_GPIO_TogglePin(BUZZER_PORT, BUZZER_PIN);
-    }
-  } else if (buzzerPrev) {
-      HAL_GPIO_WritePin(BUZZER_PORT, BUZZER_PIN, GPIO_PIN_RESET);
-      buzzerPrev = 0;
-  }
-
-  // Adjust pwm_margin depending on the selected Control Type
-  if (rtP_Left.z_ctrlTypSel == FOC_CTRL) {
-    pwm_margin = 110;
-  } else {
-    pwm_margin = 0;
-  }
+  #ifdef OFFSET_TRACK
+    offsetTrack();                      // offsets for the next period
+  #endif
 
   // ############################### MOTOR CONTROL ###############################
 
+  // Take up a committed parameter set here, so both motors step with the same one
+  if (rtP_pending) {
+    BLDC_paramSwap();
+  }
+
   int ul, vl, wl;
   int ur, vr, wr;
   static boolean_T OverrunFlag = false;
@@ -185,12 +352,19 @@ void DMA1_Channel1_IRQHandler(void) {
     rtU_Left.i_phaAB      = curL_phaA;
     rtU_Left.i_phaBC      = curL_phaB;
     rtU_Left.i_DCLink     = curL_DC;
+    #ifdef HALL_CAPTURE
+    hall_speed_update(&hallEdgesL, DWT->CYCCNT, HALL_CAPTURE_TIMEOUT * (HALL_TICK_HZ / 1000), rtM_Left->defaultParam->n_polePairs, &hallSpeedL);
+    rtU_Left.a_mechAngle  = hallSpeedL.mechAngle;   // used with b_angleMeasEna, see HALL_CAPTURE_ANGLE
+    #else
     // rtU_Left.a_mechAngle   = ...; // Angle input in DEGREES [0,360] in fixdt(1,16,4) data type. If `angle` is float use `= (int16_t)floor(angle * 16.0F)` If `angle` is integer use `= (int16_t)(angle << 4)`
+    #endif
     
     /* Step the controller */
+    PROF_START(PROF_LEFT);
     #ifdef MOTOR_LEFT_ENA    
     BLDC_controller_step(rtM_Left);
     #endif
+    PROF_STOP(PROF_LEFT);
 
     /* Get motor outputs here */
     ul            = rtY_Left.DC_phaA;
@@ -204,6 +378,7 @@ void DMA1_Channel1_IRQHandler(void) {
     LEFT_TIM->LEFT_TIM_U    = (uint16_t)CLAMP(ul + pwm_res / 2, pwm_margin, pwm_res-pwm_margin);
     LEFT_TIM->LEFT_TIM_V    = (uint16_t)CLAMP(vl + pwm_res / 2, pwm_margin, pwm_res-pwm_margin);
     LEFT_TIM->LEFT_TIM_W    = (uint16_t)CLAMP(wl + pwm_res / 2, pwm_margin, pwm_res-pwm_margin);
+    PROF_MARK(PROF_PWM_L);
   // =================================================================
   
 
@@ -223,12 +398,19 @@ void DMA1_Channel1_IRQHandler(void) {
     rtU_Right.i_phaAB       = curR_phaB;
     rtU_Right.i_phaBC       = curR_phaC;
     rtU_Right.i_DCLink      = curR_DC;
+    #ifdef HALL_CAPTURE
+    hall_speed_update(&hallEdgesR, DWT->CYCCNT, HALL_CAPTURE_TIMEOUT * (HALL_TICK_HZ / 1000), rtM_Right->defaultParam->n_polePairs, &hallSpeedR);
+    rtU_Right.a_mechAngle   = hallSpeedR.mechAngle;
+    #else
     // rtU_Right.a_mechAngle   = ...; // Angle input in DEGREES [0,360] in fixdt(1,16,4) data type. If `angle` is float use `= (int16_t)floor(angle * 16.0F)` If `angle` is integer use `= (int16_t)(angle << 4)`
+    #endif
     
     /* Step the controller */
+    PROF_START(PROF_RIGHT);
     #ifdef MOTOR_RIGHT_ENA
     BLDC_controller_step(rtM_Right);
     #endif
+    PROF_STOP(PROF_RIGHT);
 
     /* Get motor outputs here */
     ur            = rtY_Right.DC_phaA;
@@ -242,11 +424,104 @@ void DMA1_Channel1_IRQHandler(void) {
     RIGHT_TIM->RIGHT_TIM_U  = (uint16_t)CLAMP(ur + pwm_res / 2, pwm_margin, pwm_res-pwm_margin);
     RIGHT_TIM->RIGHT_TIM_V  = (uint16_t)CLAMP(vr + pwm_res / 2, pwm_margin, pwm_res-pwm_margin);
     RIGHT_TIM->RIGHT_TIM_W  = (uint16_t)CLAMP(wr + pwm_res / 2, pwm_margin, pwm_res-pwm_margin);
+    PROF_MARK(PROF_PWM_R);
   // =================================================================
 
+  #ifdef LIMERO_SCOPE
+    scope_sample();
+  #endif
+  #ifdef LIMERO_STATS
+    isr_stats_sample();
+  #endif
+  #ifdef ENERGY_COUNT
+    energy_sample();
+  #endif
+  #ifdef ADC_OVERSAMPLE
+    oversample_sample();
+  #else
+    if (++battCount == 1000) {    // the filter runs later, the sample belongs to this period
+      battCount     = 0;
+      battSample    = adc_buffer.batt1;
+      battSampleNew = 1;
+    }
+  #endif
+
+  // Everything that can wait runs in PendSV_Handler() once this handler returns
+  buzzerTimer++;
+  SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+
+  // Overrun: the next conversion is already in, its interrupt tail-chains one period late
+  if (DMA1->ISR & DMA_ISR_TCIF1) {
+    overrunCnt++;
+    if (++overrunRun > overrunRunMax) {
+      overrunRunMax = overrunRun;
+    }
+  } else {
+    overrunRun = 0;
+  }
+
+  PROF_END();
+
   /* Indicate task complete */
   OverrunFlag = false;
  
  // ###############################################################################
 
 }
+
+// =================================
+// PendSV, pended by every DMA interrupt that ran the controllers
+// =================================
+// Lowest priority: runs right after DMA1_Channel1_IRQHandler() returns, unless
+// another interrupt is pending, and the DMA interrupt preempts it.
+void PendSV_Handler(void) {
+
+  PROF_START(PROF_DEFERRED);
+
+  #ifdef ADC_OVERSAMPLE
+  if (ovsBattNew) {               // Filter the 1 kHz battery mean, with the time constant BAT_FILT_COEF has at 16 Hz
+    ovsBattNew = 0;
+    // the same first order filter as filtLowPass32(), on the fixdt(0,16,4) mean with all its bits
+    int32_t diff = ((int32_t)ovsBatt << 12) - batVoltageFixdt;
+    batVoltageFixdt += (int32_t)(((int64_t)diff * BAT_FILT_COEF_1K + (1 << 23)) >> 24);
+    batVoltage = (int16_t)(batVoltageFixdt >> 16);  // convert fixed-point to integer
+  }
+  #else
+  if (battSampleNew) {            // Filter battery voltage at a slower sampling rate
+    battSampleNew = 0;
+    filtLowPass32(battSample, BAT_FILT_COEF, &batVoltageFixdt);
+    batVoltage = (int16_t)(batVoltageFixdt >> 16);  // convert fixed-point to integer
+  }
+  #endif
+
+  // Create square wave for buzzer, one step per DMA period, also for periods
+  // that ended before this handler got to run
+  uint32_t now = buzzerTimer;
+  while (buzzerLast != now) {
+    uint32_t t = ++buzzerLast;
+    if (buzzerFreq != 0 && (t / 5000) % (buzzerPattern + 1) == 0) {
+      if (buzzerPrev == 0) {
+        buzzerPrev = 1;
+        if (++buzzerIdx > (buzzerCount + 2)) {    // pause 2 periods
+          buzzerIdx = 1;
+        }
+      }
+      if (t % buzzerFreq == 0 && (buzzerIdx <= buzzerCount || buzzerCount == 0)) {
+        HAL_GPIO_TogglePin(BUZZER_PORT, BUZZER_PIN);
+      }
+    } else if (buzzerPrev) {
+        HAL_GPIO_WritePin(BUZZER_PORT, BUZZER_PIN, GPIO_PIN_RESET);
+        buzzerPrev = 0;
+    }
+  }
+
+  // Adjust pwm_margin depending on the selected Control Type, used from the next DMA interrupt on
+  if (rtM_Left->defaultParam->z_ctrlTypSel == FOC_CTRL) {
+    pwm_margin = 110;
+  } else {
+    pwm_margin = 0;
+  }
+
+  PROF_RECORD(PROF_DEFERRED);
+
+}
@@ -28,6 +28,8 @@
 #include "BLDC_controller.h"
 #include "util.h"
 #include "comms.h"
+#include "isr_profile.h"
+#include "scheduler.h"
 
 #if defined(DEBUG_SERIAL_PROTOCOL)
 #if defined(DEBUG_SERIAL_PROTOCOL) && (defined(DEBUG_SERIAL_USART2) || defined(DEBUG_SERIAL_USART3))
@@ -66,6 +68,21 @@ extern int16_t right_dc_curr;
 extern int16_t dc_curr;
 extern int16_t cmdL; 
 extern int16_t cmdR; 
+extern uint32_t overrunCnt;
+extern uint16_t overrunRunMax;
+extern uint8_t overrunErr;
+#ifdef OFFSET_TRACK
+extern int16_t offsetDrift;
+extern uint32_t offsetTrackCnt;
+#endif
+extern uint32_t bootReadyMs;
+#ifdef FAST_BOOT
+extern uint8_t offsetFastBoot;
+#endif
+#ifdef HALL_CAPTURE
+#include "hall_speed.h"
+extern HallSpeed hallSpeedL, hallSpeedR;
+#endif
 
 
 
@@ -142,6 +159,84 @@ const parameter_entry params[] = {
     {VARIABLE   ,"STR_COEF"           ,0       , NULL                        ,NULL                      ,0          ,STEER_COEFFICIENT ,0      ,0      ,0      ,0               ,10   ,14    ,NULL               ,"Steer Coefficient *10"},
     {VARIABLE   ,"BATV"               ,ADD_PARAM(batVoltageCalib)            ,NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Calibrated Battery voltage *100"},       
     {VARIABLE   ,"TEMP"               ,ADD_PARAM(board_temp_deg_c)           ,NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Calibrated Temperature °C *10"},       
+    {VARIABLE   ,"OVR_CNT"            ,ADD_PARAM(overrunCnt)                  ,NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Control ISR overruns"},
+    {VARIABLE   ,"OVR_RUN_MAX"        ,ADD_PARAM(overrunRunMax)               ,NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Max consecutive ISR overruns"},
+    {VARIABLE   ,"OVR_ERR"            ,ADD_PARAM(overrunErr)                  ,NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Overrun policy applied"},
+#if defined(OFFSET_TRACK)
+    {VARIABLE   ,"OFS_DRIFT"          ,ADD_PARAM(offsetDrift)                 ,NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Max current offset drift ADC counts"},
+    {VARIABLE   ,"OFS_TRACK"          ,ADD_PARAM(offsetTrackCnt)              ,NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Offset tracking periods"},
+#endif
+    {VARIABLE   ,"BOOT_MS"            ,ADD_PARAM(bootReadyMs)                 ,NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"ms from reset to the first motor enable"},
+#if defined(FAST_BOOT)
+    {VARIABLE   ,"FAST_BOOT"          ,ADD_PARAM(offsetFastBoot)              ,NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Stored current offsets used"},
+#endif
+#if defined(HALL_CAPTURE)
+    {VARIABLE   ,"HALL_RPM_L"         ,ADD_PARAM(hallSpeedL.rpm)              ,NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,4     ,NULL               ,"Left speed from hall edge timestamps"},
+    {VARIABLE   ,"HALL_RPM_R"         ,ADD_PARAM(hallSpeedR.rpm)              ,NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,4     ,NULL               ,"Right speed from hall edge timestamps"},
+#endif
+#if defined(ISR_PROFILE)
+  // ISR PROFILE
+  // Type       ,Name                 ,Datatype, ValueL ptr                  ,ValueR                    ,EEPRM Addr ,Init              Int/Ext ,Min    ,Max    ,Div             ,Mul  ,Fix   ,Callback Function  ,Help text
+    {VARIABLE   ,"ISR_MIN"            ,ADD_PARAM(isr_prof[PROF_TOTAL].min)    ,NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"ISR min cycles"},
+    {VARIABLE   ,"ISR_AVG"            ,ADD_PARAM(isr_prof[PROF_TOTAL].avg)    ,NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"ISR avg cycles"},
+    {VARIABLE   ,"ISR_MAX"            ,ADD_PARAM(isr_prof[PROF_TOTAL].max)    ,NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"ISR max cycles (budget 4000)"},
+    {VARIABLE   ,"ISR_LSTEP_AVG"      ,ADD_PARAM(isr_prof[PROF_LEFT].avg)     ,NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Left step avg cycles"},
+    {VARIABLE   ,"ISR_LSTEP_MAX"      ,ADD_PARAM(isr_prof[PROF_LEFT].max)     ,NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Left step max cycles"},
+    {VARIABLE   ,"ISR_RSTEP_AVG"      ,ADD_PARAM(isr_prof[PROF_RIGHT].avg)    ,NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Right step avg cycles"},
+    {VARIABLE   ,"ISR_RSTEP_MAX"      ,ADD_PARAM(isr_prof[PROF_RIGHT].max)    ,NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Right step max cycles"},
+    {VARIABLE   ,"ISR_REST_AVG"       ,ADD_PARAM(isr_prof[PROF_REST].avg)     ,NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"ISR rest avg cycles"},
+    {VARIABLE   ,"ISR_REST_MAX"       ,ADD_PARAM(isr_prof[PROF_REST].max)     ,NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"ISR rest max cycles"},
+    {VARIABLE   ,"ISR_PWML_MAX"       ,ADD_PARAM(isr_prof[PROF_PWM_L].max)    ,NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"ISR entry to left PWM max cycles"},
+    {VARIABLE   ,"ISR_PWMR_MAX"       ,ADD_PARAM(isr_prof[PROF_PWM_R].max)    ,NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"ISR entry to right PWM max cycles"},
+    {VARIABLE   ,"ISR_DEFER_MAX"      ,ADD_PARAM(isr_prof[PROF_DEFERRED].max) ,NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"PendSV deferred work max cycles"},
+#endif
+  // MAIN LOOP TASKS
+  // Type       ,Name                 ,Datatype, ValueL ptr                  ,ValueR                    ,EEPRM Addr ,Init              Int/Ext ,Min    ,Max    ,Div             ,Mul  ,Fix   ,Callback Function  ,Help text
+    {VARIABLE   ,"TSK_LOAD"           ,ADD_PARAM(schedLoad)                  ,NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"All tasks CPU permille"},
+    {VARIABLE   ,"TSK_CMD_LOAD"       ,ADD_PARAM(schedTasks[TASK_COMMAND].load),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Command task CPU permille"},
+    {VARIABLE   ,"TSK_CMD_MAX"        ,ADD_PARAM(schedTasks[TASK_COMMAND].execMax),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Command task max run us"},
+    {VARIABLE   ,"TSK_CMD_JIT"        ,ADD_PARAM(schedTasks[TASK_COMMAND].jitterMax),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Command task max start delay us"},
+    {VARIABLE   ,"TSK_CMD_OVR"        ,ADD_PARAM(schedTasks[TASK_COMMAND].overruns),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Command task deadline misses"},
+    {VARIABLE   ,"TSK_MIX_LOAD"       ,ADD_PARAM(schedTasks[TASK_MIXER].load),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Mixer task CPU permille"},
+    {VARIABLE   ,"TSK_MIX_MAX"        ,ADD_PARAM(schedTasks[TASK_MIXER].execMax),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Mixer task max run us"},
+    {VARIABLE   ,"TSK_MIX_JIT"        ,ADD_PARAM(schedTasks[TASK_MIXER].jitterMax),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Mixer task max start delay us"},
+    {VARIABLE   ,"TSK_MIX_OVR"        ,ADD_PARAM(schedTasks[TASK_MIXER].overruns),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Mixer task deadline misses"},
+    {VARIABLE   ,"TSK_SIDE_LOAD"      ,ADD_PARAM(schedTasks[TASK_SIDEBOARD].load),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Sideboard task CPU permille"},
+    {VARIABLE   ,"TSK_SIDE_MAX"       ,ADD_PARAM(schedTasks[TASK_SIDEBOARD].execMax),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Sideboard task max run us"},
+    {VARIABLE   ,"TSK_SIDE_JIT"       ,ADD_PARAM(schedTasks[TASK_SIDEBOARD].jitterMax),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Sideboard task max start delay us"},
+    {VARIABLE   ,"TSK_SIDE_OVR"       ,ADD_PARAM(schedTasks[TASK_SIDEBOARD].overruns),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Sideboard task deadline misses"},
+    {VARIABLE   ,"TSK_MEAS_LOAD"      ,ADD_PARAM(schedTasks[TASK_MEASURE].load),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Measure task CPU permille"},
+    {VARIABLE   ,"TSK_MEAS_MAX"       ,ADD_PARAM(schedTasks[TASK_MEASURE].execMax),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Measure task max run us"},
+    {VARIABLE   ,"TSK_MEAS_JIT"       ,ADD_PARAM(schedTasks[TASK_MEASURE].jitterMax),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Measure task max start delay us"},
+    {VARIABLE   ,"TSK_MEAS_OVR"       ,ADD_PARAM(schedTasks[TASK_MEASURE].overruns),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Measure task deadline misses"},
+    {VARIABLE   ,"TSK_SAFE_LOAD"      ,ADD_PARAM(schedTasks[TASK_SAFETY].load),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Safety task CPU permille"},
+    {VARIABLE   ,"TSK_SAFE_MAX"       ,ADD_PARAM(schedTasks[TASK_SAFETY].execMax),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Safety task max run us"},
+    {VARIABLE   ,"TSK_SAFE_JIT"       ,ADD_PARAM(schedTasks[TASK_SAFETY].jitterMax),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Safety task max start delay us"},
+    {VARIABLE   ,"TSK_SAFE_OVR"       ,ADD_PARAM(schedTasks[TASK_SAFETY].overruns),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Safety task deadline misses"},
+    {VARIABLE   ,"TSK_FDBK_LOAD"      ,ADD_PARAM(schedTasks[TASK_FEEDBACK].load),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Feedback task CPU permille"},
+    {VARIABLE   ,"TSK_FDBK_MAX"       ,ADD_PARAM(schedTasks[TASK_FEEDBACK].execMax),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Feedback task max run us"},
+    {VARIABLE   ,"TSK_FDBK_JIT"       ,ADD_PARAM(schedTasks[TASK_FEEDBACK].jitterMax),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Feedback task max start delay us"},
+    {VARIABLE   ,"TSK_FDBK_OVR"       ,ADD_PARAM(schedTasks[TASK_FEEDBACK].overruns),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Feedback task deadline misses"},
+    {VARIABLE   ,"TSK_TELE_LOAD"      ,ADD_PARAM(schedTasks[TASK_TELEMETRY].load),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Telemetry task CPU permille"},
+    {VARIABLE   ,"TSK_TELE_MAX"       ,ADD_PARAM(schedTasks[TASK_TELEMETRY].execMax),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Telemetry task max run us"},
+    {VARIABLE   ,"TSK_TELE_JIT"       ,ADD_PARAM(schedTasks[TASK_TELEMETRY].jitterMax),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Telemetry task max start delay us"},
+    {VARIABLE   ,"TSK_TELE_OVR"       ,ADD_PARAM(schedTasks[TASK_TELEMETRY].overruns),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Telemetry task deadline misses"},
+    {VARIABLE   ,"TSK_DBG_LOAD"       ,ADD_PARAM(schedTasks[TASK_DEBUG].load),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Debug task CPU permille"},
+    {VARIABLE   ,"TSK_DBG_MAX"        ,ADD_PARAM(schedTasks[TASK_DEBUG].execMax),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Debug task max run us"},
+    {VARIABLE   ,"TSK_DBG_JIT"        ,ADD_PARAM(schedTasks[TASK_DEBUG].jitterMax),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Debug task max start delay us"},
+    {VARIABLE   ,"TSK_DBG_OVR"        ,ADD_PARAM(schedTasks[TASK_DEBUG].overruns),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Debug task deadline misses"},
+    {VARIABLE   ,"TSK_LCD_LOAD"       ,ADD_PARAM(schedTasks[TASK_LCD].load)  ,NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"LCD task CPU permille"},
+    {VARIABLE   ,"TSK_LCD_MAX"        ,ADD_PARAM(schedTasks[TASK_LCD].execMax),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"LCD task max run us"},
+    {VARIABLE   ,"TSK_LCD_JIT"        ,ADD_PARAM(schedTasks[TASK_LCD].jitterMax),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"LCD task max start delay us"},
+    {VARIABLE   ,"TSK_LCD_OVR"        ,ADD_PARAM(schedTasks[TASK_LCD].overruns),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"LCD task deadline misses"},
+    {VARIABLE   ,"CMD_EVT"            ,ADD_PARAM(schedTasks[TASK_MIXER].events),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Mixer runs after a new command"},
+    {VARIABLE   ,"CMD_LAT_MAX"        ,ADD_PARAM(schedTasks[TASK_MIXER].latencyMax),NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Command to pwm max latency us"},
+    {VARIABLE   ,"CMD_LAT_250"        ,ADD_PARAM(schedLatHist[0])            ,NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Commands applied in 0-250 us"},
+    {VARIABLE   ,"CMD_LAT_500"        ,ADD_PARAM(schedLatHist[1])            ,NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Commands applied in 250-500 us"},
+    {VARIABLE   ,"CMD_LAT_1000"       ,ADD_PARAM(schedLatHist[2])            ,NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Commands applied in 500-1000 us"},
+    {VARIABLE   ,"CMD_LAT_2000"       ,ADD_PARAM(schedLatHist[3])            ,NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Commands applied in 1-2 ms"},
+    {VARIABLE   ,"CMD_LAT_5000"       ,ADD_PARAM(schedLatHist[4])            ,NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Commands applied in 2-5 ms"},
+    {VARIABLE   ,"CMD_LAT_MORE"       ,ADD_PARAM(schedLatHist[5])            ,NULL                      ,0          ,0                 ,0      ,0      ,0      ,0               ,0    ,0     ,NULL               ,"Commands applied after 5 ms"},
 
 };
 
@@ -0,0 +1,95 @@
+/*
+ * Charge and energy counters, see energy.h.
+ *
+ * Per motor and period energy_sample() costs a compare against
+ * ENERGY_DEADBAND, a 16 x 16 bit multiply and two 64-bit adds. The sums
+ * overflow after years at full current: 2000 counts x 4095 counts x 16 kHz
+ * is 2^37 per second.
+ *
+ * The main loop copies the sums while the ISR may update them, so the ISR
+ * bumps energySeq after every update and the copy is repeated until
+ * energySeq stays the same, as in hall_speed.c.
+ */
+
+#include <stdint.h>
+#include "config.h"
+#include "defines.h"
+#include "energy.h"
+
+#if defined(ENERGY_COUNT)
+
+extern int16_t curL_DC, curR_DC;
+extern volatile adc_buf_t adc_buffer;
+
+typedef struct {
+  int64_t usedCharge;     // [ADC counts x periods] DC link current while drawn
+  int64_t regenCharge;
+  int64_t usedEnergy;     // [ADC counts x battery ADC counts x periods]
+  int64_t regenEnergy;
+} EnergyAcc;
+
+static volatile EnergyAcc energyAcc[2];     // volatile: the main loop copies them while the ISR runs
+static volatile uint32_t energySeq = 0;
+
+EnergyTotals energyStored;
+
+// i: DC link current [ADC counts], positive while drawn from the battery
+static inline void energy_add(volatile EnergyAcc *acc, int32_t i, int32_t batt) {
+  if (i > ENERGY_DEADBAND) {
+    acc->usedCharge  += i;
+    acc->usedEnergy  += i * batt;
+  } else if (i < -ENERGY_DEADBAND) {
+    acc->regenCharge -= i;
+    acc->regenEnergy -= i * batt;
+  }
+}
+
+// DMA1_Channel1_IRQHandler(), after both controller steps
+RAMFUNC void energy_sample(void) {
+  int32_t batt = adc_buffer.batt1;
+  energy_add(&energyAcc[0], -curL_DC, batt);    // i_DCLink is negative while drawing, see main.c dc_curr
+  energy_add(&energyAcc[1], -curR_DC, batt);
+  energySeq++;
+}
+
+// 1 A = A2BIT_CONV counts for one period of 1 / PWM_FREQ s
+static uint32_t energy_mah(int64_t charge) {
+  return (uint32_t)(charge * 1000 / ((int64_t)A2BIT_CONV * PWM_FREQ * 3600));
+}
+
+// ... and 1 V = BAT_CALIB_ADC / (BAT_CALIB_REAL_VOLTAGE / 100) battery counts. Divided by the
+// current and time scale first, the voltage and mWh scale would not fit 64 bits otherwise
+static uint32_t energy_mwh(int64_t energy) {
+  int64_t as = energy / ((int64_t)A2BIT_CONV * PWM_FREQ);
+  return (uint32_t)(as * BAT_CALIB_REAL_VOLTAGE * 10 / ((int64_t)BAT_CALIB_ADC * 3600));
+}
+
+// Main loop: the counts of both motors since boot
+void energy_read(EnergyTotals motor[2]) {
+  EnergyAcc acc[2];
+  uint32_t seq;
+  do {
+    seq    = energySeq;
+    acc[0] = energyAcc[0];
+    acc[1] = energyAcc[1];
+  } while (seq != energySeq);
+
+  for (uint8_t m = 0; m < 2; m++) {
+    motor[m].usedMah  = energy_mah(acc[m].usedCharge);
+    motor[m].regenMah = energy_mah(acc[m].regenCharge);
+    motor[m].usedMwh  = energy_mwh(acc[m].usedEnergy);
+    motor[m].regenMwh = energy_mwh(acc[m].regenEnergy);
+  }
+}
+
+// Main loop: energyStored plus both motors since boot
+void energy_total(EnergyTotals *total) {
+  EnergyTotals motor[2];
+  energy_read(motor);
+  total->usedMah  = energyStored.usedMah  + motor[0].usedMah  + motor[1].usedMah;
+  total->regenMah = energyStored.regenMah + motor[0].regenMah + motor[1].regenMah;
+  total->usedMwh  = energyStored.usedMwh  + motor[0].usedMwh  + motor[1].usedMwh;
+  total->regenMwh = energyStored.regenMwh + motor[0].regenMwh + motor[1].regenMwh;
+}
+
+#endif
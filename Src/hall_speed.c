@@ -0,0 +1,102 @@
+/*
+ * Hall edge speed and angle estimator, see hall_speed.h.
+ *
+ * hall_speed_edge() runs in the hall EXTI interrupts: a table lookup and a
+ * ring write. hall_speed_update() runs from RAM in the DMA interrupt: a
+ * consistent copy of the ring and two divisions. Only below about 10 rpm,
+ * when a sector takes more than 2^22 ticks, the interpolation shifts a few
+ * times to stay in 32 bits.
+ */
+
+#include <stdint.h>
+#include "defines.h"
+#include "hall_speed.h"
+
+#define SECTOR    (60 << 4)         // one hall sector in deg fixdt(1,16,4)
+#define REV       (360 << 4)
+#define COMPILER_BARRIER() __ASM volatile ("" : : : "memory")
+
+// vec_hallToPos of BLDC_controller_data.c, hall = b_hallA << 2 | b_hallB << 1 | b_hallC
+static const uint8_t hallToPos[8] = {0, 2, 0, 1, 4, 3, 5, 0};
+
+// Called before the first edge, with the current hall state
+void hall_speed_init(HallEdges *e, uint8_t hall) {
+  e->pos   = hallToPos[hall & 7];
+  e->dir   = 0;
+  e->run   = 0;
+  e->idx   = 0;
+  e->edges = 0;
+}
+
+// hall: state after the edge, t: its timestamp
+void hall_speed_edge(HallEdges *e, uint8_t hall, uint32_t t) {
+  uint8_t pos = hallToPos[hall & 7];
+  if (hall == 0 || hall == 7 || pos == e->pos) {
+    return;                                     // invalid state, or a glitch that came back
+  }
+  int8_t step = (int8_t)(pos - e->pos);
+  int8_t dir  = (step == 1 || step == -5) ? 1 : (step == -1 || step == 5) ? -1 : 0;
+  if (dir != 0 && dir == e->dir) {
+    if (e->run < HALL_SPEED_EDGES) {
+      e->run++;
+    }
+  } else {
+    e->run = 0;                                 // reversal or a skipped sector: no sector time yet
+  }
+  e->idx = e->idx < HALL_SPEED_EDGES ? e->idx + 1 : 0;
+  e->time[e->idx] = t;
+  e->pos = pos;
+  e->dir = dir;
+  e->edges++;
+}
+
+/*
+ * now: the current timestamp, timeout: ticks without an edge until the speed is 0.
+ * mechAngle is the electrical angle plus the 30 deg the controller subtracts in
+ * F01_06_Electrical_Angle_Measurement, divided by polePairs. With b_angleMeasEna
+ * the controller then runs on the same angle its own estimation would give, only
+ * interpolated from a better sector time.
+ */
+RAMFUNC void hall_speed_update(const HallEdges *e, uint32_t now, uint32_t timeout, uint8_t polePairs, HallSpeed *out) {
+  uint32_t edges, last, first;
+  uint8_t  pos, run;
+  int8_t   dir;
+  do {                                          // an edge interrupt may preempt and update the ring meanwhile
+    edges = e->edges;
+    COMPILER_BARRIER();                         // the copy stays between the two reads of edges
+    pos   = e->pos;
+    dir   = e->dir;
+    run   = e->run;
+    last  = e->time[e->idx];
+    first = e->time[e->idx >= run ? e->idx - run : e->idx + HALL_SPEED_EDGES + 1 - run];
+    COMPILER_BARRIER();
+  } while (edges != e->edges);
+
+  uint32_t elapsed = now - last;
+  if ((int32_t)elapsed < 0) {
+    elapsed = 0;                                // the edge came after now was taken
+  }
+  int32_t  rpm     = 0;
+  int32_t  frac    = 0;
+  if (run > 0 && elapsed < timeout) {
+    // the mean sector also for the angle, the last one alone would carry the mounting error of its sensors
+    uint32_t sector = (last - first) / run;
+    if (sector < elapsed) {
+      sector = elapsed;                         // overdue: at most one sector since the last edge
+    }
+    // 60 s/min * 16 / (6 sectors * polePairs)
+    rpm = (int32_t)((HALL_TICK_HZ / polePairs * 160U) / sector);
+    rpm = rpm > INT16_MAX ? INT16_MAX : rpm;
+    while (sector >= (1U << 22)) {              // elapsed * SECTOR must fit in 32 bits
+      sector  >>= 1;
+      elapsed >>= 1;
+    }
+    frac = (int32_t)(elapsed * SECTOR / sector);
+  }
+  // sector start as seen in the direction of travel, like the controller
+  int32_t angle = (dir < 0 ? pos + 1 : pos) * SECTOR + (dir < 0 ? -frac : frac);
+  angle %= REV;
+  out->rpm       = (int16_t)(dir < 0 ? -rpm : rpm);
+  out->angle     = (int16_t)angle;
+  out->mechAngle = (int16_t)(((angle + SECTOR / 2) % REV) / polePairs);
+}
@@ -0,0 +1,64 @@
+/*
+ * Cycle profile of the 16 kHz control interrupt, see isr_profile.h.
+ *
+ * isr_profile_end() runs at the end of every profiled period: six stages of
+ * min/max, a window sum, a counter and one histogram bin, roughly 150 cycles
+ * on top of the handler. The window average only needs a shift, no division.
+ * Periods that leave the handler early (ADC offset calibration, overrun) are
+ * not recorded.
+ */
+
+#include <stdint.h>
+#include "stm32f1xx_hal.h"
+#include "config.h"
+#include "isr_profile.h"
+
+#if defined(ISR_PROFILE)
+
+ProfStats isr_prof[PROF_STAGES];
+uint32_t  isr_prof_stamp[PROF_STAGES];
+
+// main(), before the ADC starts the DMA interrupt
+void isr_profile_init(void) {
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;   // DWT needs trace enabled
+  DWT->CYCCNT       = 0;
+  DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
+  for (uint8_t i = 0; i < PROF_STAGES; i++) {
+    isr_prof[i].min = UINT32_MAX;
+  }
+}
+
+static void prof_update(ProfStats *stats, uint32_t cycles) {
+  stats->last = cycles;
+  if (cycles < stats->min) {
+    stats->min = cycles;
+  }
+  if (cycles > stats->max) {
+    stats->max = cycles;
+  }
+  uint32_t bin = cycles >> PROF_HIST_SHIFT;
+  stats->hist[bin < PROF_HIST_BINS ? bin : PROF_HIST_BINS - 1]++;
+  stats->sum += cycles;
+  if ((++stats->count & ((1U << PROF_AVG_SHIFT) - 1)) == 0) {
+    stats->avg = stats->sum >> PROF_AVG_SHIFT;
+    stats->sum = 0;
+  }
+}
+
+// DMA1_Channel1_IRQHandler(), last statement
+void isr_profile_end(void) {
+  uint32_t total = DWT->CYCCNT - isr_prof_stamp[PROF_TOTAL];
+  prof_update(&isr_prof[PROF_TOTAL], total);
+  prof_update(&isr_prof[PROF_LEFT],  isr_prof_stamp[PROF_LEFT]);
+  prof_update(&isr_prof[PROF_RIGHT], isr_prof_stamp[PROF_RIGHT]);
+  prof_update(&isr_prof[PROF_REST],  total - isr_prof_stamp[PROF_LEFT] - isr_prof_stamp[PROF_RIGHT]);
+  prof_update(&isr_prof[PROF_PWM_L], isr_prof_stamp[PROF_PWM_L]);
+  prof_update(&isr_prof[PROF_PWM_R], isr_prof_stamp[PROF_PWM_R]);
+}
+
+// End of a stage outside DMA1_Channel1_IRQHandler(), e.g. PendSV_Handler()
+void isr_profile_record(ProfStage stage) {
+  prof_update(&isr_prof[stage], DWT->CYCCNT - isr_prof_stamp[stage]);
+}
+
+#endif
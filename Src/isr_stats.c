@@ -0,0 +1,114 @@
+/*
+ * Statistics of control loop signals over one telemetry period, see isr_stats.h.
+ *
+ * isr_stats_sample() costs per channel one load, an add, a multiply-accumulate
+ * into 64 bits (SMLAL) and two compares. The first sample of a period
+ * overwrites the bank instead, so isr_stats_take() only has to clear its
+ * period count. The divisions and square roots are left to isr_stats_take().
+ */
+
+#include <stdint.h>
+#include "config.h"
+#include "defines.h"
+#include "BLDC_controller.h"
+#include "isr_stats.h"
+
+#if defined(LIMERO_STATS)
+
+extern int16_t curL_phaA, curL_phaB, curL_DC;
+extern int16_t curR_phaB, curR_phaC, curR_DC;
+extern ExtY rtY_Left;
+extern ExtY rtY_Right;
+extern volatile adc_buf_t adc_buffer;
+
+static const volatile int16_t *const isr_stats_sources[ISR_STATS_COUNT] = {
+  &curL_phaA, &curL_phaB, &curL_DC,
+  &curR_phaB, &curR_phaC, &curR_DC,
+  &rtY_Left.iq, &rtY_Left.id, &rtY_Right.iq, &rtY_Right.id,
+  (const volatile int16_t *)&adc_buffer.batt1,  // 12 bit, fits
+};
+
+typedef struct {
+  int32_t sum;
+  int64_t sq;
+  int16_t min;
+  int16_t max;
+} IsrStatsAcc;
+
+typedef struct {
+  volatile uint32_t periods;  // 0: the next sample starts the bank over
+  IsrStatsAcc       acc[ISR_STATS_COUNT];
+} IsrStatsBank;
+
+static IsrStatsBank isr_stats_bank[2];
+static volatile uint8_t isr_stats_active = 0;   // bank the ISR adds to
+
+// DMA1_Channel1_IRQHandler(), after both controller steps
+RAMFUNC void isr_stats_sample(void) {
+  IsrStatsBank *bank = &isr_stats_bank[isr_stats_active];
+  uint32_t periods = bank->periods;
+  IsrStatsAcc *acc = bank->acc;
+  if (periods == 0) {
+    for (uint8_t i = 0; i < ISR_STATS_COUNT; i++) {
+      int16_t v  = *isr_stats_sources[i];
+      acc[i].sum = v;
+      acc[i].sq  = (int64_t)v * v;
+      acc[i].min = v;
+      acc[i].max = v;
+    }
+  } else if (periods < ISR_STATS_PERIODS_MAX) {
+    for (uint8_t i = 0; i < ISR_STATS_COUNT; i++) {
+      int16_t v   = *isr_stats_sources[i];
+      acc[i].sum += v;
+      acc[i].sq  += (int64_t)v * v;
+      if (v < acc[i].min) {
+        acc[i].min = v;
+      }
+      if (v > acc[i].max) {
+        acc[i].max = v;
+      }
+    }
+  } else {
+    return;                             // telemetry stalled, keep the first ISR_STATS_PERIODS_MAX
+  }
+  bank->periods = periods + 1;
+}
+
+static uint16_t isr_stats_sqrt(uint32_t x) {
+  uint32_t root = 0;
+  for (uint32_t bit = 1UL << 30; bit; bit >>= 2) {
+    if (x >= root + bit) {
+      x    -= root + bit;
+      root  = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+  }
+  return (uint16_t)root;
+}
+
+// Main loop, once per telemetry frame: the statistics since the previous call
+void isr_stats_take(IsrStats *stats) {
+  uint8_t done = isr_stats_active;
+  isr_stats_bank[!done].periods = 0;
+  isr_stats_active = !done;             // from the next period on the ISR leaves bank done alone
+
+  const IsrStatsBank *bank = &isr_stats_bank[done];
+  uint32_t periods = bank->periods;
+  stats->periods = periods;
+  for (uint8_t i = 0; i < ISR_STATS_COUNT; i++) {
+    const IsrStatsAcc *acc = &bank->acc[i];
+    IsrStatsValue *value = &stats->value[i];
+    if (periods == 0) {
+      value->min = value->max = value->mean = 0;
+      value->rms = 0;
+      continue;
+    }
+    value->min  = acc->min;
+    value->max  = acc->max;
+    value->mean = (int16_t)(acc->sum / (int32_t)periods);
+    value->rms  = isr_stats_sqrt((uint32_t)((uint64_t)acc->sq / periods));
+  }
+}
+
+#endif
@@ -0,0 +1,66 @@
+#include <limero/batch.h>
+
+BatchWriter::BatchWriter(size_t scratch_size) : _scratch(scratch_size)
+{
+}
+
+void BatchWriter::clear()
+{
+    _msg_types.clear();
+    _payloads.clear();
+}
+
+int BatchWriter::add(const Msg &msg)
+{
+    int rc = msg.encode(_scratch);
+    if (rc != 0)
+    {
+        return rc;
+    }
+    _msg_types.push_back(msg.msg_id());
+    _payloads.insert(_payloads.end(), _scratch.data(), _scratch.data() + _scratch.size());
+    return 0;
+}
+
+int BatchWriter::encode(uint32_t src, Buffer &buffer)
+{
+    if (_msg_types.size() == 1)
+    {
+        _single.src = src;
+        _single.msg_type = _msg_types[0];
+        _single.payload = _payloads;
+        return _single.encode(buffer);
+    }
+    _batch.src = src;
+    _batch.msg_types = _msg_types;
+    _batch.payloads = _payloads;
+    return _batch.encode(buffer);
+}
+
+// Every payload is one self-delimiting CBOR map, so the parser finds the
+// boundaries without a length table.
+int batch_for_each(const BatchEnvelope &batch, std::function<void(uint32_t, const Buffer &)> handler)
+{
+    if (!batch.msg_types || !batch.payloads)
+    {
+        return EINVAL;
+    }
+    const std::vector<uint8_t> &payloads = *batch.payloads;
+    const uint8_t *ptr = payloads.data();
+    const uint8_t *end = ptr + payloads.size();
+    for (uint32_t msg_type : *batch.msg_types)
+    {
+        CborParser parser;
+        CborValue it;
+        if (ptr >= end || cbor_parser_init(ptr, end - ptr, 0, &parser, &it) != CborNoError ||
+            cbor_value_advance(&it) != CborNoError)
+        {
+            return EINVAL;
+        }
+        const uint8_t *next = cbor_value_get_next_byte(&it);
+        Buffer payload((uint8_t *)ptr, next - ptr, next - ptr);
+        handler(msg_type, payload);
+        ptr = next;
+    }
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include <limero/column_pack.h>
+
+ColumnPacker::ColumnPacker(uint8_t channels, size_t column_capacity, const uint8_t *shifts)
+    : _channels(channels), _column_capacity(column_capacity), _data(channels * column_capacity),
+      _length(channels), _prev(channels), _shifts(shifts, shifts + channels), _rows(0)
+{
+}
+
+void ColumnPacker::clear()
+{
+    for (uint8_t c = 0; c < _channels; c++)
+    {
+        _length[c] = 0;
+        _prev[c] = 0;
+    }
+    _rows = 0;
+}
+
+bool ColumnPacker::add(const int32_t *row)
+{
+    for (uint8_t c = 0; c < _channels; c++)
+    {
+        if (_length[c] + VARINT_MAX > _column_capacity)
+        {
+            return false;
+        }
+    }
+    for (uint8_t c = 0; c < _channels; c++)
+    {
+        int32_t value = row[c] >> _shifts[c];
+        int32_t delta = (int32_t)((uint32_t)value - (uint32_t)_prev[c]);
+        _prev[c] = value;
+        uint32_t zigzag = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+        uint8_t *out = &_data[c * _column_capacity + _length[c]];
+        uint8_t n = 0;
+        while (zigzag >= 0x80)
+        {
+            out[n++] = (uint8_t)(zigzag | 0x80);
+            zigzag >>= 7;
+        }
+        out[n++] = (uint8_t)zigzag;
+        _length[c] += n;
+    }
+    _rows++;
+    return true;
+}
+
+void ColumnPacker::pack(std::vector<uint8_t> &columns) const
+{
+    columns.clear();
+    for (uint8_t c = 0; c < _channels; c++)
+    {
+        const uint8_t *column = &_data[c * _column_capacity];
+        columns.insert(columns.end(), column, column + _length[c]);
+    }
+}
+
+size_t column_unpack(const uint8_t *data, size_t size, uint8_t channels, uint32_t rows,
+                     const uint8_t *shifts, int32_t *values)
+{
+    size_t pos = 0;
+    for (uint8_t c = 0; c < channels; c++)
+    {
+        uint32_t value = 0;
+        for (uint32_t r = 0; r < rows; r++)
+        {
+            uint32_t zigzag = 0;
+            for (uint8_t bits = 0;; bits += 7)
+            {
+                if (pos == size || bits >= 35)
+                {
+                    return 0;
+                }
+                uint8_t byte = data[pos++];
+                zigzag |= (uint32_t)(byte & 0x7F) << bits;
+                if (!(byte & 0x80))
+                {
+                    break;
+                }
+            }
+            value += (zigzag >> 1) ^ (0U - (zigzag & 1));
+            values[r * channels + c] = (int32_t)(value << shifts[c]);
+        }
+    }
+    return pos;
+}
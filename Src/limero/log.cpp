@@ -60,11 +60,8 @@ void Log::serialLog(char* start, uint32_t length) {
 }
 
 Log::Log(uint32_t size)
-    : _enabled(true), _logFunction(serialLog), _hostname("stm32"), _application("hoverboard"), _level(LOG_INFO) {
-    if (_line == 0) {
-        _line = new std::string;
-        _line->reserve(size);
-    }
+    : _line(new std::string), _enabled(true), _logFunction(serialLog), _hostname("stm32"), _application("hoverboard"), _level(LOG_INFO) {
+    _line->reserve(size);
 }
 
 Log::~Log() {}
@@ -1,5 +1,6 @@
 // Auto-generated from robot.hcl — do not edit by hand.
 // Source file — method implementations for generated messages.
+// Each message is wrapped in `#if LIMERO_MSG(Name)` so an endpoint profile can leave it out.
 // Messages are encoded as CBOR maps keyed by field id.
 // Uses TinyCBOR for CBOR encoding/decoding.
 #include "limero/msgs.h"
@@ -7,28 +8,72 @@
 // ── Name lookup tables ─────────────────────────────────────────────────────
 
 std::unordered_map<uint32_t, const char*> id_to_name = {
+#if LIMERO_MSG(BrokerSubscribeRequest)
     { 3190208493, "BrokerSubscribeRequest" },
+#endif
+#if LIMERO_MSG(CompassEvent)
     { 3197332525, "CompassEvent" },
+#endif
+#if LIMERO_MSG(DeviceAliveEvent)
     { 2637772092, "DeviceAliveEvent" },
+#endif
+#if LIMERO_MSG(EndpointAnnounce)
     { 2371693343, "EndpointAnnounce" },
+#endif
+#if LIMERO_MSG(EndpointAnnounceReply)
     { 3238220441, "EndpointAnnounceReply" },
+#endif
+#if LIMERO_MSG(Envelope)
     { 1228864117, "Envelope" },
+#endif
+#if LIMERO_MSG(GenericReply)
     { 2578784998, "GenericReply" },
+#endif
+#if LIMERO_MSG(HeatingEvent)
     { 461737375, "HeatingEvent" },
+#endif
+#if LIMERO_MSG(HeatingRequest)
     { 578653874, "HeatingRequest" },
+#endif
+#if LIMERO_MSG(HoverboardEvent)
     { 104988481, "HoverboardEvent" },
+#endif
+#if LIMERO_MSG(HoverboardRequest)
     { 2735870956, "HoverboardRequest" },
+#endif
+#if LIMERO_MSG(ImuEvent)
     { 1802836182, "ImuEvent" },
+#endif
+#if LIMERO_MSG(Max31855Event)
     { 2831607083, "Max31855Event" },
+#endif
+#if LIMERO_MSG(PingReply)
     { 1594103907, "PingReply" },
+#endif
+#if LIMERO_MSG(PingRequest)
     { 31253678, "PingRequest" },
+#endif
+#if LIMERO_MSG(Ps4Event)
     { 4282593576, "Ps4Event" },
+#endif
+#if LIMERO_MSG(Ps4Request)
     { 1992038561, "Ps4Request" },
+#endif
+#if LIMERO_MSG(SysEvent)
     { 924742914, "SysEvent" },
+#endif
+#if LIMERO_MSG(SysReply)
     { 2952492394, "SysReply" },
+#endif
+#if LIMERO_MSG(SysRequest)
     { 2966412411, "SysRequest" },
+#endif
+#if LIMERO_MSG(UsEvent)
     { 1082063571, "UsEvent" },
+#endif
+#if LIMERO_MSG(WifiEvent)
     { 3371536624, "WifiEvent" },
+#endif
     { 2490238132, "broker" },
     { 2753264687, "compass" },
     { 1152836275, "hoverboard" },
@@ -54,6 +99,7 @@ const char *id_to_string(uint32_t msg_id)
 
 
 
+#if LIMERO_MSG(BrokerSubscribeRequest)
 int BrokerSubscribeRequest::encode(Buffer& buffer) const {
     buffer.clear();
     CborEncoder encoder;
@@ -142,9 +188,11 @@ int BrokerSubscribeRequest::decode(const Buffer& buffer) {
     cbor_value_leave_container(&it, &mapValue);
     return 0;
 }
+#endif
 
 
 
+#if LIMERO_MSG(CompassEvent)
 int CompassEvent::encode(Buffer& buffer) const {
     buffer.clear();
     CborEncoder encoder;
@@ -388,9 +436,11 @@ int CompassEvent::decode(const Buffer& buffer) {
     cbor_value_leave_container(&it, &mapValue);
     return 0;
 }
+#endif
 
 
 
+#if LIMERO_MSG(DeviceAliveEvent)
 int DeviceAliveEvent::encode(Buffer& buffer) const {
     buffer.clear();
     CborEncoder encoder;
@@ -494,9 +544,11 @@ int DeviceAliveEvent::decode(const Buffer& buffer) {
     cbor_value_leave_container(&it, &mapValue);
     return 0;
 }
+#endif
 
 
 
+#if LIMERO_MSG(EndpointAnnounce)
 int EndpointAnnounce::encode(Buffer& buffer) const {
     buffer.clear();
     CborEncoder encoder;
@@ -736,9 +788,11 @@ int EndpointAnnounce::decode(const Buffer& buffer) {
     cbor_value_leave_container(&it, &mapValue);
     return 0;
 }
+#endif
 
 
 
+#if LIMERO_MSG(EndpointAnnounceReply)
 int EndpointAnnounceReply::encode(Buffer& buffer) const {
     buffer.clear();
     CborEncoder encoder;
@@ -810,9 +864,11 @@ int EndpointAnnounceReply::decode(const Buffer& buffer) {
     cbor_value_leave_container(&it, &mapValue);
     return 0;
 }
+#endif
 
 
 
+#if LIMERO_MSG(Envelope)
 int Envelope::encode(Buffer& buffer) const {
     buffer.clear();
     CborEncoder encoder;
@@ -967,9 +1023,11 @@ int Envelope::decode(const Buffer& buffer) {
     cbor_value_leave_container(&it, &mapValue);
     return 0;
 }
+#endif
 
 
 
+#if LIMERO_MSG(GenericReply)
 int GenericReply::encode(Buffer& buffer) const {
     buffer.clear();
     CborEncoder encoder;
@@ -1091,9 +1149,11 @@ int GenericReply::decode(const Buffer& buffer) {
     cbor_value_leave_container(&it, &mapValue);
     return 0;
 }
+#endif
 
 
 
+#if LIMERO_MSG(HeatingEvent)
 int HeatingEvent::encode(Buffer& buffer) const {
     buffer.clear();
     CborEncoder encoder;
@@ -1267,9 +1327,11 @@ int HeatingEvent::decode(const Buffer& buffer) {
     cbor_value_leave_container(&it, &mapValue);
     return 0;
 }
+#endif
 
 
 
+#if LIMERO_MSG(HeatingRequest)
 int HeatingRequest::encode(Buffer& buffer) const {
     buffer.clear();
     CborEncoder encoder;
@@ -1434,9 +1496,11 @@ int HeatingRequest::decode(const Buffer& buffer) {
     cbor_value_leave_container(&it, &mapValue);
     return 0;
 }
+#endif
 
 
 
+#if LIMERO_MSG(HoverboardEvent)
 int HoverboardEvent::encode(Buffer& buffer) const {
     buffer.clear();
     CborEncoder encoder;
@@ -2273,9 +2337,11 @@ int HoverboardEvent::decode(const Buffer& buffer) {
     cbor_value_leave_container(&it, &mapValue);
     return 0;
 }
+#endif
 
 
 
+#if LIMERO_MSG(HoverboardRequest)
 int HoverboardRequest::encode(Buffer& buffer) const {
     buffer.clear();
     CborEncoder encoder;
@@ -2381,9 +2447,11 @@ int HoverboardRequest::decode(const Buffer& buffer) {
     cbor_value_leave_container(&it, &mapValue);
     return 0;
 }
+#endif
 
 
 
+#if LIMERO_MSG(ImuEvent)
 int ImuEvent::encode(Buffer& buffer) const {
     buffer.clear();
     CborEncoder encoder;
@@ -2564,9 +2632,11 @@ int ImuEvent::decode(const Buffer& buffer) {
     cbor_value_leave_container(&it, &mapValue);
     return 0;
 }
+#endif
 
 
 
+#if LIMERO_MSG(Max31855Event)
 int Max31855Event::encode(Buffer& buffer) const {
     buffer.clear();
     CborEncoder encoder;
@@ -2715,9 +2785,11 @@ int Max31855Event::decode(const Buffer& buffer) {
     cbor_value_leave_container(&it, &mapValue);
     return 0;
 }
+#endif
 
 
 
+#if LIMERO_MSG(PingReply)
 int PingReply::encode(Buffer& buffer) const {
     buffer.clear();
     CborEncoder encoder;
@@ -2806,9 +2878,11 @@ int PingReply::decode(const Buffer& buffer) {
     cbor_value_leave_container(&it, &mapValue);
     return 0;
 }
+#endif
 
 
 
+#if LIMERO_MSG(PingRequest)
 int PingRequest::encode(Buffer& buffer) const {
     buffer.clear();
     CborEncoder encoder;
@@ -2897,9 +2971,11 @@ int PingRequest::decode(const Buffer& buffer) {
     cbor_value_leave_container(&it, &mapValue);
     return 0;
 }
+#endif
 
 
 
+#if LIMERO_MSG(Ps4Event)
 int Ps4Event::encode(Buffer& buffer) const {
     buffer.clear();
     CborEncoder encoder;
@@ -3434,9 +3510,11 @@ int Ps4Event::decode(const Buffer& buffer) {
     cbor_value_leave_container(&it, &mapValue);
     return 0;
 }
+#endif
 
 
 
+#if LIMERO_MSG(Ps4Request)
 int Ps4Request::encode(Buffer& buffer) const {
     buffer.clear();
     CborEncoder encoder;
@@ -3627,9 +3705,11 @@ int Ps4Request::decode(const Buffer& buffer) {
     cbor_value_leave_container(&it, &mapValue);
     return 0;
 }
+#endif
 
 
 
+#if LIMERO_MSG(SysEvent)
 int SysEvent::encode(Buffer& buffer) const {
     buffer.clear();
     CborEncoder encoder;
@@ -3784,9 +3864,11 @@ int SysEvent::decode(const Buffer& buffer) {
     cbor_value_leave_container(&it, &mapValue);
     return 0;
 }
+#endif
 
 
 
+#if LIMERO_MSG(SysReply)
 int SysReply::encode(Buffer& buffer) const {
     buffer.clear();
     CborEncoder encoder;
@@ -3891,9 +3973,11 @@ int SysReply::decode(const Buffer& buffer) {
     cbor_value_leave_container(&it, &mapValue);
     return 0;
 }
+#endif
 
 
 
+#if LIMERO_MSG(SysRequest)
 int SysRequest::encode(Buffer& buffer) const {
     buffer.clear();
     CborEncoder encoder;
@@ -4011,9 +4095,11 @@ int SysRequest::decode(const Buffer& buffer) {
     cbor_value_leave_container(&it, &mapValue);
     return 0;
 }
+#endif
 
 
 
+#if LIMERO_MSG(UsEvent)
 int UsEvent::encode(Buffer& buffer) const {
     buffer.clear();
     CborEncoder encoder;
@@ -4127,9 +4213,11 @@ int UsEvent::decode(const Buffer& buffer) {
     cbor_value_leave_container(&it, &mapValue);
     return 0;
 }
+#endif
 
 
 
+#if LIMERO_MSG(WifiEvent)
 int WifiEvent::encode(Buffer& buffer) const {
     buffer.clear();
     CborEncoder encoder;
@@ -4314,5 +4402,6 @@ int WifiEvent::decode(const Buffer& buffer) {
     cbor_value_leave_container(&it, &mapValue);
     return 0;
 }
+#endif
 
 
@@ -0,0 +1,2769 @@
+// Hoverboard messages, see msgs_hoverboard.h. Same encoding as the generated
+// msgs.cpp: CBOR maps keyed by field id. Array fields continue the key loop
+// after cbor_value_leave_container(), which already stepped past the array.
+#include "limero/msgs_hoverboard.h"
+
+int BatchEnvelope::encode(Buffer& buffer) const {
+    buffer.clear();
+    CborEncoder encoder;
+    cbor_encoder_init(&encoder,buffer.data(),buffer.capacity(),0);
+    // Count how many optional fields are set.
+    uint32_t fieldCount = 0;
+    if (src.is_some()) { fieldCount++; }
+    if (dst.is_some()) { fieldCount++; }
+    if (msg_types.is_some()) { fieldCount++; }
+    if (payloads.is_some()) { fieldCount++; }
+
+    CborEncoder mapEncoder;
+    cbor_check(cbor_encoder_create_map(&encoder, &mapEncoder, fieldCount));
+    if ( src) {
+        const auto& value = *src;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::SRC));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( dst) {
+        const auto& value = *dst;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::DST));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( msg_types) {
+        const auto& value = *msg_types;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::MSG_TYPES));
+        {
+            CborEncoder arrEncoder;
+            cbor_check(cbor_encoder_create_array(&mapEncoder, &arrEncoder, value.size()));
+            for (const auto& item : value) {
+                cbor_check(cbor_encode_uint(&arrEncoder, item));
+            }
+            cbor_check(cbor_encoder_close_container(&mapEncoder, &arrEncoder));
+        }
+    };
+    if ( payloads) {
+        const auto& value = *payloads;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::PAYLOADS));
+        cbor_check(cbor_encode_byte_string(&mapEncoder, value.data(), value.size()));
+    };
+
+     cbor_check(cbor_encoder_close_container(&encoder, &mapEncoder));
+    buffer.resize(cbor_encoder_get_buffer_size(&encoder, buffer.data()));
+     return 0;
+}
+
+int BatchEnvelope::decode(const Buffer& buffer) {
+    CborParser parser;
+    CborValue it;
+    cbor_check(cbor_parser_init(buffer.data(), buffer.size(), 0, &parser, &it));
+    if (!cbor_value_is_map(&it)) {
+        WARN("Expected CBOR map ");
+        return EINVAL;
+    }
+
+    CborValue mapValue;
+    cbor_value_enter_container(&it, &mapValue);
+
+    while (!cbor_value_at_end(&mapValue)) {
+        // Read the map key (must be an unsigned integer — field id).
+        if (!cbor_value_is_unsigned_integer(&mapValue)) {
+            // Skip unknown key type and its value.
+            cbor_value_advance(&mapValue);  // skip key
+            if (!cbor_value_at_end(&mapValue)) {
+                cbor_value_advance(&mapValue);  // skip value
+            }
+            continue;
+        }
+
+        uint64_t keyVal;
+        cbor_value_get_uint64(&mapValue, &keyVal);
+        cbor_value_advance(&mapValue);  // advance to value
+
+        switch ((uint32_t)keyVal) {
+            case BatchEnvelope::FieldId::SRC:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    src = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    src = ((uint32_t)val);
+                }
+                break;
+            case BatchEnvelope::FieldId::DST:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    dst = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    dst = ((uint32_t)val);
+                }
+                break;
+            case BatchEnvelope::FieldId::MSG_TYPES:
+                if (cbor_value_is_array(&mapValue)) {
+                    CborValue arrValue;
+                    cbor_value_enter_container(&mapValue, &arrValue);
+                    std::vector<uint32_t> val;
+                    while (!cbor_value_at_end(&arrValue)) {
+                        if (cbor_value_is_unsigned_integer(&arrValue)) {
+                            uint64_t v;
+                            cbor_value_get_uint64(&arrValue, &v);
+                            val.push_back((uint32_t)v);
+                        } else if (cbor_value_is_negative_integer(&arrValue)) {
+                            int64_t v;
+                            cbor_value_get_int64(&arrValue, &v);
+                            val.push_back((uint32_t)v);
+                        }
+                        cbor_value_advance(&arrValue);
+                    }
+                    cbor_value_leave_container(&mapValue, &arrValue);
+                    msg_types = (val);
+                    continue;  // leave_container already stepped past the array
+                }
+                break;
+            case BatchEnvelope::FieldId::PAYLOADS:
+                if (cbor_value_is_byte_string(&mapValue)) {
+                    size_t len;
+                    cbor_value_get_string_length(&mapValue, &len);
+                    std::vector<uint8_t> val(len);
+                    cbor_value_copy_byte_string(&mapValue, val.data(), &len, NULL);
+                    payloads = (val);
+                }
+                break;
+            default:
+                // Unknown field id — skip value.
+                break;
+        }
+
+        cbor_value_advance(&mapValue);  // advance past value to next key (or end)
+    }
+
+    cbor_value_leave_container(&it, &mapValue);
+    return 0;
+}
+
+int EnergyEvent::encode(Buffer& buffer) const {
+    buffer.clear();
+    CborEncoder encoder;
+    cbor_encoder_init(&encoder,buffer.data(),buffer.capacity(),0);
+    // Count how many optional fields are set.
+    uint32_t fieldCount = 0;
+    if (left_used_mah.is_some()) { fieldCount++; }
+    if (left_regen_mah.is_some()) { fieldCount++; }
+    if (left_used_mwh.is_some()) { fieldCount++; }
+    if (left_regen_mwh.is_some()) { fieldCount++; }
+    if (right_used_mah.is_some()) { fieldCount++; }
+    if (right_regen_mah.is_some()) { fieldCount++; }
+    if (right_used_mwh.is_some()) { fieldCount++; }
+    if (right_regen_mwh.is_some()) { fieldCount++; }
+    if (total_used_mah.is_some()) { fieldCount++; }
+    if (total_regen_mah.is_some()) { fieldCount++; }
+    if (total_used_mwh.is_some()) { fieldCount++; }
+    if (total_regen_mwh.is_some()) { fieldCount++; }
+
+    CborEncoder mapEncoder;
+    cbor_check(cbor_encoder_create_map(&encoder, &mapEncoder, fieldCount));
+    if ( left_used_mah) {
+        const auto& value = *left_used_mah;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::LEFT_USED_MAH));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( left_regen_mah) {
+        const auto& value = *left_regen_mah;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::LEFT_REGEN_MAH));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( left_used_mwh) {
+        const auto& value = *left_used_mwh;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::LEFT_USED_MWH));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( left_regen_mwh) {
+        const auto& value = *left_regen_mwh;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::LEFT_REGEN_MWH));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( right_used_mah) {
+        const auto& value = *right_used_mah;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::RIGHT_USED_MAH));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( right_regen_mah) {
+        const auto& value = *right_regen_mah;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::RIGHT_REGEN_MAH));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( right_used_mwh) {
+        const auto& value = *right_used_mwh;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::RIGHT_USED_MWH));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( right_regen_mwh) {
+        const auto& value = *right_regen_mwh;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::RIGHT_REGEN_MWH));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( total_used_mah) {
+        const auto& value = *total_used_mah;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::TOTAL_USED_MAH));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( total_regen_mah) {
+        const auto& value = *total_regen_mah;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::TOTAL_REGEN_MAH));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( total_used_mwh) {
+        const auto& value = *total_used_mwh;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::TOTAL_USED_MWH));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( total_regen_mwh) {
+        const auto& value = *total_regen_mwh;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::TOTAL_REGEN_MWH));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+
+     cbor_check(cbor_encoder_close_container(&encoder, &mapEncoder));
+    buffer.resize(cbor_encoder_get_buffer_size(&encoder, buffer.data()));
+     return 0;
+}
+
+int EnergyEvent::decode(const Buffer& buffer) {
+    CborParser parser;
+    CborValue it;
+    cbor_check(cbor_parser_init(buffer.data(), buffer.size(), 0, &parser, &it));
+    if (!cbor_value_is_map(&it)) {
+        WARN("Expected CBOR map ");
+        return EINVAL;
+    }
+
+    CborValue mapValue;
+    cbor_value_enter_container(&it, &mapValue);
+
+    while (!cbor_value_at_end(&mapValue)) {
+        // Read the map key (must be an unsigned integer — field id).
+        if (!cbor_value_is_unsigned_integer(&mapValue)) {
+            // Skip unknown key type and its value.
+            cbor_value_advance(&mapValue);  // skip key
+            if (!cbor_value_at_end(&mapValue)) {
+                cbor_value_advance(&mapValue);  // skip value
+            }
+            continue;
+        }
+
+        uint64_t keyVal;
+        cbor_value_get_uint64(&mapValue, &keyVal);
+        cbor_value_advance(&mapValue);  // advance to value
+
+        switch ((uint32_t)keyVal) {
+            case EnergyEvent::FieldId::LEFT_USED_MAH:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    left_used_mah = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    left_used_mah = ((uint32_t)val);
+                }
+                break;
+            case EnergyEvent::FieldId::LEFT_REGEN_MAH:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    left_regen_mah = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    left_regen_mah = ((uint32_t)val);
+                }
+                break;
+            case EnergyEvent::FieldId::LEFT_USED_MWH:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    left_used_mwh = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    left_used_mwh = ((uint32_t)val);
+                }
+                break;
+            case EnergyEvent::FieldId::LEFT_REGEN_MWH:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    left_regen_mwh = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    left_regen_mwh = ((uint32_t)val);
+                }
+                break;
+            case EnergyEvent::FieldId::RIGHT_USED_MAH:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    right_used_mah = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    right_used_mah = ((uint32_t)val);
+                }
+                break;
+            case EnergyEvent::FieldId::RIGHT_REGEN_MAH:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    right_regen_mah = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    right_regen_mah = ((uint32_t)val);
+                }
+                break;
+            case EnergyEvent::FieldId::RIGHT_USED_MWH:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    right_used_mwh = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    right_used_mwh = ((uint32_t)val);
+                }
+                break;
+            case EnergyEvent::FieldId::RIGHT_REGEN_MWH:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    right_regen_mwh = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    right_regen_mwh = ((uint32_t)val);
+                }
+                break;
+            case EnergyEvent::FieldId::TOTAL_USED_MAH:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    total_used_mah = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    total_used_mah = ((uint32_t)val);
+                }
+                break;
+            case EnergyEvent::FieldId::TOTAL_REGEN_MAH:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    total_regen_mah = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    total_regen_mah = ((uint32_t)val);
+                }
+                break;
+            case EnergyEvent::FieldId::TOTAL_USED_MWH:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    total_used_mwh = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    total_used_mwh = ((uint32_t)val);
+                }
+                break;
+            case EnergyEvent::FieldId::TOTAL_REGEN_MWH:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    total_regen_mwh = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    total_regen_mwh = ((uint32_t)val);
+                }
+                break;
+            default:
+                // Unknown field id — skip value.
+                break;
+        }
+
+        cbor_value_advance(&mapValue);  // advance past value to next key (or end)
+    }
+
+    cbor_value_leave_container(&it, &mapValue);
+    return 0;
+}
+
+int GenericReply::encode(Buffer& buffer) const {
+    buffer.clear();
+    CborEncoder encoder;
+    cbor_encoder_init(&encoder,buffer.data(),buffer.capacity(),0);
+    // Count how many optional fields are set.
+    uint32_t fieldCount = 0;
+    if (req_id.is_some()) { fieldCount++; }
+    if (error_code.is_some()) { fieldCount++; }
+    if (message.is_some()) { fieldCount++; }
+    if (msg_type.is_some()) { fieldCount++; }
+    if (tick.is_some()) { fieldCount++; }
+
+    CborEncoder mapEncoder;
+    cbor_check(cbor_encoder_create_map(&encoder, &mapEncoder, fieldCount));
+    if ( req_id) {
+        const auto& value = *req_id;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::REQ_ID));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( error_code) {
+        const auto& value = *error_code;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::ERROR_CODE));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( message) {
+        const auto& value = *message;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::MESSAGE));
+        cbor_check(cbor_encode_text_string(&mapEncoder, value.c_str(), value.length()));
+    };
+    if ( msg_type) {
+        const auto& value = *msg_type;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::MSG_TYPE));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( tick) {
+        const auto& value = *tick;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::TICK));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+
+     cbor_check(cbor_encoder_close_container(&encoder, &mapEncoder));
+    buffer.resize(cbor_encoder_get_buffer_size(&encoder, buffer.data()));
+     return 0;
+}
+
+int GenericReply::decode(const Buffer& buffer) {
+    CborParser parser;
+    CborValue it;
+    cbor_check(cbor_parser_init(buffer.data(), buffer.size(), 0, &parser, &it));
+    if (!cbor_value_is_map(&it)) {
+        WARN("Expected CBOR map ");
+        return EINVAL;
+    }
+
+    CborValue mapValue;
+    cbor_value_enter_container(&it, &mapValue);
+
+    while (!cbor_value_at_end(&mapValue)) {
+        // Read the map key (must be an unsigned integer — field id).
+        if (!cbor_value_is_unsigned_integer(&mapValue)) {
+            // Skip unknown key type and its value.
+            cbor_value_advance(&mapValue);  // skip key
+            if (!cbor_value_at_end(&mapValue)) {
+                cbor_value_advance(&mapValue);  // skip value
+            }
+            continue;
+        }
+
+        uint64_t keyVal;
+        cbor_value_get_uint64(&mapValue, &keyVal);
+        cbor_value_advance(&mapValue);  // advance to value
+
+        switch ((uint32_t)keyVal) {
+            case GenericReply::FieldId::REQ_ID:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    req_id = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    req_id = ((uint32_t)val);
+                }
+                break;
+            case GenericReply::FieldId::ERROR_CODE:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    error_code = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    error_code = ((uint32_t)val);
+                }
+                break;
+            case GenericReply::FieldId::MESSAGE:
+                if (cbor_value_is_text_string(&mapValue)) {
+                    size_t len;
+                    cbor_value_get_string_length(&mapValue, &len);
+                    std::string val(len, '\0');
+                    cbor_value_copy_text_string(&mapValue, &val[0], &len, NULL);
+                    val.resize(len);
+                    message = (val);
+                }
+                break;
+            case GenericReply::FieldId::MSG_TYPE:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    msg_type = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    msg_type = ((uint32_t)val);
+                }
+                break;
+            case GenericReply::FieldId::TICK:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    tick = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    tick = ((uint32_t)val);
+                }
+                break;
+            default:
+                // Unknown field id — skip value.
+                break;
+        }
+
+        cbor_value_advance(&mapValue);  // advance past value to next key (or end)
+    }
+
+    cbor_value_leave_container(&it, &mapValue);
+    return 0;
+}
+
+int HoverboardEvent::encode(Buffer& buffer) const {
+    buffer.clear();
+    CborEncoder encoder;
+    cbor_encoder_init(&encoder,buffer.data(),buffer.capacity(),0);
+    // Count how many optional fields are set.
+    uint32_t fieldCount = 0;
+    if (ctrl_mod.is_some()) { fieldCount++; }
+    if (ctrl_typ.is_some()) { fieldCount++; }
+    if (cur_mot_max.is_some()) { fieldCount++; }
+    if (rpm_mot_max.is_some()) { fieldCount++; }
+    if (fi_weak_ena.is_some()) { fieldCount++; }
+    if (fi_weak_hi.is_some()) { fieldCount++; }
+    if (fi_weak_lo.is_some()) { fieldCount++; }
+    if (fi_weak_max.is_some()) { fieldCount++; }
+    if (phase_adv_max_deg.is_some()) { fieldCount++; }
+    if (input1_raw.is_some()) { fieldCount++; }
+    if (input1_typ.is_some()) { fieldCount++; }
+    if (input1_min.is_some()) { fieldCount++; }
+    if (input1_mid.is_some()) { fieldCount++; }
+    if (input1_max.is_some()) { fieldCount++; }
+    if (input1_cmd.is_some()) { fieldCount++; }
+    if (input2_raw.is_some()) { fieldCount++; }
+    if (input2_typ.is_some()) { fieldCount++; }
+    if (input2_min.is_some()) { fieldCount++; }
+    if (input2_mid.is_some()) { fieldCount++; }
+    if (input2_max.is_some()) { fieldCount++; }
+    if (input2_cmd.is_some()) { fieldCount++; }
+    if (aux_input1_raw.is_some()) { fieldCount++; }
+    if (aux_input1_typ.is_some()) { fieldCount++; }
+    if (aux_input1_min.is_some()) { fieldCount++; }
+    if (aux_input1_mid.is_some()) { fieldCount++; }
+    if (aux_input1_max.is_some()) { fieldCount++; }
+    if (aux_input1_cmd.is_some()) { fieldCount++; }
+    if (aux_input2_raw.is_some()) { fieldCount++; }
+    if (aux_input2_typ.is_some()) { fieldCount++; }
+    if (aux_input2_min.is_some()) { fieldCount++; }
+    if (aux_input2_mid.is_some()) { fieldCount++; }
+    if (aux_input2_max.is_some()) { fieldCount++; }
+    if (aux_input2_cmd.is_some()) { fieldCount++; }
+    if (dc_curr.is_some()) { fieldCount++; }
+    if (rdc_curr.is_some()) { fieldCount++; }
+    if (ldc_curr.is_some()) { fieldCount++; }
+    if (cmdl.is_some()) { fieldCount++; }
+    if (cmdr.is_some()) { fieldCount++; }
+    if (spd_avg.is_some()) { fieldCount++; }
+    if (spdl.is_some()) { fieldCount++; }
+    if (spdr.is_some()) { fieldCount++; }
+    if (filter_rate.is_some()) { fieldCount++; }
+    if (spd_coef.is_some()) { fieldCount++; }
+    if (str_coef.is_some()) { fieldCount++; }
+    if (batv.is_some()) { fieldCount++; }
+    if (temp.is_some()) { fieldCount++; }
+    if (req_gaps.is_some()) { fieldCount++; }
+    if (req_superseded.is_some()) { fieldCount++; }
+    if (time_us.is_some()) { fieldCount++; }
+    if (overruns.is_some()) { fieldCount++; }
+    if (overrun_run_max.is_some()) { fieldCount++; }
+    if (overrun_err.is_some()) { fieldCount++; }
+    if (offset_drift.is_some()) { fieldCount++; }
+    if (offset_track_ms.is_some()) { fieldCount++; }
+    if (boot_ms.is_some()) { fieldCount++; }
+    if (offsets_stored.is_some()) { fieldCount++; }
+    if (hall_rpm_l.is_some()) { fieldCount++; }
+    if (hall_rpm_r.is_some()) { fieldCount++; }
+    if (isr_stats_periods.is_some()) { fieldCount++; }
+    if (isr_stats.is_some()) { fieldCount++; }
+
+    CborEncoder mapEncoder;
+    cbor_check(cbor_encoder_create_map(&encoder, &mapEncoder, fieldCount));
+    if ( ctrl_mod) {
+        const auto& value = *ctrl_mod;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::CTRL_MOD));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( ctrl_typ) {
+        const auto& value = *ctrl_typ;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::CTRL_TYP));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( cur_mot_max) {
+        const auto& value = *cur_mot_max;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::CUR_MOT_MAX));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( rpm_mot_max) {
+        const auto& value = *rpm_mot_max;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::RPM_MOT_MAX));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( fi_weak_ena) {
+        const auto& value = *fi_weak_ena;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::FI_WEAK_ENA));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( fi_weak_hi) {
+        const auto& value = *fi_weak_hi;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::FI_WEAK_HI));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( fi_weak_lo) {
+        const auto& value = *fi_weak_lo;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::FI_WEAK_LO));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( fi_weak_max) {
+        const auto& value = *fi_weak_max;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::FI_WEAK_MAX));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( phase_adv_max_deg) {
+        const auto& value = *phase_adv_max_deg;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::PHASE_ADV_MAX_DEG));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( input1_raw) {
+        const auto& value = *input1_raw;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::INPUT1_RAW));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( input1_typ) {
+        const auto& value = *input1_typ;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::INPUT1_TYP));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( input1_min) {
+        const auto& value = *input1_min;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::INPUT1_MIN));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( input1_mid) {
+        const auto& value = *input1_mid;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::INPUT1_MID));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( input1_max) {
+        const auto& value = *input1_max;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::INPUT1_MAX));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( input1_cmd) {
+        const auto& value = *input1_cmd;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::INPUT1_CMD));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( input2_raw) {
+        const auto& value = *input2_raw;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::INPUT2_RAW));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( input2_typ) {
+        const auto& value = *input2_typ;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::INPUT2_TYP));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( input2_min) {
+        const auto& value = *input2_min;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::INPUT2_MIN));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( input2_mid) {
+        const auto& value = *input2_mid;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::INPUT2_MID));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( input2_max) {
+        const auto& value = *input2_max;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::INPUT2_MAX));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( input2_cmd) {
+        const auto& value = *input2_cmd;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::INPUT2_CMD));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( aux_input1_raw) {
+        const auto& value = *aux_input1_raw;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::AUX_INPUT1_RAW));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( aux_input1_typ) {
+        const auto& value = *aux_input1_typ;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::AUX_INPUT1_TYP));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( aux_input1_min) {
+        const auto& value = *aux_input1_min;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::AUX_INPUT1_MIN));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( aux_input1_mid) {
+        const auto& value = *aux_input1_mid;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::AUX_INPUT1_MID));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( aux_input1_max) {
+        const auto& value = *aux_input1_max;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::AUX_INPUT1_MAX));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( aux_input1_cmd) {
+        const auto& value = *aux_input1_cmd;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::AUX_INPUT1_CMD));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( aux_input2_raw) {
+        const auto& value = *aux_input2_raw;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::AUX_INPUT2_RAW));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( aux_input2_typ) {
+        const auto& value = *aux_input2_typ;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::AUX_INPUT2_TYP));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( aux_input2_min) {
+        const auto& value = *aux_input2_min;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::AUX_INPUT2_MIN));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( aux_input2_mid) {
+        const auto& value = *aux_input2_mid;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::AUX_INPUT2_MID));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( aux_input2_max) {
+        const auto& value = *aux_input2_max;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::AUX_INPUT2_MAX));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( aux_input2_cmd) {
+        const auto& value = *aux_input2_cmd;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::AUX_INPUT2_CMD));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( dc_curr) {
+        const auto& value = *dc_curr;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::DC_CURR));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( rdc_curr) {
+        const auto& value = *rdc_curr;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::RDC_CURR));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( ldc_curr) {
+        const auto& value = *ldc_curr;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::LDC_CURR));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( cmdl) {
+        const auto& value = *cmdl;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::CMDL));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( cmdr) {
+        const auto& value = *cmdr;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::CMDR));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( spd_avg) {
+        const auto& value = *spd_avg;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::SPD_AVG));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( spdl) {
+        const auto& value = *spdl;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::SPDL));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( spdr) {
+        const auto& value = *spdr;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::SPDR));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( filter_rate) {
+        const auto& value = *filter_rate;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::FILTER_RATE));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( spd_coef) {
+        const auto& value = *spd_coef;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::SPD_COEF));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( str_coef) {
+        const auto& value = *str_coef;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::STR_COEF));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( batv) {
+        const auto& value = *batv;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::BATV));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( temp) {
+        const auto& value = *temp;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::TEMP));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( req_gaps) {
+        const auto& value = *req_gaps;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::REQ_GAPS));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( req_superseded) {
+        const auto& value = *req_superseded;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::REQ_SUPERSEDED));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( time_us) {
+        const auto& value = *time_us;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::TIME_US));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( overruns) {
+        const auto& value = *overruns;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::OVERRUNS));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( overrun_run_max) {
+        const auto& value = *overrun_run_max;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::OVERRUN_RUN_MAX));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( overrun_err) {
+        const auto& value = *overrun_err;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::OVERRUN_ERR));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( offset_drift) {
+        const auto& value = *offset_drift;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::OFFSET_DRIFT));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( offset_track_ms) {
+        const auto& value = *offset_track_ms;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::OFFSET_TRACK_MS));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( boot_ms) {
+        const auto& value = *boot_ms;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::BOOT_MS));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( offsets_stored) {
+        const auto& value = *offsets_stored;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::OFFSETS_STORED));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( hall_rpm_l) {
+        const auto& value = *hall_rpm_l;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::HALL_RPM_L));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( hall_rpm_r) {
+        const auto& value = *hall_rpm_r;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::HALL_RPM_R));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( isr_stats_periods) {
+        const auto& value = *isr_stats_periods;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::ISR_STATS_PERIODS));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( isr_stats) {
+        const auto& value = *isr_stats;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::ISR_STATS));
+        cbor_check(cbor_encode_byte_string(&mapEncoder, value.data(), value.size()));
+    };
+
+     cbor_check(cbor_encoder_close_container(&encoder, &mapEncoder));
+    buffer.resize(cbor_encoder_get_buffer_size(&encoder, buffer.data()));
+     return 0;
+}
+
+int HoverboardEvent::decode(const Buffer& buffer) {
+    CborParser parser;
+    CborValue it;
+    cbor_check(cbor_parser_init(buffer.data(), buffer.size(), 0, &parser, &it));
+    if (!cbor_value_is_map(&it)) {
+        WARN("Expected CBOR map ");
+        return EINVAL;
+    }
+
+    CborValue mapValue;
+    cbor_value_enter_container(&it, &mapValue);
+
+    while (!cbor_value_at_end(&mapValue)) {
+        // Read the map key (must be an unsigned integer — field id).
+        if (!cbor_value_is_unsigned_integer(&mapValue)) {
+            // Skip unknown key type and its value.
+            cbor_value_advance(&mapValue);  // skip key
+            if (!cbor_value_at_end(&mapValue)) {
+                cbor_value_advance(&mapValue);  // skip value
+            }
+            continue;
+        }
+
+        uint64_t keyVal;
+        cbor_value_get_uint64(&mapValue, &keyVal);
+        cbor_value_advance(&mapValue);  // advance to value
+
+        switch ((uint32_t)keyVal) {
+            case HoverboardEvent::FieldId::CTRL_MOD:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    ctrl_mod = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    ctrl_mod = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::CTRL_TYP:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    ctrl_typ = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    ctrl_typ = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::CUR_MOT_MAX:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    cur_mot_max = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    cur_mot_max = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::RPM_MOT_MAX:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    rpm_mot_max = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    rpm_mot_max = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::FI_WEAK_ENA:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    fi_weak_ena = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    fi_weak_ena = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::FI_WEAK_HI:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    fi_weak_hi = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    fi_weak_hi = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::FI_WEAK_LO:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    fi_weak_lo = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    fi_weak_lo = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::FI_WEAK_MAX:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    fi_weak_max = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    fi_weak_max = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::PHASE_ADV_MAX_DEG:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    phase_adv_max_deg = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    phase_adv_max_deg = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::INPUT1_RAW:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    input1_raw = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    input1_raw = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::INPUT1_TYP:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    input1_typ = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    input1_typ = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::INPUT1_MIN:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    input1_min = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    input1_min = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::INPUT1_MID:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    input1_mid = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    input1_mid = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::INPUT1_MAX:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    input1_max = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    input1_max = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::INPUT1_CMD:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    input1_cmd = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    input1_cmd = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::INPUT2_RAW:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    input2_raw = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    input2_raw = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::INPUT2_TYP:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    input2_typ = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    input2_typ = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::INPUT2_MIN:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    input2_min = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    input2_min = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::INPUT2_MID:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    input2_mid = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    input2_mid = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::INPUT2_MAX:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    input2_max = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    input2_max = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::INPUT2_CMD:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    input2_cmd = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    input2_cmd = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::AUX_INPUT1_RAW:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    aux_input1_raw = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    aux_input1_raw = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::AUX_INPUT1_TYP:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    aux_input1_typ = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    aux_input1_typ = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::AUX_INPUT1_MIN:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    aux_input1_min = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    aux_input1_min = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::AUX_INPUT1_MID:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    aux_input1_mid = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    aux_input1_mid = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::AUX_INPUT1_MAX:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    aux_input1_max = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    aux_input1_max = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::AUX_INPUT1_CMD:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    aux_input1_cmd = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    aux_input1_cmd = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::AUX_INPUT2_RAW:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    aux_input2_raw = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    aux_input2_raw = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::AUX_INPUT2_TYP:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    aux_input2_typ = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    aux_input2_typ = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::AUX_INPUT2_MIN:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    aux_input2_min = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    aux_input2_min = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::AUX_INPUT2_MID:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    aux_input2_mid = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    aux_input2_mid = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::AUX_INPUT2_MAX:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    aux_input2_max = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    aux_input2_max = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::AUX_INPUT2_CMD:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    aux_input2_cmd = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    aux_input2_cmd = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::DC_CURR:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    dc_curr = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    dc_curr = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::RDC_CURR:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    rdc_curr = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    rdc_curr = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::LDC_CURR:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    ldc_curr = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    ldc_curr = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::CMDL:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    cmdl = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    cmdl = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::CMDR:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    cmdr = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    cmdr = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::SPD_AVG:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    spd_avg = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    spd_avg = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::SPDL:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    spdl = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    spdl = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::SPDR:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    spdr = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    spdr = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::FILTER_RATE:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    filter_rate = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    filter_rate = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::SPD_COEF:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    spd_coef = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    spd_coef = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::STR_COEF:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    str_coef = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    str_coef = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::BATV:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    batv = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    batv = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::TEMP:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    temp = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    temp = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::REQ_GAPS:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    req_gaps = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    req_gaps = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::REQ_SUPERSEDED:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    req_superseded = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    req_superseded = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::TIME_US:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    time_us = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    time_us = ((uint32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::OVERRUNS:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    overruns = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    overruns = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::OVERRUN_RUN_MAX:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    overrun_run_max = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    overrun_run_max = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::OVERRUN_ERR:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    overrun_err = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    overrun_err = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::OFFSET_DRIFT:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    offset_drift = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    offset_drift = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::OFFSET_TRACK_MS:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    offset_track_ms = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    offset_track_ms = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::BOOT_MS:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    boot_ms = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    boot_ms = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::OFFSETS_STORED:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    offsets_stored = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    offsets_stored = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::HALL_RPM_L:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    hall_rpm_l = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    hall_rpm_l = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::HALL_RPM_R:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    hall_rpm_r = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    hall_rpm_r = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::ISR_STATS_PERIODS:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    isr_stats_periods = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    isr_stats_periods = ((int32_t)val);
+                }
+                break;
+            case HoverboardEvent::FieldId::ISR_STATS:
+                if (cbor_value_is_byte_string(&mapValue)) {
+                    size_t len;
+                    cbor_value_get_string_length(&mapValue, &len);
+                    std::vector<uint8_t> val(len);
+                    cbor_value_copy_byte_string(&mapValue, val.data(), &len, NULL);
+                    isr_stats = (val);
+                }
+                break;
+            default:
+                // Unknown field id — skip value.
+                break;
+        }
+
+        cbor_value_advance(&mapValue);  // advance past value to next key (or end)
+    }
+
+    cbor_value_leave_container(&it, &mapValue);
+    return 0;
+}
+
+int IsrProfileEvent::encode(Buffer& buffer) const {
+    buffer.clear();
+    CborEncoder encoder;
+    cbor_encoder_init(&encoder,buffer.data(),buffer.capacity(),0);
+    // Count how many optional fields are set.
+    uint32_t fieldCount = 0;
+    if (stage.is_some()) { fieldCount++; }
+    if (count.is_some()) { fieldCount++; }
+    if (min.is_some()) { fieldCount++; }
+    if (avg.is_some()) { fieldCount++; }
+    if (max.is_some()) { fieldCount++; }
+    if (last.is_some()) { fieldCount++; }
+    if (hist.is_some()) { fieldCount++; }
+    if (bin_cycles.is_some()) { fieldCount++; }
+    if (budget_cycles.is_some()) { fieldCount++; }
+
+    CborEncoder mapEncoder;
+    cbor_check(cbor_encoder_create_map(&encoder, &mapEncoder, fieldCount));
+    if ( stage) {
+        const auto& value = *stage;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::STAGE));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( count) {
+        const auto& value = *count;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::COUNT));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( min) {
+        const auto& value = *min;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::MIN));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( avg) {
+        const auto& value = *avg;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::AVG));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( max) {
+        const auto& value = *max;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::MAX));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( last) {
+        const auto& value = *last;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::LAST));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( hist) {
+        const auto& value = *hist;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::HIST));
+        cbor_check(cbor_encode_byte_string(&mapEncoder, value.data(), value.size()));
+    };
+    if ( bin_cycles) {
+        const auto& value = *bin_cycles;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::BIN_CYCLES));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( budget_cycles) {
+        const auto& value = *budget_cycles;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::BUDGET_CYCLES));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+
+     cbor_check(cbor_encoder_close_container(&encoder, &mapEncoder));
+    buffer.resize(cbor_encoder_get_buffer_size(&encoder, buffer.data()));
+     return 0;
+}
+
+int IsrProfileEvent::decode(const Buffer& buffer) {
+    CborParser parser;
+    CborValue it;
+    cbor_check(cbor_parser_init(buffer.data(), buffer.size(), 0, &parser, &it));
+    if (!cbor_value_is_map(&it)) {
+        WARN("Expected CBOR map ");
+        return EINVAL;
+    }
+
+    CborValue mapValue;
+    cbor_value_enter_container(&it, &mapValue);
+
+    while (!cbor_value_at_end(&mapValue)) {
+        // Read the map key (must be an unsigned integer — field id).
+        if (!cbor_value_is_unsigned_integer(&mapValue)) {
+            // Skip unknown key type and its value.
+            cbor_value_advance(&mapValue);  // skip key
+            if (!cbor_value_at_end(&mapValue)) {
+                cbor_value_advance(&mapValue);  // skip value
+            }
+            continue;
+        }
+
+        uint64_t keyVal;
+        cbor_value_get_uint64(&mapValue, &keyVal);
+        cbor_value_advance(&mapValue);  // advance to value
+
+        switch ((uint32_t)keyVal) {
+            case IsrProfileEvent::FieldId::STAGE:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    stage = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    stage = ((uint32_t)val);
+                }
+                break;
+            case IsrProfileEvent::FieldId::COUNT:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    count = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    count = ((uint32_t)val);
+                }
+                break;
+            case IsrProfileEvent::FieldId::MIN:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    min = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    min = ((uint32_t)val);
+                }
+                break;
+            case IsrProfileEvent::FieldId::AVG:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    avg = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    avg = ((uint32_t)val);
+                }
+                break;
+            case IsrProfileEvent::FieldId::MAX:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    max = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    max = ((uint32_t)val);
+                }
+                break;
+            case IsrProfileEvent::FieldId::LAST:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    last = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    last = ((uint32_t)val);
+                }
+                break;
+            case IsrProfileEvent::FieldId::HIST:
+                if (cbor_value_is_byte_string(&mapValue)) {
+                    size_t len;
+                    cbor_value_get_string_length(&mapValue, &len);
+                    std::vector<uint8_t> val(len);
+                    cbor_value_copy_byte_string(&mapValue, val.data(), &len, NULL);
+                    hist = (val);
+                }
+                break;
+            case IsrProfileEvent::FieldId::BIN_CYCLES:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    bin_cycles = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    bin_cycles = ((uint32_t)val);
+                }
+                break;
+            case IsrProfileEvent::FieldId::BUDGET_CYCLES:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    budget_cycles = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    budget_cycles = ((uint32_t)val);
+                }
+                break;
+            default:
+                // Unknown field id — skip value.
+                break;
+        }
+
+        cbor_value_advance(&mapValue);  // advance past value to next key (or end)
+    }
+
+    cbor_value_leave_container(&it, &mapValue);
+    return 0;
+}
+
+int LinkDiagEvent::encode(Buffer& buffer) const {
+    buffer.clear();
+    CborEncoder encoder;
+    cbor_encoder_init(&encoder,buffer.data(),buffer.capacity(),0);
+    // Count how many optional fields are set.
+    uint32_t fieldCount = 0;
+    if (rx_bytes.is_some()) { fieldCount++; }
+    if (rx_frames.is_some()) { fieldCount++; }
+    if (rx_cobs_errors.is_some()) { fieldCount++; }
+    if (rx_crc_errors.is_some()) { fieldCount++; }
+    if (rx_overflows.is_some()) { fieldCount++; }
+    if (rx_decode_errors.is_some()) { fieldCount++; }
+    if (rx_unknown_msgs.is_some()) { fieldCount++; }
+    if (tx_frames.is_some()) { fieldCount++; }
+    if (tx_dropped.is_some()) { fieldCount++; }
+    if (tx_frame_max.is_some()) { fieldCount++; }
+    if (tx_queue_max.is_some()) { fieldCount++; }
+    if (tx_queue_dropped.is_some()) { fieldCount++; }
+
+    CborEncoder mapEncoder;
+    cbor_check(cbor_encoder_create_map(&encoder, &mapEncoder, fieldCount));
+    if ( rx_bytes) {
+        const auto& value = *rx_bytes;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::RX_BYTES));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( rx_frames) {
+        const auto& value = *rx_frames;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::RX_FRAMES));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( rx_cobs_errors) {
+        const auto& value = *rx_cobs_errors;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::RX_COBS_ERRORS));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( rx_crc_errors) {
+        const auto& value = *rx_crc_errors;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::RX_CRC_ERRORS));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( rx_overflows) {
+        const auto& value = *rx_overflows;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::RX_OVERFLOWS));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( rx_decode_errors) {
+        const auto& value = *rx_decode_errors;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::RX_DECODE_ERRORS));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( rx_unknown_msgs) {
+        const auto& value = *rx_unknown_msgs;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::RX_UNKNOWN_MSGS));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( tx_frames) {
+        const auto& value = *tx_frames;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::TX_FRAMES));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( tx_dropped) {
+        const auto& value = *tx_dropped;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::TX_DROPPED));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( tx_frame_max) {
+        const auto& value = *tx_frame_max;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::TX_FRAME_MAX));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( tx_queue_max) {
+        const auto& value = *tx_queue_max;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::TX_QUEUE_MAX));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( tx_queue_dropped) {
+        const auto& value = *tx_queue_dropped;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::TX_QUEUE_DROPPED));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+
+     cbor_check(cbor_encoder_close_container(&encoder, &mapEncoder));
+    buffer.resize(cbor_encoder_get_buffer_size(&encoder, buffer.data()));
+     return 0;
+}
+
+int LinkDiagEvent::decode(const Buffer& buffer) {
+    CborParser parser;
+    CborValue it;
+    cbor_check(cbor_parser_init(buffer.data(), buffer.size(), 0, &parser, &it));
+    if (!cbor_value_is_map(&it)) {
+        WARN("Expected CBOR map ");
+        return EINVAL;
+    }
+
+    CborValue mapValue;
+    cbor_value_enter_container(&it, &mapValue);
+
+    while (!cbor_value_at_end(&mapValue)) {
+        // Read the map key (must be an unsigned integer — field id).
+        if (!cbor_value_is_unsigned_integer(&mapValue)) {
+            // Skip unknown key type and its value.
+            cbor_value_advance(&mapValue);  // skip key
+            if (!cbor_value_at_end(&mapValue)) {
+                cbor_value_advance(&mapValue);  // skip value
+            }
+            continue;
+        }
+
+        uint64_t keyVal;
+        cbor_value_get_uint64(&mapValue, &keyVal);
+        cbor_value_advance(&mapValue);  // advance to value
+
+        switch ((uint32_t)keyVal) {
+            case LinkDiagEvent::FieldId::RX_BYTES:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    rx_bytes = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    rx_bytes = ((uint32_t)val);
+                }
+                break;
+            case LinkDiagEvent::FieldId::RX_FRAMES:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    rx_frames = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    rx_frames = ((uint32_t)val);
+                }
+                break;
+            case LinkDiagEvent::FieldId::RX_COBS_ERRORS:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    rx_cobs_errors = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    rx_cobs_errors = ((uint32_t)val);
+                }
+                break;
+            case LinkDiagEvent::FieldId::RX_CRC_ERRORS:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    rx_crc_errors = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    rx_crc_errors = ((uint32_t)val);
+                }
+                break;
+            case LinkDiagEvent::FieldId::RX_OVERFLOWS:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    rx_overflows = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    rx_overflows = ((uint32_t)val);
+                }
+                break;
+            case LinkDiagEvent::FieldId::RX_DECODE_ERRORS:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    rx_decode_errors = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    rx_decode_errors = ((uint32_t)val);
+                }
+                break;
+            case LinkDiagEvent::FieldId::RX_UNKNOWN_MSGS:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    rx_unknown_msgs = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    rx_unknown_msgs = ((uint32_t)val);
+                }
+                break;
+            case LinkDiagEvent::FieldId::TX_FRAMES:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    tx_frames = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    tx_frames = ((uint32_t)val);
+                }
+                break;
+            case LinkDiagEvent::FieldId::TX_DROPPED:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    tx_dropped = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    tx_dropped = ((uint32_t)val);
+                }
+                break;
+            case LinkDiagEvent::FieldId::TX_FRAME_MAX:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    tx_frame_max = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    tx_frame_max = ((uint32_t)val);
+                }
+                break;
+            case LinkDiagEvent::FieldId::TX_QUEUE_MAX:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    tx_queue_max = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    tx_queue_max = ((uint32_t)val);
+                }
+                break;
+            case LinkDiagEvent::FieldId::TX_QUEUE_DROPPED:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    tx_queue_dropped = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    tx_queue_dropped = ((uint32_t)val);
+                }
+                break;
+            default:
+                // Unknown field id — skip value.
+                break;
+        }
+
+        cbor_value_advance(&mapValue);  // advance past value to next key (or end)
+    }
+
+    cbor_value_leave_container(&it, &mapValue);
+    return 0;
+}
+
+int PingReply::encode(Buffer& buffer) const {
+    buffer.clear();
+    CborEncoder encoder;
+    cbor_encoder_init(&encoder,buffer.data(),buffer.capacity(),0);
+    // Count how many optional fields are set.
+    uint32_t fieldCount = 0;
+    if (req_id.is_some()) { fieldCount++; }
+    if (timestamp.is_some()) { fieldCount++; }
+    if (rx_us.is_some()) { fieldCount++; }
+    if (tx_us.is_some()) { fieldCount++; }
+
+    CborEncoder mapEncoder;
+    cbor_check(cbor_encoder_create_map(&encoder, &mapEncoder, fieldCount));
+    if ( req_id) {
+        const auto& value = *req_id;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::REQ_ID));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( timestamp) {
+        const auto& value = *timestamp;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::TIMESTAMP));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( rx_us) {
+        const auto& value = *rx_us;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::RX_US));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( tx_us) {
+        const auto& value = *tx_us;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::TX_US));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+
+     cbor_check(cbor_encoder_close_container(&encoder, &mapEncoder));
+    buffer.resize(cbor_encoder_get_buffer_size(&encoder, buffer.data()));
+     return 0;
+}
+
+int PingReply::decode(const Buffer& buffer) {
+    CborParser parser;
+    CborValue it;
+    cbor_check(cbor_parser_init(buffer.data(), buffer.size(), 0, &parser, &it));
+    if (!cbor_value_is_map(&it)) {
+        WARN("Expected CBOR map ");
+        return EINVAL;
+    }
+
+    CborValue mapValue;
+    cbor_value_enter_container(&it, &mapValue);
+
+    while (!cbor_value_at_end(&mapValue)) {
+        // Read the map key (must be an unsigned integer — field id).
+        if (!cbor_value_is_unsigned_integer(&mapValue)) {
+            // Skip unknown key type and its value.
+            cbor_value_advance(&mapValue);  // skip key
+            if (!cbor_value_at_end(&mapValue)) {
+                cbor_value_advance(&mapValue);  // skip value
+            }
+            continue;
+        }
+
+        uint64_t keyVal;
+        cbor_value_get_uint64(&mapValue, &keyVal);
+        cbor_value_advance(&mapValue);  // advance to value
+
+        switch ((uint32_t)keyVal) {
+            case PingReply::FieldId::REQ_ID:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    req_id = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    req_id = ((uint32_t)val);
+                }
+                break;
+            case PingReply::FieldId::TIMESTAMP:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    timestamp = (val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    timestamp = ((uint64_t)val);
+                }
+                break;
+            case PingReply::FieldId::RX_US:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    rx_us = (val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    rx_us = ((uint64_t)val);
+                }
+                break;
+            case PingReply::FieldId::TX_US:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    tx_us = (val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    tx_us = ((uint64_t)val);
+                }
+                break;
+            default:
+                // Unknown field id — skip value.
+                break;
+        }
+
+        cbor_value_advance(&mapValue);  // advance past value to next key (or end)
+    }
+
+    cbor_value_leave_container(&it, &mapValue);
+    return 0;
+}
+
+int ScopeEvent::encode(Buffer& buffer) const {
+    buffer.clear();
+    CborEncoder encoder;
+    cbor_encoder_init(&encoder,buffer.data(),buffer.capacity(),0);
+    // Count how many optional fields are set.
+    uint32_t fieldCount = 0;
+    if (capture_id.is_some()) { fieldCount++; }
+    if (state.is_some()) { fieldCount++; }
+    if (channels.is_some()) { fieldCount++; }
+    if (decimation.is_some()) { fieldCount++; }
+    if (pre_samples.is_some()) { fieldCount++; }
+    if (samples.is_some()) { fieldCount++; }
+    if (offset.is_some()) { fieldCount++; }
+    if (data.is_some()) { fieldCount++; }
+
+    CborEncoder mapEncoder;
+    cbor_check(cbor_encoder_create_map(&encoder, &mapEncoder, fieldCount));
+    if ( capture_id) {
+        const auto& value = *capture_id;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::CAPTURE_ID));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( state) {
+        const auto& value = *state;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::STATE));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( channels) {
+        const auto& value = *channels;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::CHANNELS));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( decimation) {
+        const auto& value = *decimation;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::DECIMATION));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( pre_samples) {
+        const auto& value = *pre_samples;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::PRE_SAMPLES));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( samples) {
+        const auto& value = *samples;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::SAMPLES));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( offset) {
+        const auto& value = *offset;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::OFFSET));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( data) {
+        const auto& value = *data;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::DATA));
+        cbor_check(cbor_encode_byte_string(&mapEncoder, value.data(), value.size()));
+    };
+
+     cbor_check(cbor_encoder_close_container(&encoder, &mapEncoder));
+    buffer.resize(cbor_encoder_get_buffer_size(&encoder, buffer.data()));
+     return 0;
+}
+
+int ScopeEvent::decode(const Buffer& buffer) {
+    CborParser parser;
+    CborValue it;
+    cbor_check(cbor_parser_init(buffer.data(), buffer.size(), 0, &parser, &it));
+    if (!cbor_value_is_map(&it)) {
+        WARN("Expected CBOR map ");
+        return EINVAL;
+    }
+
+    CborValue mapValue;
+    cbor_value_enter_container(&it, &mapValue);
+
+    while (!cbor_value_at_end(&mapValue)) {
+        // Read the map key (must be an unsigned integer — field id).
+        if (!cbor_value_is_unsigned_integer(&mapValue)) {
+            // Skip unknown key type and its value.
+            cbor_value_advance(&mapValue);  // skip key
+            if (!cbor_value_at_end(&mapValue)) {
+                cbor_value_advance(&mapValue);  // skip value
+            }
+            continue;
+        }
+
+        uint64_t keyVal;
+        cbor_value_get_uint64(&mapValue, &keyVal);
+        cbor_value_advance(&mapValue);  // advance to value
+
+        switch ((uint32_t)keyVal) {
+            case ScopeEvent::FieldId::CAPTURE_ID:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    capture_id = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    capture_id = ((uint32_t)val);
+                }
+                break;
+            case ScopeEvent::FieldId::STATE:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    state = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    state = ((uint32_t)val);
+                }
+                break;
+            case ScopeEvent::FieldId::CHANNELS:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    channels = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    channels = ((uint32_t)val);
+                }
+                break;
+            case ScopeEvent::FieldId::DECIMATION:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    decimation = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    decimation = ((uint32_t)val);
+                }
+                break;
+            case ScopeEvent::FieldId::PRE_SAMPLES:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    pre_samples = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    pre_samples = ((uint32_t)val);
+                }
+                break;
+            case ScopeEvent::FieldId::SAMPLES:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    samples = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    samples = ((uint32_t)val);
+                }
+                break;
+            case ScopeEvent::FieldId::OFFSET:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    offset = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    offset = ((uint32_t)val);
+                }
+                break;
+            case ScopeEvent::FieldId::DATA:
+                if (cbor_value_is_byte_string(&mapValue)) {
+                    size_t len;
+                    cbor_value_get_string_length(&mapValue, &len);
+                    std::vector<uint8_t> val(len);
+                    cbor_value_copy_byte_string(&mapValue, val.data(), &len, NULL);
+                    data = (val);
+                }
+                break;
+            default:
+                // Unknown field id — skip value.
+                break;
+        }
+
+        cbor_value_advance(&mapValue);  // advance past value to next key (or end)
+    }
+
+    cbor_value_leave_container(&it, &mapValue);
+    return 0;
+}
+
+int ScopeRequest::encode(Buffer& buffer) const {
+    buffer.clear();
+    CborEncoder encoder;
+    cbor_encoder_init(&encoder,buffer.data(),buffer.capacity(),0);
+    // Count how many optional fields are set.
+    uint32_t fieldCount = 0;
+    if (req_id.is_some()) { fieldCount++; }
+    if (channels.is_some()) { fieldCount++; }
+    if (decimation.is_some()) { fieldCount++; }
+    if (trigger.is_some()) { fieldCount++; }
+    if (trigger_channel.is_some()) { fieldCount++; }
+    if (level.is_some()) { fieldCount++; }
+    if (pre_samples.is_some()) { fieldCount++; }
+    if (force.is_some()) { fieldCount++; }
+    if (resend.is_some()) { fieldCount++; }
+
+    CborEncoder mapEncoder;
+    cbor_check(cbor_encoder_create_map(&encoder, &mapEncoder, fieldCount));
+    if ( req_id) {
+        const auto& value = *req_id;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::REQ_ID));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( channels) {
+        const auto& value = *channels;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::CHANNELS));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( decimation) {
+        const auto& value = *decimation;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::DECIMATION));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( trigger) {
+        const auto& value = *trigger;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::TRIGGER));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( trigger_channel) {
+        const auto& value = *trigger_channel;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::TRIGGER_CHANNEL));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( level) {
+        const auto& value = *level;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::LEVEL));
+        cbor_check(cbor_encode_int(&mapEncoder, value));
+    };
+    if ( pre_samples) {
+        const auto& value = *pre_samples;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::PRE_SAMPLES));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( force) {
+        const auto& value = *force;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::FORCE));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( resend) {
+        const auto& value = *resend;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::RESEND));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+
+     cbor_check(cbor_encoder_close_container(&encoder, &mapEncoder));
+    buffer.resize(cbor_encoder_get_buffer_size(&encoder, buffer.data()));
+     return 0;
+}
+
+int ScopeRequest::decode(const Buffer& buffer) {
+    CborParser parser;
+    CborValue it;
+    cbor_check(cbor_parser_init(buffer.data(), buffer.size(), 0, &parser, &it));
+    if (!cbor_value_is_map(&it)) {
+        WARN("Expected CBOR map ");
+        return EINVAL;
+    }
+
+    CborValue mapValue;
+    cbor_value_enter_container(&it, &mapValue);
+
+    while (!cbor_value_at_end(&mapValue)) {
+        // Read the map key (must be an unsigned integer — field id).
+        if (!cbor_value_is_unsigned_integer(&mapValue)) {
+            // Skip unknown key type and its value.
+            cbor_value_advance(&mapValue);  // skip key
+            if (!cbor_value_at_end(&mapValue)) {
+                cbor_value_advance(&mapValue);  // skip value
+            }
+            continue;
+        }
+
+        uint64_t keyVal;
+        cbor_value_get_uint64(&mapValue, &keyVal);
+        cbor_value_advance(&mapValue);  // advance to value
+
+        switch ((uint32_t)keyVal) {
+            case ScopeRequest::FieldId::REQ_ID:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    req_id = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    req_id = ((uint32_t)val);
+                }
+                break;
+            case ScopeRequest::FieldId::CHANNELS:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    channels = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    channels = ((uint32_t)val);
+                }
+                break;
+            case ScopeRequest::FieldId::DECIMATION:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    decimation = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    decimation = ((uint32_t)val);
+                }
+                break;
+            case ScopeRequest::FieldId::TRIGGER:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    trigger = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    trigger = ((uint32_t)val);
+                }
+                break;
+            case ScopeRequest::FieldId::TRIGGER_CHANNEL:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    trigger_channel = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    trigger_channel = ((uint32_t)val);
+                }
+                break;
+            case ScopeRequest::FieldId::LEVEL:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    level = ((int32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    level = ((int32_t)val);
+                }
+                break;
+            case ScopeRequest::FieldId::PRE_SAMPLES:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    pre_samples = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    pre_samples = ((uint32_t)val);
+                }
+                break;
+            case ScopeRequest::FieldId::FORCE:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    force = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    force = ((uint32_t)val);
+                }
+                break;
+            case ScopeRequest::FieldId::RESEND:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    resend = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    resend = ((uint32_t)val);
+                }
+                break;
+            default:
+                // Unknown field id — skip value.
+                break;
+        }
+
+        cbor_value_advance(&mapValue);  // advance past value to next key (or end)
+    }
+
+    cbor_value_leave_container(&it, &mapValue);
+    return 0;
+}
+
+int TraceEvent::encode(Buffer& buffer) const {
+    buffer.clear();
+    CborEncoder encoder;
+    cbor_encoder_init(&encoder,buffer.data(),buffer.capacity(),0);
+    // Count how many optional fields are set.
+    uint32_t fieldCount = 0;
+    if (tick.is_some()) { fieldCount++; }
+    if (interval.is_some()) { fieldCount++; }
+    if (rows.is_some()) { fieldCount++; }
+    if (channels.is_some()) { fieldCount++; }
+    if (shifts.is_some()) { fieldCount++; }
+    if (columns.is_some()) { fieldCount++; }
+    if (skipped.is_some()) { fieldCount++; }
+
+    CborEncoder mapEncoder;
+    cbor_check(cbor_encoder_create_map(&encoder, &mapEncoder, fieldCount));
+    if ( tick) {
+        const auto& value = *tick;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::TICK));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( interval) {
+        const auto& value = *interval;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::INTERVAL));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( rows) {
+        const auto& value = *rows;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::ROWS));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( channels) {
+        const auto& value = *channels;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::CHANNELS));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+    if ( shifts) {
+        const auto& value = *shifts;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::SHIFTS));
+        cbor_check(cbor_encode_byte_string(&mapEncoder, value.data(), value.size()));
+    };
+    if ( columns) {
+        const auto& value = *columns;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::COLUMNS));
+        cbor_check(cbor_encode_byte_string(&mapEncoder, value.data(), value.size()));
+    };
+    if ( skipped) {
+        const auto& value = *skipped;
+        cbor_check(cbor_encode_uint(&mapEncoder, FieldId::SKIPPED));
+        cbor_check(cbor_encode_uint(&mapEncoder, value));
+    };
+
+     cbor_check(cbor_encoder_close_container(&encoder, &mapEncoder));
+    buffer.resize(cbor_encoder_get_buffer_size(&encoder, buffer.data()));
+     return 0;
+}
+
+int TraceEvent::decode(const Buffer& buffer) {
+    CborParser parser;
+    CborValue it;
+    cbor_check(cbor_parser_init(buffer.data(), buffer.size(), 0, &parser, &it));
+    if (!cbor_value_is_map(&it)) {
+        WARN("Expected CBOR map ");
+        return EINVAL;
+    }
+
+    CborValue mapValue;
+    cbor_value_enter_container(&it, &mapValue);
+
+    while (!cbor_value_at_end(&mapValue)) {
+        // Read the map key (must be an unsigned integer — field id).
+        if (!cbor_value_is_unsigned_integer(&mapValue)) {
+            // Skip unknown key type and its value.
+            cbor_value_advance(&mapValue);  // skip key
+            if (!cbor_value_at_end(&mapValue)) {
+                cbor_value_advance(&mapValue);  // skip value
+            }
+            continue;
+        }
+
+        uint64_t keyVal;
+        cbor_value_get_uint64(&mapValue, &keyVal);
+        cbor_value_advance(&mapValue);  // advance to value
+
+        switch ((uint32_t)keyVal) {
+            case TraceEvent::FieldId::TICK:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    tick = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    tick = ((uint32_t)val);
+                }
+                break;
+            case TraceEvent::FieldId::INTERVAL:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    interval = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    interval = ((uint32_t)val);
+                }
+                break;
+            case TraceEvent::FieldId::ROWS:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    rows = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    rows = ((uint32_t)val);
+                }
+                break;
+            case TraceEvent::FieldId::CHANNELS:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    channels = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    channels = ((uint32_t)val);
+                }
+                break;
+            case TraceEvent::FieldId::SHIFTS:
+                if (cbor_value_is_byte_string(&mapValue)) {
+                    size_t len;
+                    cbor_value_get_string_length(&mapValue, &len);
+                    std::vector<uint8_t> val(len);
+                    cbor_value_copy_byte_string(&mapValue, val.data(), &len, NULL);
+                    shifts = (val);
+                }
+                break;
+            case TraceEvent::FieldId::COLUMNS:
+                if (cbor_value_is_byte_string(&mapValue)) {
+                    size_t len;
+                    cbor_value_get_string_length(&mapValue, &len);
+                    std::vector<uint8_t> val(len);
+                    cbor_value_copy_byte_string(&mapValue, val.data(), &len, NULL);
+                    columns = (val);
+                }
+                break;
+            case TraceEvent::FieldId::SKIPPED:
+                if (cbor_value_is_unsigned_integer(&mapValue)) {
+                    uint64_t val;
+                    cbor_value_get_uint64(&mapValue, &val);
+                    skipped = ((uint32_t)val);
+                } else if (cbor_value_is_negative_integer(&mapValue)) {
+                    int64_t val;
+                    cbor_value_get_int64(&mapValue, &val);
+                    skipped = ((uint32_t)val);
+                }
+                break;
+            default:
+                // Unknown field id — skip value.
+                break;
+        }
+
+        cbor_value_advance(&mapValue);  // advance past value to next key (or end)
+    }
+
+    cbor_value_leave_container(&it, &mapValue);
+    return 0;
+}
@@ -9,10 +9,19 @@
 #include "BLDC_controller.h"
 #include "util.h"
 #include "comms.h"
+#include "scope.h"
+#include "isr_profile.h"
+#include "hall_speed.h"
+#include "isr_stats.h"
+#include "energy.h"
+#include "scheduler.h"
 
 #include <limero/log.h>
 #include <limero/codec.h>
-#include <limero/msgs.h>
+#include <limero/msgs_hoverboard.h>
+#include <limero/batch.h>
+#include <limero/column_pack.h>
+#include <limero/trace_channels.h>
 #include <limero/log.h>
 
 void panic_here(const char *s)
@@ -47,8 +56,396 @@ extern "C"
     extern int16_t limero_speed;
     extern int16_t limero_steer;
     extern uint8_t limero_data_fresh;
+    extern uint32_t overrunCnt;
+    extern uint16_t overrunRunMax;
+    extern uint8_t overrunErr;
+    extern int16_t offsetDrift;
+    extern uint32_t offsetTrackCnt;
+    extern uint32_t bootReadyMs;
+    extern uint8_t offsetFastBoot;
+    extern HallSpeed hallSpeedL, hallSpeedR;
 }
 
+// Link quality counters, sent in a LinkDiagEvent. The rx_ counters are only
+// written in the USART2 IRQ, the tx_ ones only in the main loop.
+struct LinkStats
+{
+    uint32_t rx_bytes;
+    uint32_t rx_frames;
+    uint32_t rx_cobs_errors;
+    uint32_t rx_crc_errors;
+    uint32_t rx_overflows;
+    uint32_t rx_decode_errors;
+    uint32_t rx_unknown_msgs;
+    uint32_t tx_frames;
+    uint32_t tx_dropped;
+    uint32_t tx_frame_max;
+    uint32_t tx_queue_max;
+    uint32_t tx_queue_dropped;
+};
+LinkStats link_stats;
+
+#if defined(LIMERO_ACK)
+// Requests taken over by the main loop, replied to in the next telemetry frame.
+// One request per main loop at most, telemetry every 40 loops: beyond 16 per
+// frame (80 Hz) the replies are dropped and the host counts them as lost.
+#define ACK_QUEUE_SIZE 16
+struct Ack
+{
+    uint32_t req_id;
+    uint32_t tick;
+};
+Ack ack_queue[ACK_QUEUE_SIZE];
+uint32_t ack_count = 0;
+GenericReply ack_reply;
+
+extern "C" volatile uint32_t pending_req_id; // read by readInputRaw() with the values
+volatile uint32_t pending_req_id = 0; // req_id of the values in limero_speed/limero_steer, written in the USART2 IRQ
+uint32_t acked_req_id = 0;
+uint32_t last_req_id = 0;
+uint32_t req_gaps = 0;       // req_ids skipped in sequence, lost on the way in
+uint32_t req_superseded = 0; // received but overwritten before the main loop took them over
+
+// USART2 IRQ, before the new values are published
+void track_req_id(uint32_t req_id)
+{
+    if (limero_data_fresh && pending_req_id)
+    {
+        req_superseded++;
+    }
+    // a lower req_id is a restarted host, not a gap
+    if (last_req_id && req_id > last_req_id + 1)
+    {
+        req_gaps += req_id - last_req_id - 1;
+    }
+    last_req_id = req_id;
+    pending_req_id = req_id;
+}
+
+// main loop, from readInputRaw() when it took over limero_speed/limero_steer
+// together with req_id, the pending_req_id of those values
+extern "C" void limero_applied(uint32_t req_id, uint32_t tick)
+{
+    if (req_id == 0 || req_id == acked_req_id)
+    {
+        return;
+    }
+    if (ack_count == ACK_QUEUE_SIZE)
+    {
+        link_stats.tx_queue_dropped++;
+        return;
+    }
+    acked_req_id = req_id;
+    ack_queue[ack_count++] = {req_id, tick};
+}
+#endif
+
+#if defined(LIMERO_BATCH)
+// PingRequests, stamped with the board clock on arrival and answered in the
+// next telemetry frame with the time that frame was handed to the UART. The
+// host gets the four NTP timestamps from one exchange.
+// Filled in the USART2 IRQ, drained by get_txd() in the main loop.
+#define PING_QUEUE_SIZE 4
+PingReply ping_queue[PING_QUEUE_SIZE];
+volatile uint8_t ping_head = 0;
+volatile uint8_t ping_tail = 0;
+
+void queue_ping(const PingRequest &request, uint64_t rx_us)
+{
+    uint8_t next = (ping_head + 1) % PING_QUEUE_SIZE;
+    if (next == ping_tail)
+    {
+        link_stats.tx_queue_dropped++; // host pings faster than telemetry goes out, it will time out
+        return;
+    }
+    PingReply &reply = ping_queue[ping_head];
+    reply.req_id = request.req_id;
+    reply.timestamp = request.timestamp;
+    reply.rx_us = rx_us;
+    ping_head = next;
+}
+#endif
+
+#if defined(LIMERO_SCOPE)
+// Captures are armed from the USART2 IRQ and sent from get_txd(), one chunk
+// of at most SCOPE_CHUNK_BYTES per telemetry frame once the capture is done.
+// While armed or triggered every frame carries a ScopeEvent without data.
+#define SCOPE_CHUNK_BYTES 256
+ScopeEvent scope_status;
+ScopeEvent scope_chunk;
+GenericReply scope_reply;
+int16_t scope_samples_buf[SCOPE_CHUNK_BYTES / 2];
+uint32_t scope_sent_id = 0; // capture being sent
+uint16_t scope_offset = 0;  // next sample of it to send
+uint16_t scope_chunk_rows = 0;      // rows of the chunk in the frame being built
+uint32_t scope_reply_pending = 0;   // req_id taken from the IRQ, cleared once its frame is out
+uint32_t scope_reply_pending_error = 0;
+volatile int32_t scope_resend = -1;
+volatile uint32_t scope_reply_req_id = 0;
+volatile uint32_t scope_reply_error = 0;
+
+// USART2 IRQ
+void handle_scope_request(const ScopeRequest &request)
+{
+    int rc = 0;
+    if (request.channels && *request.channels == 0)
+    {
+        scope_stop();
+    }
+    else if (request.channels)
+    {
+        ScopeConfig config;
+        config.channels = *request.channels;
+        config.decimation = request.decimation ? *request.decimation : 1;
+        config.trigger = request.trigger ? *request.trigger : SCOPE_TRIG_HOST;
+        config.trigger_channel = request.trigger_channel ? *request.trigger_channel : 0;
+        config.level = request.level ? *request.level : 0;
+        config.pre_samples = request.pre_samples ? *request.pre_samples : 0;
+        rc = scope_arm(&config);
+    }
+    if (rc == 0 && request.force && *request.force)
+    {
+        scope_force();
+    }
+    if (request.resend)
+    {
+        scope_resend = *request.resend;
+    }
+    if (request.req_id && *request.req_id)
+    {
+        scope_reply_error = rc ? EINVAL : 0;
+        scope_reply_req_id = *request.req_id;
+    }
+}
+
+void fill_scope_event(ScopeEvent &event, uint32_t capture_id, uint8_t state)
+{
+    const ScopeConfig *config = scope_config();
+    event.capture_id = capture_id;
+    event.state = state;
+    event.channels = config->channels;
+    event.decimation = config->decimation;
+    event.pre_samples = config->pre_samples;
+    event.samples = scope_samples();
+}
+
+// main loop, from get_txd()
+int add_scope(BatchWriter &batch)
+{
+    scope_chunk_rows = 0;
+    uint32_t req_id = scope_reply_req_id;
+    if (req_id)
+    {
+        scope_reply_req_id = 0;
+        scope_reply_pending = req_id;
+        scope_reply_pending_error = scope_reply_error;
+    }
+    if (scope_reply_pending)
+    {
+        scope_reply.req_id = scope_reply_pending;
+        scope_reply.error_code = scope_reply_pending_error;
+        scope_reply.msg_type = ScopeRequest::MSG_ID;
+        if (batch.add(scope_reply) != 0)
+        {
+            return EINVAL;
+        }
+    }
+
+    uint32_t capture_id = scope_capture_id();
+    uint8_t state = scope_state();
+    if (capture_id != scope_sent_id)
+    {
+        scope_sent_id = capture_id;
+        scope_offset = 0;
+    }
+    int32_t resend = scope_resend;
+    if (resend >= 0)
+    {
+        scope_resend = -1;
+        scope_offset = resend;
+    }
+    if (state == SCOPE_ARMED || state == SCOPE_TRIGGERED)
+    {
+        fill_scope_event(scope_status, capture_id, state);
+        return batch.add(scope_status);
+    }
+    if (state != SCOPE_DONE || scope_offset >= scope_samples())
+    {
+        return 0;
+    }
+
+    uint8_t n_ch = __builtin_popcount(scope_config()->channels);
+    uint16_t rows = scope_read(scope_offset, scope_samples_buf, SCOPE_CHUNK_BYTES / 2 / n_ch);
+    if (rows == 0 || scope_capture_id() != capture_id)
+    {
+        return 0; // re-armed from the IRQ while copying
+    }
+    std::vector<uint8_t> data(rows * n_ch * 2);
+    for (size_t i = 0; i < rows * n_ch; i++)
+    {
+        data[2 * i] = (uint16_t)scope_samples_buf[i] & 0xFF;
+        data[2 * i + 1] = (uint16_t)scope_samples_buf[i] >> 8;
+    }
+    fill_scope_event(scope_chunk, capture_id, state);
+    scope_chunk.offset = scope_offset;
+    scope_chunk.data = data;
+    scope_chunk_rows = rows;
+    return batch.add(scope_chunk);
+}
+
+// main loop, once the frame of add_scope() is built
+void scope_sent()
+{
+    scope_reply_pending = 0;
+    scope_offset += scope_chunk_rows;
+    scope_chunk_rows = 0;
+}
+#endif
+
+#if defined(LIMERO_TRACE)
+// TRACE_CHANNELS sampled every TRACE_INTERVAL main loops and sent column
+// packed in a TraceEvent with each telemetry frame, 40 rows at the default
+// rates. A full column skips rows until the next frame.
+#define TRACE_INTERVAL 1
+#define TRACE_COLUMN_BYTES 64
+#define TRACE_ONE(name, value, shift) +1
+#define TRACE_VALUE(name, value, shift) value,
+#define TRACE_SHIFT(name, value, shift) shift,
+const uint8_t TRACE_CHANNEL_COUNT = 0 TRACE_CHANNELS(TRACE_ONE);
+const uint8_t trace_shifts[] = {TRACE_CHANNELS(TRACE_SHIFT)};
+ColumnPacker trace_packer(TRACE_CHANNEL_COUNT, TRACE_COLUMN_BYTES, trace_shifts);
+TraceEvent trace_event;
+std::vector<uint8_t> trace_columns;
+uint32_t trace_tick = 0; // main loop tick of the first row
+uint32_t trace_skipped = 0;
+
+// main loop, every pass
+extern "C" void limero_trace(uint32_t tick)
+{
+    if (tick % TRACE_INTERVAL)
+    {
+        return;
+    }
+    const int32_t row[] = {TRACE_CHANNELS(TRACE_VALUE)};
+    if (trace_packer.rows() == 0)
+    {
+        trace_tick = tick;
+    }
+    if (!trace_packer.add(row))
+    {
+        trace_skipped++;
+    }
+}
+
+int add_trace(BatchWriter &batch)
+{
+    if (trace_packer.rows() == 0)
+    {
+        return 0;
+    }
+    trace_packer.pack(trace_columns);
+    trace_event.tick = trace_tick;
+    trace_event.interval = TRACE_INTERVAL;
+    trace_event.rows = trace_packer.rows();
+    trace_event.channels = (1U << TRACE_CHANNEL_COUNT) - 1;
+    trace_event.shifts = trace_packer.shifts();
+    trace_event.columns = trace_columns;
+    trace_event.skipped = trace_skipped;
+    return batch.add(trace_event);
+}
+
+// main loop, once the frame of add_trace() is built. Until then the rows stay
+// in the packer and a dropped frame sends them with the next one.
+void trace_sent()
+{
+    trace_packer.clear();
+}
+#endif
+
+#if defined(LIMERO_STATS)
+// The 16 kHz statistics since the previous HoverboardEvent
+IsrStats isr_stats;
+std::vector<uint8_t> isr_stats_bytes(ISR_STATS_COUNT * 8);
+
+void fill_isr_stats(HoverboardEvent &hb_event)
+{
+    isr_stats_take(&isr_stats);
+    for (uint32_t i = 0; i < ISR_STATS_COUNT; i++)
+    {
+        const IsrStatsValue &value = isr_stats.value[i];
+        const uint16_t v[4] = {(uint16_t)value.min, (uint16_t)value.max, (uint16_t)value.mean, value.rms};
+        for (uint32_t k = 0; k < 4; k++)
+        {
+            isr_stats_bytes[i * 8 + k * 2] = (uint8_t)v[k];
+            isr_stats_bytes[i * 8 + k * 2 + 1] = (uint8_t)(v[k] >> 8);
+        }
+    }
+    hb_event.isr_stats_periods = (int32_t)isr_stats.periods;
+    hb_event.isr_stats = isr_stats_bytes;
+}
+#endif
+
+#if defined(ENERGY_COUNT) && defined(LIMERO_BATCH)
+// Sent with every LinkDiagEvent, the counters change slowly
+EnergyEvent energy_event;
+
+void fill_energy_event(EnergyEvent &event)
+{
+    EnergyTotals motor[2];
+    EnergyTotals total;
+    energy_read(motor);
+    energy_total(&total);
+    event.left_used_mah = motor[0].usedMah;
+    event.left_regen_mah = motor[0].regenMah;
+    event.left_used_mwh = motor[0].usedMwh;
+    event.left_regen_mwh = motor[0].regenMwh;
+    event.right_used_mah = motor[1].usedMah;
+    event.right_regen_mah = motor[1].regenMah;
+    event.right_used_mwh = motor[1].usedMwh;
+    event.right_regen_mwh = motor[1].regenMwh;
+    event.total_used_mah = total.usedMah;
+    event.total_regen_mah = total.regenMah;
+    event.total_used_mwh = total.usedMwh;
+    event.total_regen_mwh = total.regenMwh;
+}
+#endif
+
+#if defined(ISR_PROFILE)
+// One ProfStage per telemetry frame, all of them every 1.2 s at the default rates
+IsrProfileEvent isr_profile_event;
+std::vector<uint8_t> isr_profile_hist(PROF_HIST_BINS * 4);
+uint32_t isr_profile_stage = 0;
+
+int add_isr_profile(BatchWriter &batch)
+{
+    const ProfStats &stats = isr_prof[isr_profile_stage];
+    for (uint32_t i = 0; i < PROF_HIST_BINS; i++)
+    {
+        uint32_t n = stats.hist[i];
+        for (uint32_t b = 0; b < 4; b++)
+        {
+            isr_profile_hist[i * 4 + b] = (uint8_t)(n >> (8 * b));
+        }
+    }
+    isr_profile_event.stage = isr_profile_stage;
+    isr_profile_event.count = stats.count;
+    isr_profile_event.min = stats.min;
+    isr_profile_event.avg = stats.avg;
+    isr_profile_event.max = stats.max;
+    isr_profile_event.last = stats.last;
+    isr_profile_event.hist = isr_profile_hist;
+    isr_profile_event.bin_cycles = 1U << PROF_HIST_SHIFT;
+    isr_profile_event.budget_cycles = PROF_BUDGET_CYCLES;
+    return batch.add(isr_profile_event);
+}
+
+// main loop, once the frame of add_isr_profile() is built
+void isr_profile_sent()
+{
+    isr_profile_stage = (isr_profile_stage + 1) % PROF_STAGES;
+}
+#endif
+
 void fill_hb_event(HoverboardEvent &hb_event)
 {
     hb_event.ctrl_mod = ctrlModReqRaw;
@@ -97,6 +494,45 @@ void fill_hb_event(HoverboardEvent &hb_event)
     hb_event.str_coef = STEER_COEFFICIENT;
     hb_event.batv = batVoltageCalib;
     hb_event.temp = board_temp_deg_c;
+    hb_event.time_us = (uint32_t)board_time_us();
+    hb_event.overruns = (int32_t)overrunCnt;
+    hb_event.overrun_run_max = overrunRunMax;
+    hb_event.overrun_err = overrunErr;
+#if defined(OFFSET_TRACK)
+    hb_event.offset_drift = offsetDrift;
+    hb_event.offset_track_ms = (int32_t)(offsetTrackCnt / (PWM_FREQ / 1000));
+#endif
+    hb_event.boot_ms = (int32_t)bootReadyMs;
+#if defined(FAST_BOOT)
+    hb_event.offsets_stored = offsetFastBoot;
+#endif
+#if defined(HALL_CAPTURE)
+    hb_event.hall_rpm_l = hallSpeedL.rpm;
+    hb_event.hall_rpm_r = hallSpeedR.rpm;
+#endif
+#if defined(LIMERO_STATS)
+    fill_isr_stats(hb_event);
+#endif
+#if defined(LIMERO_ACK)
+    hb_event.req_gaps = req_gaps;
+    hb_event.req_superseded = req_superseded;
+#endif
+}
+
+void fill_link_diag(LinkDiagEvent &diag)
+{
+    diag.rx_bytes = link_stats.rx_bytes;
+    diag.rx_frames = link_stats.rx_frames;
+    diag.rx_cobs_errors = link_stats.rx_cobs_errors;
+    diag.rx_crc_errors = link_stats.rx_crc_errors;
+    diag.rx_overflows = link_stats.rx_overflows;
+    diag.rx_decode_errors = link_stats.rx_decode_errors;
+    diag.rx_unknown_msgs = link_stats.rx_unknown_msgs;
+    diag.tx_frames = link_stats.tx_frames;
+    diag.tx_dropped = link_stats.tx_dropped;
+    diag.tx_frame_max = link_stats.tx_frame_max;
+    diag.tx_queue_max = link_stats.tx_queue_max;
+    diag.tx_queue_dropped = link_stats.tx_queue_dropped;
 }
 
 void fill_endpoint_announce(EndpointAnnounce &ep_announce)
@@ -104,9 +540,32 @@ void fill_endpoint_announce(EndpointAnnounce &ep_announce)
     ep_announce.id = FNV("hoverboard");
     ep_announce.name = "hoverboard";
     ep_announce.description = "Hoverboard FOC Controller";
-    ep_announce.services = std::vector<uint32_t>{FNV("HoverboardRequest")};
-    ep_announce.events = std::vector<uint32_t>{FNV("HoverboardEvent")};
-    ep_announce.replies = std::vector<uint32_t>{FNV("HoverboardReply")};
+    std::vector<uint32_t> services{FNV("HoverboardRequest")};
+    std::vector<uint32_t> replies{FNV("HoverboardReply")};
+#if defined(LIMERO_BATCH)
+    services.push_back(FNV("PingRequest"));
+    replies.push_back(FNV("PingReply"));
+#endif
+    std::vector<uint32_t> events{FNV("HoverboardEvent"), FNV("LinkDiagEvent")};
+#if defined(LIMERO_ACK) || defined(LIMERO_SCOPE)
+    replies.push_back(FNV("GenericReply"));
+#endif
+#if defined(LIMERO_SCOPE)
+    services.push_back(FNV("ScopeRequest"));
+    events.push_back(FNV("ScopeEvent"));
+#endif
+#if defined(LIMERO_TRACE)
+    events.push_back(FNV("TraceEvent"));
+#endif
+#if defined(ISR_PROFILE)
+    events.push_back(FNV("IsrProfileEvent"));
+#endif
+#if defined(ENERGY_COUNT) && defined(LIMERO_BATCH)
+    events.push_back(FNV("EnergyEvent"));
+#endif
+    ep_announce.services = services;
+    ep_announce.events = events;
+    ep_announce.replies = replies;
 }
 
 Log logger(256);
@@ -117,16 +576,119 @@ bool send_announce()
     return (send_count++ % 10) == 0;
 }
 
+bool send_diag()
+{
+    static uint32_t send_count = 0;
+    return (send_count++ % 5) == 0;
+}
+
+// main loop, a frame was due but the UART was still sending the previous one
+extern "C" void limero_tx_busy(void)
+{
+    link_stats.tx_dropped++;
+}
+
 Envelope txd_envelope;
 HoverboardEvent hb_event;
 EndpointAnnounce ep_announce;
+LinkDiagEvent link_diag;
 Buffer txd_payload_buffer(200);
-Buffer txd_envelope_buffer(256);
+Buffer txd_envelope_buffer(2048); // announce + event + ACK_QUEUE_SIZE + PING_QUEUE_SIZE replies at ~680 bytes, + a scope chunk, a trace and an ISR profile
 Buffer rxd_envelope_buffer(120);
 Buffer rxd_payload_buffer(100);
 
-extern "C" uint32_t get_txd(uint8_t **buffer)
+#if defined(LIMERO_BATCH)
+BatchWriter txd_batch(640); // largest single message: a TraceEvent with full columns
+#endif
+
+uint32_t encode_txd(uint8_t **buffer)
 {
+#if defined(LIMERO_BATCH)
+    // everything due in this cycle goes out in one frame
+    txd_batch.clear();
+    if (send_announce())
+    {
+        fill_endpoint_announce(ep_announce);
+        if (txd_batch.add(ep_announce) != 0)
+        {
+            return 0;
+        }
+    }
+    fill_hb_event(hb_event);
+    if (txd_batch.add(hb_event) != 0)
+    {
+        return 0;
+    }
+    if (send_diag())
+    {
+        fill_link_diag(link_diag);
+        if (txd_batch.add(link_diag) != 0)
+        {
+            return 0;
+        }
+#if defined(ENERGY_COUNT)
+        fill_energy_event(energy_event);
+        if (txd_batch.add(energy_event) != 0)
+        {
+            return 0;
+        }
+#endif
+    }
+#if defined(LIMERO_TRACE)
+    if (add_trace(txd_batch) != 0)
+    {
+        return 0;
+    }
+#endif
+#if defined(LIMERO_SCOPE)
+    if (add_scope(txd_batch) != 0)
+    {
+        return 0;
+    }
+#endif
+#if defined(ISR_PROFILE)
+    if (add_isr_profile(txd_batch) != 0)
+    {
+        return 0;
+    }
+#endif
+    uint32_t queued = (ping_head - ping_tail + PING_QUEUE_SIZE) % PING_QUEUE_SIZE;
+#if defined(LIMERO_ACK)
+    queued += ack_count;
+    for (uint32_t i = 0; i < ack_count; i++)
+    {
+        ack_reply.req_id = ack_queue[i].req_id;
+        ack_reply.tick = ack_queue[i].tick;
+        if (txd_batch.add(ack_reply) != 0)
+        {
+            return 0;
+        }
+    }
+#endif
+    if (queued > link_stats.tx_queue_max)
+    {
+        link_stats.tx_queue_max = queued;
+    }
+    // last in the frame: everything after the stamp is batch, CRC and COBS encoding
+    uint8_t ping_sent = ping_head;
+    if (ping_tail != ping_sent)
+    {
+        uint64_t tx_us = board_time_us();
+        for (uint8_t i = ping_tail; i != ping_sent; i = (i + 1) % PING_QUEUE_SIZE)
+        {
+            PingReply &reply = ping_queue[i];
+            reply.tx_us = tx_us;
+            if (txd_batch.add(reply) != 0)
+            {
+                return 0;
+            }
+        }
+    }
+    if (txd_batch.encode(FNV("hoverboard"), txd_envelope_buffer) != 0)
+    {
+        return 0;
+    }
+#else
     txd_payload_buffer.clear();
 
     if (send_announce())
@@ -138,6 +700,15 @@ extern "C" uint32_t get_txd(uint8_t **buffer)
             return 0;
         }
     }
+    else if (send_diag())
+    {
+        txd_envelope.msg_type = LinkDiagEvent::MSG_ID;
+        fill_link_diag(link_diag);
+        if (link_diag.encode(txd_payload_buffer) != 0)
+        {
+            return 0;
+        }
+    }
     else
     {
         txd_envelope.msg_type = HoverboardEvent::MSG_ID;
@@ -154,6 +725,7 @@ extern "C" uint32_t get_txd(uint8_t **buffer)
     {
         return 0;
     }
+#endif
     // re-use the envelope_buffer to encode the frame
     FrameEncoder frame_encoder(txd_envelope_buffer.data(), txd_envelope_buffer.capacity(), txd_envelope_buffer.size());
     if (frame_encoder.add_crc().is_err())
@@ -164,10 +736,110 @@ extern "C" uint32_t get_txd(uint8_t **buffer)
     {
         return 0;
     }
+#if defined(LIMERO_BATCH)
+    // The frame is complete: only now drop what it carries from the queues, a
+    // frame that failed to build leaves them for the next one
+    ping_tail = ping_sent;
+#if defined(LIMERO_ACK)
+    ack_count = 0; // limero_applied() runs in the main loop too, nothing was queued meanwhile
+#endif
+#if defined(LIMERO_TRACE)
+    trace_sent();
+#endif
+#if defined(LIMERO_SCOPE)
+    scope_sent();
+#endif
+#if defined(ISR_PROFILE)
+    isr_profile_sent();
+#endif
+#endif
     *buffer = frame_encoder.data();
     return frame_encoder.size();
 }
 
+extern "C" uint32_t get_txd(uint8_t **buffer)
+{
+    uint32_t size = encode_txd(buffer);
+    if (size == 0)
+    {
+        link_stats.tx_dropped++;
+        return 0;
+    }
+    link_stats.tx_frames++;
+    if (size > link_stats.tx_frame_max)
+    {
+        link_stats.tx_frame_max = size;
+    }
+    return size;
+}
+
+void handle_rxd_msg(uint32_t msg_type, const Buffer &payload)
+{
+    if (msg_type == HoverboardRequest::MSG_ID)
+    {
+        HoverboardRequest request;
+
+        if (request.decode(payload) == 0)
+        {
+#if defined(LIMERO_ACK)
+            request.req_id.inspect([](const uint32_t &req_id)
+                                   { if (req_id) track_req_id(req_id); });
+#endif
+            // Handle the request
+            bool command_new = false; // limero_data_fresh may still be set from an earlier request
+            request.speed.inspect([&command_new](const int32_t &speed)
+                                  { limero_speed = speed;  
+                                limero_data_fresh = 1;
+                                command_new = true; });
+            request.steer.inspect([&command_new](const int32_t &steer)
+                                  { limero_steer = steer; 
+                                limero_data_fresh = 1;
+                                command_new = true; });
+            if (command_new)
+            {
+                sched_trigger(TASK_COMMAND); // stamp the arrival, with COMMAND_EVENT also release the command path
+            }
+        }
+        else
+        {
+            link_stats.rx_decode_errors++;
+        }
+    }
+#if defined(LIMERO_BATCH)
+    else if (msg_type == PingRequest::MSG_ID)
+    {
+        uint64_t rx_us = board_time_us();
+        PingRequest request;
+        if (request.decode(payload) == 0)
+        {
+            queue_ping(request, rx_us);
+        }
+        else
+        {
+            link_stats.rx_decode_errors++;
+        }
+    }
+#endif
+#if defined(LIMERO_SCOPE)
+    else if (msg_type == ScopeRequest::MSG_ID)
+    {
+        ScopeRequest request;
+        if (request.decode(payload) == 0)
+        {
+            handle_scope_request(request);
+        }
+        else
+        {
+            link_stats.rx_decode_errors++;
+        }
+    }
+#endif
+    else
+    {
+        link_stats.rx_unknown_msgs++;
+    }
+}
+
 void handle_rxd_frame(uint8_t *buffer, size_t size, size_t buffer_capacity)
 {
 
@@ -176,52 +848,62 @@ void handle_rxd_frame(uint8_t *buffer, size_t size, size_t buffer_capacity)
     Envelope envelope;
     if (envelope.decode(cbor_buffer) != 0)
     {
+        link_stats.rx_decode_errors++;
         return;
     }
 
     if (envelope.msg_type && envelope.payload)
     {
-        uint32_t msg_type = *envelope.msg_type;
-        Buffer payload = *envelope.payload;
-        if (msg_type == HoverboardRequest::MSG_ID)
-        {
-            HoverboardRequest request;
-
-            if (request.decode(payload) == 0)
-            {
-                // Handle the request
-                request.speed.inspect([](const int32_t &speed)
-                                      { limero_speed = speed;  
-                                    limero_data_fresh = 1; });
-                request.steer.inspect([](const int32_t &steer)
-                                      { limero_steer = steer; 
-                                    limero_data_fresh = 1; });
-            }
-            else
-            {
-                //
-            }
-        }
+        handle_rxd_msg(*envelope.msg_type, Buffer(*envelope.payload));
+        return;
     }
+    // no msg_type/payload: a BatchEnvelope carries msg_types/payloads instead
+    BatchEnvelope batch;
+    if (batch.decode(cbor_buffer) == 0 && batch_for_each(batch, handle_rxd_msg) == 0)
+    {
+        return;
+    }
+    link_stats.rx_decode_errors++;
 }
 
 void handle_rxd_byte(uint8_t byte)
 {
     #define FRAME_BUFFER_SIZE 256
     static FrameDecoder frame_decoder(FRAME_BUFFER_SIZE);
+    static bool overflow = false; // drop the rest of an oversized frame, up to its delimiter
+    link_stats.rx_bytes++;
     if (byte == 0x00)
     {
         // End of frame, process the accumulated bytes
-        if (frame_decoder.decode_cobs().is_ok() && frame_decoder.check_crc().is_ok())
+        if (overflow)
+        {
+            overflow = false;
+        }
+        else if (frame_decoder.size() == 0)
         {
+            // back to back delimiters, nothing lost
+        }
+        else if (frame_decoder.decode_cobs().is_err())
+        {
+            link_stats.rx_cobs_errors++;
+        }
+        else if (frame_decoder.check_crc().is_err())
+        {
+            link_stats.rx_crc_errors++;
+        }
+        else
+        {
+            link_stats.rx_frames++;
             handle_rxd_frame(frame_decoder.data(), frame_decoder.size(), FRAME_BUFFER_SIZE);
         }
         frame_decoder.rewind();
     }
-    else
+    else if (!overflow)
     {
         if (frame_decoder.add_byte(byte).is_err())
         {
+            link_stats.rx_overflows++;
+            overflow = true;
             frame_decoder.rewind();
         }
     }
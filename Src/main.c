@@ -30,6 +30,11 @@
 #include "BLDC_controller.h"      /* BLDC's header file */
 #include "rtwtypes.h"
 #include "comms.h"
+#include "isr_profile.h"
+#include "scheduler.h"
+#ifdef ADC_OVERSAMPLE
+#include "oversample.h"
+#endif
 
 #if defined(DEBUG_I2C_LCD) || defined(SUPPORT_LCD)
 #include "hd44780.h"
@@ -103,7 +108,8 @@ extern volatile uint16_t pwm_captured_ch2_value;
 // Global variables set here in main.c
 //------------------------------------------------------------------------
 uint8_t backwardDrive;
-extern volatile uint32_t buzzerTimer;
+extern uint16_t overrunRunMax;          // longest run of control ISR overruns
+uint8_t overrunErr;                     // OVERRUN_POLICY applied: 0 = OK, 1 = control ISR overran OVERRUN_DEGRADE_RUN periods in a row
 volatile uint32_t main_loop_counter;
 int16_t batVoltageCalib;         // global variable for calibrated battery voltage
 int16_t board_temp_deg_c;        // global variable for calibrated temperature in degrees Celsius
@@ -158,484 +164,633 @@ static int32_t  steerFixdt;           // local fixed-point variable for steering
 static int32_t  speedFixdt;           // local fixed-point variable for speed low-pass filter
 #endif
 
-static uint32_t    buzzerTimer_prev = 0;
 static uint32_t    inactivity_timeout_counter;
 static MultipleTap MultipleTapBrake;    // define multiple tap functionality for the Brake pedal
 
 static uint16_t rate = RATE; // Adjustable rate to support multiple drive modes on startup
 
+uint32_t bootReadyMs = 0;    // HAL_GetTick() when the motors were enabled the first time
+
+#ifdef FAST_BOOT
+extern volatile uint8_t offsetSaveReq;
+uint8_t offsetsGet(int16_t offsets[6]);
+static const BuzzerTone poweronTones[] = {{8, 100}, {7, 100}, {6, 100}, {5, 100}, {4, 100}, {3, 100}, {2, 100}, {1, 100}, {0, 0}};
+static const BuzzerTone enableTones[]  = {{6, 100}, {4, 100}, {0, 0}};
+#endif
+
 #ifdef MULTI_MODE_DRIVE
 static uint8_t drive_mode;
 static uint16_t max_speed;
 #endif
 
 
-int main(void) {
-
-  HAL_Init();
-  __HAL_RCC_AFIO_CLK_ENABLE();
-  HAL_NVIC_SetPriorityGrouping(NVIC_PRIORITYGROUP_4);
-  /* System interrupt init*/
-  /* MemoryManagement_IRQn interrupt configuration */
-  HAL_NVIC_SetPriority(MemoryManagement_IRQn, 0, 0);
-  /* BusFault_IRQn interrupt configuration */
-  HAL_NVIC_SetPriority(BusFault_IRQn, 0, 0);
-  /* UsageFault_IRQn interrupt configuration */
-  HAL_NVIC_SetPriority(UsageFault_IRQn, 0, 0);
-  /* SVCall_IRQn interrupt configuration */
-  HAL_NVIC_SetPriority(SVCall_IRQn, 0, 0);
-  /* DebugMonitor_IRQn interrupt configuration */
-  HAL_NVIC_SetPriority(DebugMonitor_IRQn, 0, 0);
-  /* PendSV_IRQn interrupt configuration */
-  HAL_NVIC_SetPriority(PendSV_IRQn, 0, 0);
-  /* SysTick_IRQn interrupt configuration */
-  HAL_NVIC_SetPriority(SysTick_IRQn, 0, 0);
-
-  SystemClock_Config();
-
-  __HAL_RCC_DMA1_CLK_DISABLE();
-  MX_GPIO_Init();
-  MX_TIM_Init();
-  MX_ADC1_Init();
-  MX_ADC2_Init();
-  BLDC_Init();        // BLDC Controller Init
-
-  HAL_GPIO_WritePin(OFF_PORT, OFF_PIN, GPIO_PIN_SET);   // Activate Latch
-  Input_Lim_Init();   // Input Limitations Init
-  Input_Init();       // Input Init
-
-  HAL_ADC_Start(&hadc1);
-  HAL_ADC_Start(&hadc2);
-
-  poweronMelody();
-  HAL_GPIO_WritePin(LED_PORT, LED_PIN, GPIO_PIN_SET);
-
-  int32_t board_temp_adcFixdt = adc_buffer.temp << 16;  // Fixed-point filter output initialized with current ADC converted to fixed-point
-  int16_t board_temp_adcFilt = adc_buffer.temp;
-
-#ifdef MULTI_MODE_DRIVE
-  if (adc_buffer.l_tx2 > input1[0].min + 50 && adc_buffer.l_rx2 > input2[0].min + 50) {
-    drive_mode = 2;
-    max_speed = MULTI_MODE_DRIVE_M3_MAX;
-    rate = MULTI_MODE_DRIVE_M3_RATE;
-    rtP_Left.n_max = rtP_Right.n_max = MULTI_MODE_M3_N_MOT_MAX << 4;
-    rtP_Left.i_max = rtP_Right.i_max = (MULTI_MODE_M3_I_MOT_MAX * A2BIT_CONV) << 4;
-  }
-  else if (adc_buffer.l_tx2 > input1[0].min + 50) {
-    drive_mode = 1;
-    max_speed = MULTI_MODE_DRIVE_M2_MAX;
-    rate = MULTI_MODE_DRIVE_M2_RATE;
-    rtP_Left.n_max = rtP_Right.n_max = MULTI_MODE_M2_N_MOT_MAX << 4;
-    rtP_Left.i_max = rtP_Right.i_max = (MULTI_MODE_M2_I_MOT_MAX * A2BIT_CONV) << 4;
-  }
-  else {
-    drive_mode = 0;
-    max_speed = MULTI_MODE_DRIVE_M1_MAX;
-    rate = MULTI_MODE_DRIVE_M1_RATE;
-    rtP_Left.n_max = rtP_Right.n_max = MULTI_MODE_M1_N_MOT_MAX << 4;
-    rtP_Left.i_max = rtP_Right.i_max = (MULTI_MODE_M1_I_MOT_MAX * A2BIT_CONV) << 4;
-  }
-
-  printf("Drive mode %i selected: max_speed:%i acc_rate:%i \r\n", drive_mode, max_speed, rate);
+#if defined(FEEDBACK_LIMERO)
+extern uint32_t get_txd(uint8_t **txd);
+extern void limero_tx_busy(void);
+#if defined(LIMERO_TRACE)
+extern void limero_trace(uint32_t tick);
+#endif
 #endif
 
-  // Loop until button is released
- // while (HAL_GPIO_ReadPin(BUTTON_PORT, BUTTON_PIN)) { HAL_Delay(10); }
+static int32_t board_temp_adcFixdt;   // Fixed-point temperature filter output, initialized in main()
+static int16_t board_temp_adcFilt;
 
-#ifdef MULTI_MODE_DRIVE
-  // Wait until triggers are released. Exit if timeout elapses (to unblock if the inputs are not calibrated)
-  int iTimeout = 0;
-  while ((adc_buffer.l_rx2 + adc_buffer.l_tx2) >= (input1[0].min + input2[0].min) && iTimeout++ < 300) {
-    HAL_Delay(10);
+//------------------------------------------------------------------------
+// Main loop tasks, run by sched_run() at the periods of schedTasks[]
+//------------------------------------------------------------------------
+static void taskCommand(void) {
+  readCommand();                        // Read Command: input1[inIdx].cmd, input2[inIdx].cmd
+  calcAvgSpeed();                       // Calculate average measured speed: speedAvg, speedAvgAbs
+
+#ifdef FAST_BOOT
+  // ####### CURRENT OFFSETS: store a full calibration before the motors run, flash writes stall the CPU #######
+  // Without the power-on melody nothing else waits for the calibration. Read before offsetSaveReq:
+  // the interrupt that ends the calibration sets both.
+  int16_t offsets[6];
+  uint8_t offsetsReady = offsetsGet(offsets);
+  if (offsetSaveReq && enable == 0) {
+    offsetSaveReq = 0;
+    offsetsSave();
   }
 #endif
 
-  while (1) {
-    if (buzzerTimer - buzzerTimer_prev > 16 * DELAY_IN_MAIN_LOOP) {   // 1 ms = 16 ticks buzzerTimer
-
-      readCommand();                        // Read Command: input1[inIdx].cmd, input2[inIdx].cmd
-      calcAvgSpeed();                       // Calculate average measured speed: speedAvg, speedAvgAbs
-
 #ifndef VARIANT_TRANSPOTTER
-      // ####### MOTOR ENABLING: Only if the initial input is very small (for SAFETY) #######
-      if (enable == 0 && !rtY_Left.z_errCode && !rtY_Right.z_errCode &&
-        ABS(input1[inIdx].cmd) < 50 && ABS(input2[inIdx].cmd) < 50) {
-        beepShort(6);                     // make 2 beeps indicating the motor enable
-        beepShort(4); HAL_Delay(100);
-        steerFixdt = speedFixdt = 0;      // reset filters
-        enable = 1;                       // enable motors
+  // ####### MOTOR ENABLING: Only if the initial input is very small (for SAFETY) #######
+  if (enable == 0 && !rtY_Left.z_errCode && !rtY_Right.z_errCode && !(OVERRUN_POLICY >= 3 && overrunErr) &&
+    #ifdef FAST_BOOT
+    offsetsReady &&
+    #endif
+    ABS(input1[inIdx].cmd) < 50 && ABS(input2[inIdx].cmd) < 50) {
+    #ifdef FAST_BOOT
+    playTones(enableTones);           // make 2 beeps indicating the motor enable
+    #else
+    beepShort(6);                     // make 2 beeps indicating the motor enable
+    beepShort(4); HAL_Delay(100);
+    #endif
+    steerFixdt = speedFixdt = 0;      // reset filters
+    enable = 1;                       // enable motors
+    if (bootReadyMs == 0) {
+      bootReadyMs = HAL_GetTick();
+    }
 #if defined(DEBUG_SERIAL_USART2) || defined(DEBUG_SERIAL_USART3)
-        printf("-- Motors enabled --\r\n");
+    printf("-- Motors enabled --\r\n");
 #endif
-      }
+  }
+#endif
+}
 
-      // ####### VARIANT_HOVERCAR #######
+static void taskMixer(void) {
+#ifndef VARIANT_TRANSPOTTER
+  // ####### VARIANT_HOVERCAR #######
 #if defined(VARIANT_HOVERCAR) || defined(VARIANT_SKATEBOARD) || defined(ELECTRIC_BRAKE_ENABLE)
-      uint16_t speedBlend;                                        // Calculate speed Blend, a number between [0, 1] in fixdt(0,16,15)
-      speedBlend = (uint16_t)(((CLAMP(speedAvgAbs, 10, 60) - 10) << 15) / 50); // speedBlend [0,1] is within [10 rpm, 60rpm]
+  uint16_t speedBlend;                                        // Calculate speed Blend, a number between [0, 1] in fixdt(0,16,15)
+  speedBlend = (uint16_t)(((CLAMP(speedAvgAbs, 10, 60) - 10) << 15) / 50); // speedBlend [0,1] is within [10 rpm, 60rpm]
 #endif
 
 #ifdef STANDSTILL_HOLD_ENABLE
-      standstillHold();                                           // Apply Standstill Hold functionality. Only available and makes sense for VOLTAGE or TORQUE Mode
+  standstillHold();                                           // Apply Standstill Hold functionality. Only available and makes sense for VOLTAGE or TORQUE Mode
 #endif
 
 #ifdef VARIANT_HOVERCAR
-      if (inIdx == CONTROL_ADC) {                                   // Only use use implementation below if pedals are in use (ADC input)
-        if (speedAvgAbs < 60) {                                     // Check if Hovercar is physically close to standstill to enable Double tap detection on Brake pedal for Reverse functionality
-          multipleTapDet(input1[inIdx].cmd, HAL_GetTick(), &MultipleTapBrake); // Brake pedal in this case is "input1" variable
-        }
+  if (inIdx == CONTROL_ADC) {                                   // Only use use implementation below if pedals are in use (ADC input)
+    if (speedAvgAbs < 60) {                                     // Check if Hovercar is physically close to standstill to enable Double tap detection on Brake pedal for Reverse functionality
+      multipleTapDet(input1[inIdx].cmd, HAL_GetTick(), &MultipleTapBrake); // Brake pedal in this case is "input1" variable
+    }
 
-        if (input1[inIdx].cmd > 30) {                               // If Brake pedal (input1) is pressed, bring to 0 also the Throttle pedal (input2) to avoid "Double pedal" driving
-          input2[inIdx].cmd = (int16_t)((input2[inIdx].cmd * speedBlend) >> 15);
-          cruiseControl((uint8_t)rtP_Left.b_cruiseCtrlEna);         // Cruise control deactivated by Brake pedal if it was active
-        }
-      }
+    if (input1[inIdx].cmd > 30) {                               // If Brake pedal (input1) is pressed, bring to 0 also the Throttle pedal (input2) to avoid "Double pedal" driving
+      input2[inIdx].cmd = (int16_t)((input2[inIdx].cmd * speedBlend) >> 15);
+      cruiseControl((uint8_t)rtP_Left.b_cruiseCtrlEna);         // Cruise control deactivated by Brake pedal if it was active
+    }
+  }
 #endif
 
 #ifdef ELECTRIC_BRAKE_ENABLE
-      electricBrake(speedBlend, MultipleTapBrake.b_multipleTap);  // Apply Electric Brake. Only available and makes sense for TORQUE Mode
+  electricBrake(speedBlend, MultipleTapBrake.b_multipleTap);  // Apply Electric Brake. Only available and makes sense for TORQUE Mode
 #endif
 
 #ifdef VARIANT_HOVERCAR
-      if (inIdx == CONTROL_ADC) {                                   // Only use use implementation below if pedals are in use (ADC input)
-        if (speedAvg > 0) {                                         // Make sure the Brake pedal is opposite to the direction of motion AND it goes to 0 as we reach standstill (to avoid Reverse driving by Brake pedal) 
-          input1[inIdx].cmd = (int16_t)((-input1[inIdx].cmd * speedBlend) >> 15);
-        }
-        else {
-          input1[inIdx].cmd = (int16_t)((input1[inIdx].cmd * speedBlend) >> 15);
-        }
-      }
+  if (inIdx == CONTROL_ADC) {                                   // Only use use implementation below if pedals are in use (ADC input)
+    if (speedAvg > 0) {                                         // Make sure the Brake pedal is opposite to the direction of motion AND it goes to 0 as we reach standstill (to avoid Reverse driving by Brake pedal) 
+      input1[inIdx].cmd = (int16_t)((-input1[inIdx].cmd * speedBlend) >> 15);
+    }
+    else {
+      input1[inIdx].cmd = (int16_t)((input1[inIdx].cmd * speedBlend) >> 15);
+    }
+  }
 #endif
 
 #ifdef VARIANT_SKATEBOARD
-      if (input2[inIdx].cmd < 0) {                                // When Throttle is negative, it acts as brake. This condition is to make sure it goes to 0 as we reach standstill (to avoid Reverse driving) 
-        if (speedAvg > 0) {                                       // Make sure the braking is opposite to the direction of motion
-          input2[inIdx].cmd = (int16_t)((input2[inIdx].cmd * speedBlend) >> 15);
-        }
-        else {
-          input2[inIdx].cmd = (int16_t)((-input2[inIdx].cmd * speedBlend) >> 15);
-        }
-      }
+  if (input2[inIdx].cmd < 0) {                                // When Throttle is negative, it acts as brake. This condition is to make sure it goes to 0 as we reach standstill (to avoid Reverse driving) 
+    if (speedAvg > 0) {                                       // Make sure the braking is opposite to the direction of motion
+      input2[inIdx].cmd = (int16_t)((input2[inIdx].cmd * speedBlend) >> 15);
+    }
+    else {
+      input2[inIdx].cmd = (int16_t)((-input2[inIdx].cmd * speedBlend) >> 15);
+    }
+  }
 #endif
 
-      // ####### LOW-PASS FILTER #######
-      rateLimiter16(input1[inIdx].cmd, rate, &steerRateFixdt);
-      rateLimiter16(input2[inIdx].cmd, rate, &speedRateFixdt);
-      filtLowPass32(steerRateFixdt >> 4, FILTER, &steerFixdt);
-      filtLowPass32(speedRateFixdt >> 4, FILTER, &speedFixdt);
-      steer = (int16_t)(steerFixdt >> 16);  // convert fixed-point to integer
-      speed = (int16_t)(speedFixdt >> 16);  // convert fixed-point to integer
+  // ####### LOW-PASS FILTER #######
+  rateLimiter16(input1[inIdx].cmd, rate, &steerRateFixdt);
+  rateLimiter16(input2[inIdx].cmd, rate, &speedRateFixdt);
+  filtLowPass32(steerRateFixdt >> 4, FILTER, &steerFixdt);
+  filtLowPass32(speedRateFixdt >> 4, FILTER, &speedFixdt);
+  steer = (int16_t)(steerFixdt >> 16);  // convert fixed-point to integer
+  speed = (int16_t)(speedFixdt >> 16);  // convert fixed-point to integer
 
-      // ####### VARIANT_HOVERCAR #######
+  // ####### VARIANT_HOVERCAR #######
 #ifdef VARIANT_HOVERCAR
-      if (inIdx == CONTROL_ADC) {               // Only use use implementation below if pedals are in use (ADC input)
+  if (inIdx == CONTROL_ADC) {               // Only use use implementation below if pedals are in use (ADC input)
 
 #ifdef MULTI_MODE_DRIVE
-        if (speed >= max_speed) {
-          speed = max_speed;
-        }
+    if (speed >= max_speed) {
+      speed = max_speed;
+    }
 #endif
 
-        if (!MultipleTapBrake.b_multipleTap) {  // Check driving direction
-          speed = steer + speed;                // Forward driving: in this case steer = Brake, speed = Throttle
-        }
-        else {
-          speed = steer - speed;                // Reverse driving: in this case steer = Brake, speed = Throttle
-        }
-        steer = 0;                              // Do not apply steering to avoid side effects if STEER_COEFFICIENT is NOT 0
-      }
+    if (!MultipleTapBrake.b_multipleTap) {  // Check driving direction
+      speed = steer + speed;                // Forward driving: in this case steer = Brake, speed = Throttle
+    }
+    else {
+      speed = steer - speed;                // Reverse driving: in this case steer = Brake, speed = Throttle
+    }
+    steer = 0;                              // Do not apply steering to avoid side effects if STEER_COEFFICIENT is NOT 0
+  }
 #endif
 
 #if defined(TANK_STEERING) && !defined(VARIANT_HOVERCAR) && !defined(VARIANT_SKATEBOARD) 
-      // Tank steering (no mixing)
-      cmdL = steer;
-      cmdR = speed;
+  // Tank steering (no mixing)
+  cmdL = steer;
+  cmdR = speed;
 #else 
-      // ####### MIXER #######
-      mixerFcn(speed << 4, steer << 4, &cmdR, &cmdL);   // This function implements the equations above
+  // ####### MIXER #######
+  mixerFcn(speed << 4, steer << 4, &cmdR, &cmdL);   // This function implements the equations above
 #endif
 
 
-      // ####### SET OUTPUTS (if the target change is less than +/- 100) #######
+  // ####### SET OUTPUTS (if the target change is less than +/- 100) #######
 #ifdef INVERT_R_DIRECTION
-      pwmr = cmdR;
+  pwmr = cmdR;
 #else
-      pwmr = -cmdR;
+  pwmr = -cmdR;
 #endif
 #ifdef INVERT_L_DIRECTION
-      pwml = -cmdL;
+  pwml = -cmdL;
 #else
-      pwml = cmdL;
+  pwml = cmdL;
 #endif
 #endif
 
 #ifdef VARIANT_TRANSPOTTER
-      distance = CLAMP(input1[inIdx].cmd - 180, 0, 4095);
-      steering = (input2[inIdx].cmd - 2048) / 2048.0;
-      distanceErr = distance - (int)(setDistance * 1345);
-
-      if (nunchuk_connected == 0) {
-        cmdL = cmdL * 0.8f + (CLAMP(distanceErr + (steering * ((float)MAX(ABS(distanceErr), 50)) * ROT_P), -850, 850) * -0.2f);
-        cmdR = cmdR * 0.8f + (CLAMP(distanceErr - (steering * ((float)MAX(ABS(distanceErr), 50)) * ROT_P), -850, 850) * -0.2f);
-        if (distanceErr > 0) {
-          enable = 1;
-        }
-        if (distanceErr > -300) {
+  distance = CLAMP(input1[inIdx].cmd - 180, 0, 4095);
+  steering = (input2[inIdx].cmd - 2048) / 2048.0;
+  distanceErr = distance - (int)(setDistance * 1345);
+
+  if (nunchuk_connected == 0) {
+    cmdL = cmdL * 0.8f + (CLAMP(distanceErr + (steering * ((float)MAX(ABS(distanceErr), 50)) * ROT_P), -850, 850) * -0.2f);
+    cmdR = cmdR * 0.8f + (CLAMP(distanceErr - (steering * ((float)MAX(ABS(distanceErr), 50)) * ROT_P), -850, 850) * -0.2f);
+    if (distanceErr > 0) {
+      enable = 1;
+    }
+    if (distanceErr > -300) {
 #ifdef INVERT_R_DIRECTION
-          pwmr = cmdR;
+      pwmr = cmdR;
 #else
-          pwmr = -cmdR;
+      pwmr = -cmdR;
 #endif
 #ifdef INVERT_L_DIRECTION
-          pwml = -cmdL;
+      pwml = -cmdL;
 #else
-          pwml = cmdL;
+      pwml = cmdL;
 #endif
 
-          if (checkRemote) {
-            if (!HAL_GPIO_ReadPin(LED_PORT, LED_PIN)) {
-              //enable = 1;
-            }
-            else {
-              enable = 0;
-            }
-          }
+      if (checkRemote) {
+        if (!HAL_GPIO_ReadPin(LED_PORT, LED_PIN)) {
+          //enable = 1;
         }
         else {
           enable = 0;
         }
-        timeoutCntGen = 0;
-        timeoutFlgGen = 0;
       }
+    }
+    else {
+      enable = 0;
+    }
+    timeoutCntGen = 0;
+    timeoutFlgGen = 0;
+  }
 
-      if (timeoutFlgGen) {
-        pwml = 0;
-        pwmr = 0;
-        enable = 0;
+  if (timeoutFlgGen) {
+    pwml = 0;
+    pwmr = 0;
+    enable = 0;
 #ifdef SUPPORT_LCD
-        LCD_SetLocation(&lcd, 0, 0); LCD_WriteString(&lcd, "Len:");
-        LCD_SetLocation(&lcd, 8, 0); LCD_WriteString(&lcd, "m(");
-        LCD_SetLocation(&lcd, 14, 0); LCD_WriteString(&lcd, "m)");
+    LCD_SetLocation(&lcd, 0, 0); LCD_WriteString(&lcd, "Len:");
+    LCD_SetLocation(&lcd, 8, 0); LCD_WriteString(&lcd, "m(");
+    LCD_SetLocation(&lcd, 14, 0); LCD_WriteString(&lcd, "m)");
 #endif
-        HAL_Delay(1000);
-        nunchuk_connected = 0;
-      }
+    HAL_Delay(1000);
+    nunchuk_connected = 0;
+  }
 
-      if ((distance / 1345.0) - setDistance > 0.5 && (lastDistance / 1345.0) - setDistance > 0.5) { // Error, robot too far away!
-        enable = 0;
-        beepLong(5);
+  if ((distance / 1345.0) - setDistance > 0.5 && (lastDistance / 1345.0) - setDistance > 0.5) { // Error, robot too far away!
+    enable = 0;
+    beepLong(5);
 #ifdef SUPPORT_LCD
-        LCD_ClearDisplay(&lcd);
-        HAL_Delay(5);
-        LCD_SetLocation(&lcd, 0, 0); LCD_WriteString(&lcd, "Emergency Off!");
-        LCD_SetLocation(&lcd, 0, 1); LCD_WriteString(&lcd, "Keeper too fast.");
+    LCD_ClearDisplay(&lcd);
+    HAL_Delay(5);
+    LCD_SetLocation(&lcd, 0, 0); LCD_WriteString(&lcd, "Emergency Off!");
+    LCD_SetLocation(&lcd, 0, 1); LCD_WriteString(&lcd, "Keeper too fast.");
 #endif
-        poweroff();
-      }
+    poweroff();
+  }
 
 #ifdef SUPPORT_NUNCHUK
-      if (transpotter_counter % 500 == 0) {
-        if (nunchuk_connected == 0 && enable == 0) {
-          if (Nunchuk_Read() == NUNCHUK_CONNECTED) {
+  if (transpotter_counter % 500 == 0) {
+    if (nunchuk_connected == 0 && enable == 0) {
+      if (Nunchuk_Read() == NUNCHUK_CONNECTED) {
 #ifdef SUPPORT_LCD
-            LCD_SetLocation(&lcd, 0, 0); LCD_WriteString(&lcd, "Nunchuk Control");
+        LCD_SetLocation(&lcd, 0, 0); LCD_WriteString(&lcd, "Nunchuk Control");
 #endif
-            nunchuk_connected = 1;
-          }
-        }
-        else {
-          nunchuk_connected = 0;
-        }
+        nunchuk_connected = 1;
       }
     }
-#endif
-
-#ifdef SUPPORT_LCD
-    if (transpotter_counter % 100 == 0) {
-      if (LCDerrorFlag == 1 && enable == 0) {
-
-      }
-      else {
-        if (nunchuk_connected == 0) {
-          LCD_SetLocation(&lcd, 4, 0); LCD_WriteFloat(&lcd, distance / 1345.0, 2);
-          LCD_SetLocation(&lcd, 10, 0); LCD_WriteFloat(&lcd, setDistance, 2);
-        }
-        LCD_SetLocation(&lcd, 4, 1); LCD_WriteFloat(&lcd, batVoltage, 1);
-        // LCD_SetLocation(&lcd, 11, 1); LCD_WriteFloat(&lcd,MAX(ABS(currentR), ABS(currentL)),2);
-      }
+    else {
+      nunchuk_connected = 0;
     }
+  }
 #endif
-    transpotter_counter++;
+  transpotter_counter++;
 #endif
 
-    // ####### SIDEBOARDS HANDLING #######
+  inIdx_prev = inIdx;
+}
+
+static void taskSideboard(void) {
+  // ####### SIDEBOARDS HANDLING #######
 #if defined(SIDEBOARD_SERIAL_USART2)
-    sideboardSensors((uint8_t)Sideboard_L.sensors);
+  sideboardSensors((uint8_t)Sideboard_L.sensors);
 #endif
 #if defined(FEEDBACK_SERIAL_USART2)
-    sideboardLeds(&sideboard_leds_L);
+  sideboardLeds(&sideboard_leds_L);
 #endif
 #if defined(SIDEBOARD_SERIAL_USART3)
-    sideboardSensors((uint8_t)Sideboard_R.sensors);
+  sideboardSensors((uint8_t)Sideboard_R.sensors);
 #endif
 #if defined(FEEDBACK_SERIAL_USART3)
-    sideboardLeds(&sideboard_leds_R);
+  sideboardLeds(&sideboard_leds_R);
 #endif
+}
 
+static void taskMeasure(void) {
+  // ####### CALC BOARD TEMPERATURE #######
+  #ifdef ADC_OVERSAMPLE
+  filtLowPass32(oversample_temp(), TEMP_FILT_COEF, &board_temp_adcFixdt);
+  #else
+  filtLowPass32(adc_buffer.temp, TEMP_FILT_COEF, &board_temp_adcFixdt);
+  #endif
+  board_temp_adcFilt = (int16_t)(board_temp_adcFixdt >> 16);  // convert fixed-point to integer
+  board_temp_deg_c = (TEMP_CAL_HIGH_DEG_C - TEMP_CAL_LOW_DEG_C) * (board_temp_adcFilt - TEMP_CAL_LOW_ADC) / (TEMP_CAL_HIGH_ADC - TEMP_CAL_LOW_ADC) + TEMP_CAL_LOW_DEG_C;
 
-    // ####### CALC BOARD TEMPERATURE #######
-    filtLowPass32(adc_buffer.temp, TEMP_FILT_COEF, &board_temp_adcFixdt);
-    board_temp_adcFilt = (int16_t)(board_temp_adcFixdt >> 16);  // convert fixed-point to integer
-    board_temp_deg_c = (TEMP_CAL_HIGH_DEG_C - TEMP_CAL_LOW_DEG_C) * (board_temp_adcFilt - TEMP_CAL_LOW_ADC) / (TEMP_CAL_HIGH_ADC - TEMP_CAL_LOW_ADC) + TEMP_CAL_LOW_DEG_C;
+  // ####### CALC CALIBRATED BATTERY VOLTAGE #######
+  batVoltageCalib = batVoltage * BAT_CALIB_REAL_VOLTAGE / BAT_CALIB_ADC;
 
-    // ####### CALC CALIBRATED BATTERY VOLTAGE #######
-    batVoltageCalib = batVoltage * BAT_CALIB_REAL_VOLTAGE / BAT_CALIB_ADC;
+  // ####### CALC DC LINK CURRENT #######
+  left_dc_curr = -(rtU_Left.i_DCLink * 100) / A2BIT_CONV;   // Left DC Link Current * 100 
+  right_dc_curr = -(rtU_Right.i_DCLink * 100) / A2BIT_CONV;  // Right DC Link Current * 100
+  dc_curr = left_dc_curr + right_dc_curr;            // Total DC Link Current * 100
 
-    // ####### CALC DC LINK CURRENT #######
-    left_dc_curr = -(rtU_Left.i_DCLink * 100) / A2BIT_CONV;   // Left DC Link Current * 100 
-    right_dc_curr = -(rtU_Right.i_DCLink * 100) / A2BIT_CONV;  // Right DC Link Current * 100
-    dc_curr = left_dc_curr + right_dc_curr;            // Total DC Link Current * 100
+#if defined(FEEDBACK_LIMERO) && defined(LIMERO_TRACE)
+  limero_trace(main_loop_counter);      // one row per control pass
+#endif
+}
 
-    // ####### DEBUG SERIAL OUT #######
+static void taskSafety(void) {
+  // ####### POWEROFF BY POWER-BUTTON #######
+ //   poweroffPressCheck();
+
+  // ####### CONTROL ISR OVERRUN: fall back to cheaper control once #######
+  if (OVERRUN_POLICY >= 1 && !overrunErr && overrunRunMax >= OVERRUN_DEGRADE_RUN) {
+    overrunErr = 1;
+    rtP_Left.b_fieldWeakEna  = 0;
+    rtP_Right.b_fieldWeakEna = 0;
+    if (OVERRUN_POLICY >= 2 && rtP_Left.z_ctrlTypSel == FOC_CTRL) {
+      rtP_Left.z_ctrlTypSel  = SIN_CTRL;
+      rtP_Right.z_ctrlTypSel = SIN_CTRL;
+    }
+    if (OVERRUN_POLICY >= 3) {
+      enable = 0;                       // stays off, see MOTOR ENABLING
+    }
 #if defined(DEBUG_SERIAL_USART2) || defined(DEBUG_SERIAL_USART3)
-    if (main_loop_counter % 25 == 0) {    // Send data periodically every 125 ms      
-#if defined(DEBUG_SERIAL_PROTOCOL)
-      process_debug();
-#else
-      printf("in1:%i in2:%i cmdL:%i cmdR:%i BatADC:%i BatV:%i TempADC:%i Temp:%i \r\n",
-        input1[inIdx].raw,        // 1: INPUT1
-        input2[inIdx].raw,        // 2: INPUT2
-        cmdL,                     // 3: output command: [-1000, 1000]
-        cmdR,                     // 4: output command: [-1000, 1000]
-        adc_buffer.batt1,         // 5: for battery voltage calibration
-        batVoltageCalib,          // 6: for verifying battery voltage calibration
-        board_temp_adcFilt,       // 7: for board temperature calibration
-        board_temp_deg_c);        // 8: for verifying board temperature calibration
+    printf("Control ISR overrun, degraded control\r\n");
 #endif
-    }
+  }
+
+  // ####### BEEP AND EMERGENCY POWEROFF #######
+  uint8_t tonesPlaying = playTonesUpdate();  // every pass, a melody keeps its timing under the warning beeps
+  if (TEMP_POWEROFF_ENABLE && board_temp_deg_c >= TEMP_POWEROFF && speedAvgAbs < 20) {  // poweroff before mainboard burns OR low bat 3
+#if defined(DEBUG_SERIAL_USART2) || defined(DEBUG_SERIAL_USART3)
+    printf("Powering off, temperature is too high\r\n");
+#endif
+    poweroff();
+  }
+  else if (BAT_DEAD_ENABLE && batVoltage < BAT_DEAD && speedAvgAbs < 20) {
+#if defined(DEBUG_SERIAL_USART2) || defined(DEBUG_SERIAL_USART3)
+    printf("Powering off, battery voltage is too low\r\n");
 #endif
+    poweroff();
+  }
+  else if (rtY_Left.z_errCode || rtY_Right.z_errCode) {                                           // 1 beep (low pitch): Motor error, disable motors
+    enable = 0;
+    beepCount(1, 24, 1);
+  }
+  else if (timeoutFlgADC) {                                                                       // 2 beeps (low pitch): ADC timeout
+    beepCount(2, 24, 1);
+  }
+  else if (timeoutFlgSerial) {                                                                    // 3 beeps (low pitch): Serial timeout
+    beepCount(3, 24, 1);
+  }
+  else if (timeoutFlgGen) {                                                                       // 4 beeps (low pitch): General timeout (PPM, PWM, Nunchuk)
+    beepCount(4, 24, 1);
+  }
+  else if (TEMP_WARNING_ENABLE && board_temp_deg_c >= TEMP_WARNING) {                             // 5 beeps (low pitch): Mainboard temperature warning
+    beepCount(5, 24, 1);
+  }
+  else if (overrunErr) {                                                                          // 6 beeps (low pitch): Control ISR overrun
+    beepCount(6, 24, 1);
+  }
+  else if (BAT_LVL1_ENABLE && batVoltage < BAT_LVL1) {                                            // 1 beep fast (medium pitch): Low bat 1
+    beepCount(0, 10, 6);
+  }
+  else if (BAT_LVL2_ENABLE && batVoltage < BAT_LVL2) {                                            // 1 beep slow (medium pitch): Low bat 2
+    beepCount(0, 10, 30);
+  }
+  else if (BEEPS_BACKWARD && (((cmdR < -50 || cmdL < -50) && speedAvg < 0) || MultipleTapBrake.b_multipleTap)) { // 1 beep fast (high pitch): Backward spinning motors
+    beepCount(0, 5, 1);
+    backwardDrive = 1;
+  }
+  else if (tonesPlaying) {                                                                        // power-on melody and enable beeps of FAST_BOOT
+    backwardDrive = 0;
+  }
+  else {  // do not beep
+    beepCount(0, 0, 0);
+    backwardDrive = 0;
+  }
 
-    // ####### FEEDBACK LIMERO SERIAL OUT #######
-#if defined(FEEDBACK_LIMERO) 
-    extern uint32_t  get_txd(uint8_t * *txd);
-    if (main_loop_counter % 40 == 0) {
-      if (__HAL_DMA_GET_COUNTER(huart2.hdmatx) == 0) {
-        uint32_t length = 0;
-        uint8_t* txd;
-        length = get_txd(&txd);
-        if (length) HAL_UART_Transmit_DMA(&huart2, txd, length);
-      }
-    }
+
+  inactivity_timeout_counter++;
+
+  // ####### INACTIVITY TIMEOUT #######
+  if (abs(cmdL) > 50 || abs(cmdR) > 50) {
+    inactivity_timeout_counter = 0;
+  }
+
+#if defined(CRUISE_CONTROL_SUPPORT) || defined(STANDSTILL_HOLD_ENABLE)
+  if ((abs(rtP_Left.n_cruiseMotTgt) > 50 && rtP_Left.b_cruiseCtrlEna) ||
+    (abs(rtP_Right.n_cruiseMotTgt) > 50 && rtP_Right.b_cruiseCtrlEna)) {
+    inactivity_timeout_counter = 0;
+  }
 #endif
 
-    // ####### FEEDBACK SERIAL OUT #######
+  if (inactivity_timeout_counter > (INACTIVITY_TIMEOUT * 60 * 1000) / DELAY_IN_MAIN_LOOP) {  // the task runs every DELAY_IN_MAIN_LOOP ms
+#if defined(DEBUG_SERIAL_USART2) || defined(DEBUG_SERIAL_USART3)
+    printf("Powering off, wheels were inactive for too long\r\n");
+#endif
+    poweroff();
+  }
+
+  main_loop_counter++;                  // last task of the control pass
+}
+
+static void taskFeedback(void) {
+  // ####### FEEDBACK SERIAL OUT #######
 #if defined(FEEDBACK_SERIAL_USART2) || defined(FEEDBACK_SERIAL_USART3)
-    if (main_loop_counter % 20 == 0) {    // Send data periodically every 10 ms was %2
-      Feedback.start = (uint16_t)SERIAL_START_FRAME;
-      Feedback.cmd1 = (int16_t)input1[inIdx].cmd;
-      Feedback.cmd2 = (int16_t)input2[inIdx].cmd;
-      Feedback.speedR_meas = (int16_t)rtY_Right.n_mot;
-      Feedback.speedL_meas = (int16_t)rtY_Left.n_mot;
-      Feedback.batVoltage = (int16_t)batVoltageCalib;
-      Feedback.boardTemp = (int16_t)board_temp_deg_c;
+  Feedback.start = (uint16_t)SERIAL_START_FRAME;
+  Feedback.cmd1 = (int16_t)input1[inIdx].cmd;
+  Feedback.cmd2 = (int16_t)input2[inIdx].cmd;
+  Feedback.speedR_meas = (int16_t)rtY_Right.n_mot;
+  Feedback.speedL_meas = (int16_t)rtY_Left.n_mot;
+  Feedback.batVoltage = (int16_t)batVoltageCalib;
+  Feedback.boardTemp = (int16_t)board_temp_deg_c;
 
 #if defined(FEEDBACK_SERIAL_USART2)
-      if (__HAL_DMA_GET_COUNTER(huart2.hdmatx) == 0) {
-        Feedback.cmdLed = (uint16_t)sideboard_leds_L;
-        Feedback.checksum = (uint16_t)(Feedback.start ^ Feedback.cmd1 ^ Feedback.cmd2 ^ Feedback.speedR_meas ^ Feedback.speedL_meas
-          ^ Feedback.batVoltage ^ Feedback.boardTemp ^ Feedback.cmdLed);
+  if (__HAL_DMA_GET_COUNTER(huart2.hdmatx) == 0) {
+    Feedback.cmdLed = (uint16_t)sideboard_leds_L;
+    Feedback.checksum = (uint16_t)(Feedback.start ^ Feedback.cmd1 ^ Feedback.cmd2 ^ Feedback.speedR_meas ^ Feedback.speedL_meas
+      ^ Feedback.batVoltage ^ Feedback.boardTemp ^ Feedback.cmdLed);
 
-        HAL_UART_Transmit_DMA(&huart2, (uint8_t*)&Feedback, sizeof(Feedback));
-      }
+    HAL_UART_Transmit_DMA(&huart2, (uint8_t*)&Feedback, sizeof(Feedback));
+  }
 #endif
 #if defined(FEEDBACK_SERIAL_USART3)
-      if (__HAL_DMA_GET_COUNTER(huart3.hdmatx) == 0) {
-        Feedback.cmdLed = (uint16_t)sideboard_leds_R;
-        Feedback.checksum = (uint16_t)(Feedback.start ^ Feedback.cmd1 ^ Feedback.cmd2 ^ Feedback.speedR_meas ^ Feedback.speedL_meas
-          ^ Feedback.batVoltage ^ Feedback.boardTemp ^ Feedback.cmdLed);
+  if (__HAL_DMA_GET_COUNTER(huart3.hdmatx) == 0) {
+    Feedback.cmdLed = (uint16_t)sideboard_leds_R;
+    Feedback.checksum = (uint16_t)(Feedback.start ^ Feedback.cmd1 ^ Feedback.cmd2 ^ Feedback.speedR_meas ^ Feedback.speedL_meas
+      ^ Feedback.batVoltage ^ Feedback.boardTemp ^ Feedback.cmdLed);
 
-        HAL_UART_Transmit_DMA(&huart3, (uint8_t*)&Feedback, sizeof(Feedback));
-      }
+    HAL_UART_Transmit_DMA(&huart3, (uint8_t*)&Feedback, sizeof(Feedback));
+  }
 #endif
-    }
 #endif
+}
 
-    // ####### POWEROFF BY POWER-BUTTON #######
- //   poweroffPressCheck();
+static void taskTelemetry(void) {
+  // ####### FEEDBACK LIMERO SERIAL OUT #######
+#if defined(FEEDBACK_LIMERO)
+  if (__HAL_DMA_GET_COUNTER(huart2.hdmatx) == 0) {
+    uint32_t length = 0;
+    uint8_t* txd;
+    length = get_txd(&txd);
+    if (length) HAL_UART_Transmit_DMA(&huart2, txd, length);
+  } else {
+    limero_tx_busy();                   // previous frame still on the wire, this one is skipped
+  }
+#endif
+}
 
-    // ####### BEEP AND EMERGENCY POWEROFF #######
-    if (TEMP_POWEROFF_ENABLE && board_temp_deg_c >= TEMP_POWEROFF && speedAvgAbs < 20) {  // poweroff before mainboard burns OR low bat 3
+static void taskDebug(void) {
+  // ####### DEBUG SERIAL OUT #######
 #if defined(DEBUG_SERIAL_USART2) || defined(DEBUG_SERIAL_USART3)
-      printf("Powering off, temperature is too high\r\n");
+#if defined(DEBUG_SERIAL_PROTOCOL)
+  process_debug();
+#else
+  printf("in1:%i in2:%i cmdL:%i cmdR:%i BatADC:%i BatV:%i TempADC:%i Temp:%i \r\n",
+    input1[inIdx].raw,        // 1: INPUT1
+    input2[inIdx].raw,        // 2: INPUT2
+    cmdL,                     // 3: output command: [-1000, 1000]
+    cmdR,                     // 4: output command: [-1000, 1000]
+    #ifdef ADC_OVERSAMPLE
+    oversample_batt(),        // 5: for battery voltage calibration
+    #else
+    adc_buffer.batt1,         // 5: for battery voltage calibration
+    #endif
+    batVoltageCalib,          // 6: for verifying battery voltage calibration
+    board_temp_adcFilt,       // 7: for board temperature calibration
+    board_temp_deg_c);        // 8: for verifying board temperature calibration
 #endif
-      poweroff();
+#endif
+}
+
+static void taskLcd(void) {
+#if defined(VARIANT_TRANSPOTTER) && defined(SUPPORT_LCD)
+  if (LCDerrorFlag == 1 && enable == 0) {
+
+  }
+  else {
+    if (nunchuk_connected == 0) {
+      LCD_SetLocation(&lcd, 4, 0); LCD_WriteFloat(&lcd, distance / 1345.0, 2);
+      LCD_SetLocation(&lcd, 10, 0); LCD_WriteFloat(&lcd, setDistance, 2);
     }
-    else if (BAT_DEAD_ENABLE && batVoltage < BAT_DEAD && speedAvgAbs < 20) {
+    LCD_SetLocation(&lcd, 4, 1); LCD_WriteFloat(&lcd, batVoltage, 1);
+    // LCD_SetLocation(&lcd, 11, 1); LCD_WriteFloat(&lcd,MAX(ABS(currentR), ABS(currentL)),2);
+  }
+#endif
+}
+
+// Indexed by TaskId. Tasks that are not built get period 0
+SchedTask schedTasks[TASK_COUNT] = {
+  // Name       ,Function       ,Period [ms]        ,Deadline [ms]      ,Next
+  {"command"    ,taskCommand    ,DELAY_IN_MAIN_LOOP ,DELAY_IN_MAIN_LOOP ,TASK_MIXER},
+  {"mixer"      ,taskMixer      ,DELAY_IN_MAIN_LOOP ,DELAY_IN_MAIN_LOOP ,0},
+  {"sideboard"  ,taskSideboard  ,DELAY_IN_MAIN_LOOP ,DELAY_IN_MAIN_LOOP ,0},
+  {"measure"    ,taskMeasure    ,DELAY_IN_MAIN_LOOP ,DELAY_IN_MAIN_LOOP ,0},
+  {"safety"     ,taskSafety     ,DELAY_IN_MAIN_LOOP ,DELAY_IN_MAIN_LOOP ,0},
+#if defined(FEEDBACK_SERIAL_USART2) || defined(FEEDBACK_SERIAL_USART3)
+  {"feedback"   ,taskFeedback   ,TASK_FEEDBACK_MS   ,TASK_FEEDBACK_MS   ,0},
+#else
+  {"feedback"   ,taskFeedback   ,0                  ,0                  ,0},
+#endif
+#if defined(FEEDBACK_LIMERO)
+  {"telemetry"  ,taskTelemetry  ,TASK_TELEMETRY_MS  ,TASK_TELEMETRY_MS  ,0},
+#else
+  {"telemetry"  ,taskTelemetry  ,0                  ,0                  ,0},
+#endif
 #if defined(DEBUG_SERIAL_USART2) || defined(DEBUG_SERIAL_USART3)
-      printf("Powering off, battery voltage is too low\r\n");
+  {"debug"      ,taskDebug      ,TASK_DEBUG_MS      ,TASK_DEBUG_MS      ,0},
+#else
+  {"debug"      ,taskDebug      ,0                  ,0                  ,0},
 #endif
-      poweroff();
-    }
-    else if (rtY_Left.z_errCode || rtY_Right.z_errCode) {                                           // 1 beep (low pitch): Motor error, disable motors
-      enable = 0;
-      beepCount(1, 24, 1);
-    }
-    else if (timeoutFlgADC) {                                                                       // 2 beeps (low pitch): ADC timeout
-      beepCount(2, 24, 1);
-    }
-    else if (timeoutFlgSerial) {                                                                    // 3 beeps (low pitch): Serial timeout
-      beepCount(3, 24, 1);
-    }
-    else if (timeoutFlgGen) {                                                                       // 4 beeps (low pitch): General timeout (PPM, PWM, Nunchuk)
-      beepCount(4, 24, 1);
-    }
-    else if (TEMP_WARNING_ENABLE && board_temp_deg_c >= TEMP_WARNING) {                             // 5 beeps (low pitch): Mainboard temperature warning
-      beepCount(5, 24, 1);
-    }
-    else if (BAT_LVL1_ENABLE && batVoltage < BAT_LVL1) {                                            // 1 beep fast (medium pitch): Low bat 1
-      beepCount(0, 10, 6);
-    }
-    else if (BAT_LVL2_ENABLE && batVoltage < BAT_LVL2) {                                            // 1 beep slow (medium pitch): Low bat 2
-      beepCount(0, 10, 30);
-    }
-    else if (BEEPS_BACKWARD && (((cmdR < -50 || cmdL < -50) && speedAvg < 0) || MultipleTapBrake.b_multipleTap)) { // 1 beep fast (high pitch): Backward spinning motors
-      beepCount(0, 5, 1);
-      backwardDrive = 1;
-    }
-    else {  // do not beep
-      beepCount(0, 0, 0);
-      backwardDrive = 0;
-    }
+#if defined(VARIANT_TRANSPOTTER) && defined(SUPPORT_LCD)
+  {"lcd"        ,taskLcd        ,TASK_LCD_MS        ,TASK_LCD_MS        ,0},
+#else
+  {"lcd"        ,taskLcd        ,0                  ,0                  ,0},
+#endif
+};
 
 
-    inactivity_timeout_counter++;
+int main(void) {
 
-    // ####### INACTIVITY TIMEOUT #######
-    if (abs(cmdL) > 50 || abs(cmdR) > 50) {
-      inactivity_timeout_counter = 0;
-    }
+  HAL_Init();
+  __HAL_RCC_AFIO_CLK_ENABLE();
+  HAL_NVIC_SetPriorityGrouping(NVIC_PRIORITYGROUP_4);
+  /* System interrupt init*/
+  /* MemoryManagement_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(MemoryManagement_IRQn, 0, 0);
+  /* BusFault_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(BusFault_IRQn, 0, 0);
+  /* UsageFault_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(UsageFault_IRQn, 0, 0);
+  /* SVCall_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(SVCall_IRQn, 0, 0);
+  /* DebugMonitor_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DebugMonitor_IRQn, 0, 0);
+  /* PendSV_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(PendSV_IRQn, 15, 0);   // lowest, work deferred from DMA1_Channel1_IRQHandler() must not delay other interrupts
+  /* SysTick_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(SysTick_IRQn, 0, 0);
 
-#if defined(CRUISE_CONTROL_SUPPORT) || defined(STANDSTILL_HOLD_ENABLE)
-    if ((abs(rtP_Left.n_cruiseMotTgt) > 50 && rtP_Left.b_cruiseCtrlEna) ||
-      (abs(rtP_Right.n_cruiseMotTgt) > 50 && rtP_Right.b_cruiseCtrlEna)) {
-      inactivity_timeout_counter = 0;
-    }
+  SystemClock_Config();
+
+  __HAL_RCC_DMA1_CLK_DISABLE();
+  MX_GPIO_Init();
+  MX_TIM_Init();
+  MX_ADC1_Init();
+  MX_ADC2_Init();
+  BLDC_Init();        // BLDC Controller Init
+
+  HAL_GPIO_WritePin(OFF_PORT, OFF_PIN, GPIO_PIN_SET);   // Activate Latch
+  Input_Lim_Init();   // Input Limitations Init
+  Input_Init();       // Input Init
+
+  #ifdef ISR_PROFILE
+  isr_profile_init(); // cycle counter must run before the first DMA interrupt
+  #endif
+
+  #ifdef HALL_CAPTURE
+  hall_capture_init(); // hall edge interrupts, before the DMA interrupt reads their estimates
+  #endif
+
+  #ifdef FAST_BOOT
+  offsetsLoad();      // stored current offsets for the DMA interrupt, before its first conversion
+  #endif
+
+  #ifdef ENERGY_COUNT
+  energyLoad();       // lifetime totals, the DMA interrupt counts on from 0
+  #endif
+
+  HAL_ADC_Start(&hadc1);
+  HAL_ADC_Start(&hadc2);
+
+  #ifdef FAST_BOOT
+  playTones(poweronTones);
+  #else
+  poweronMelody();
+  #endif
+  HAL_GPIO_WritePin(LED_PORT, LED_PIN, GPIO_PIN_SET);
+
+  board_temp_adcFixdt = adc_buffer.temp << 16;  // Fixed-point filter output initialized with current ADC converted to fixed-point
+  board_temp_adcFilt = adc_buffer.temp;
+
+#ifdef MULTI_MODE_DRIVE
+  if (adc_buffer.l_tx2 > input1[0].min + 50 && adc_buffer.l_rx2 > input2[0].min + 50) {
+    drive_mode = 2;
+    max_speed = MULTI_MODE_DRIVE_M3_MAX;
+    rate = MULTI_MODE_DRIVE_M3_RATE;
+    rtP_Left.n_max = rtP_Right.n_max = MULTI_MODE_M3_N_MOT_MAX << 4;
+    rtP_Left.i_max = rtP_Right.i_max = (MULTI_MODE_M3_I_MOT_MAX * A2BIT_CONV) << 4;
+  }
+  else if (adc_buffer.l_tx2 > input1[0].min + 50) {
+    drive_mode = 1;
+    max_speed = MULTI_MODE_DRIVE_M2_MAX;
+    rate = MULTI_MODE_DRIVE_M2_RATE;
+    rtP_Left.n_max = rtP_Right.n_max = MULTI_MODE_M2_N_MOT_MAX << 4;
+    rtP_Left.i_max = rtP_Right.i_max = (MULTI_MODE_M2_I_MOT_MAX * A2BIT_CONV) << 4;
+  }
+  else {
+    drive_mode = 0;
+    max_speed = MULTI_MODE_DRIVE_M1_MAX;
+    rate = MULTI_MODE_DRIVE_M1_RATE;
+    rtP_Left.n_max = rtP_Right.n_max = MULTI_MODE_M1_N_MOT_MAX << 4;
+    rtP_Left.i_max = rtP_Right.i_max = (MULTI_MODE_M1_I_MOT_MAX * A2BIT_CONV) << 4;
+  }
+
+  printf("Drive mode %i selected: max_speed:%i acc_rate:%i \r\n", drive_mode, max_speed, rate);
 #endif
 
-    if (inactivity_timeout_counter > (INACTIVITY_TIMEOUT * 60 * 1000) / (DELAY_IN_MAIN_LOOP + 1)) {  // rest of main loop needs maybe 1ms
-#if defined(DEBUG_SERIAL_USART2) || defined(DEBUG_SERIAL_USART3)
-      printf("Powering off, wheels were inactive for too long\r\n");
+  // Loop until button is released
+ // while (HAL_GPIO_ReadPin(BUTTON_PORT, BUTTON_PIN)) { HAL_Delay(10); }
+
+#ifdef MULTI_MODE_DRIVE
+  // Wait until triggers are released. Exit if timeout elapses (to unblock if the inputs are not calibrated)
+  int iTimeout = 0;
+  while ((adc_buffer.l_rx2 + adc_buffer.l_tx2) >= (input1[0].min + input2[0].min) && iTimeout++ < 300) {
+    HAL_Delay(10);
+  }
 #endif
-      poweroff();
-    }
 
+  BLDC_paramCommit();   // EEPROM and drive mode limits
 
-    // HAL_GPIO_TogglePin(LED_PORT, LED_PIN);                 // This is to measure the main() loop duration with an oscilloscope connected to LED_PIN
-    // Update states
-    inIdx_prev = inIdx;
-    buzzerTimer_prev = buzzerTimer;
-    main_loop_counter++;
+  sched_init(schedTasks, TASK_COUNT);
+  uint8_t paramsPending = 0;
+  while (1) {
+    if (sched_run()) {
+      paramsPending = 1;
+    } else if (paramsPending) {
+      // ####### PARAMETERS: everything the tasks released together changed in rtP_Left/rtP_Right, in one go #######
+      paramsPending = 0;
+      BLDC_paramCommit();
     }
+    // HAL_GPIO_TogglePin(LED_PORT, LED_PIN);                 // This is to measure the main() loop duration with an oscilloscope connected to LED_PIN
   }
 }
 
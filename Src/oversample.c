@@ -0,0 +1,62 @@
+/*
+ * Oversampled battery voltage and board temperature, see oversample.h.
+ *
+ * Both channels share one 32-bit sum, the battery in the low and the
+ * temperature in the high half: OVERSAMPLE_BATT_DECIM 12-bit samples cannot
+ * carry into the other half. Per period this costs two halfword loads, a
+ * shifted OR, the add and the decimation count. Once per battery mean the
+ * temperature half moves on to the second stage, once per temperature mean
+ * there is a division by OVERSAMPLE_TEMP_DECIM.
+ */
+
+#include <stdint.h>
+#include "config.h"
+#include "defines.h"
+#include "oversample.h"
+
+#if defined(ADC_OVERSAMPLE)
+
+extern volatile adc_buf_t adc_buffer;
+
+volatile uint16_t ovsBatt    = 0;
+volatile uint8_t  ovsBattNew = 0;
+volatile uint16_t ovsTemp    = 0;
+
+static uint32_t ovsSum       = 0;   // stage 1: battery | temperature << 16
+static uint8_t  ovsCount     = 0;
+static uint32_t ovsTempSum   = 0;   // stage 2: temperature sums of stage 1
+static uint8_t  ovsTempCount = 0;
+
+// DMA1_Channel1_IRQHandler(), after both controller steps
+RAMFUNC void oversample_sample(void) {
+  ovsSum += adc_buffer.batt1 | (uint32_t)adc_buffer.temp << 16;
+  if (++ovsCount < OVERSAMPLE_BATT_DECIM) {
+    return;
+  }
+
+  ovsBatt     = (uint16_t)ovsSum;   // the sum of 16 samples is the mean in 1/16 counts
+  ovsBattNew  = 1;
+  ovsTempSum += ovsSum >> 16;
+  ovsSum      = 0;
+  ovsCount    = 0;
+
+  if (++ovsTempCount == OVERSAMPLE_TEMP_DECIM) {
+    ovsTemp      = (uint16_t)((ovsTempSum + OVERSAMPLE_TEMP_DECIM / 2) / OVERSAMPLE_TEMP_DECIM);
+    ovsTempSum   = 0;
+    ovsTempCount = 0;
+  }
+}
+
+// Battery [ADC counts], the last mean rounded. Until the first mean is in, the last sample
+int16_t oversample_batt(void) {
+  uint16_t batt = ovsBatt;
+  return batt ? (int16_t)((batt + 8) >> 4) : (int16_t)adc_buffer.batt1;
+}
+
+// Temperature [ADC counts], the last mean rounded. Until the first mean is in, the last sample
+int16_t oversample_temp(void) {
+  uint16_t temp = ovsTemp;
+  return temp ? (int16_t)((temp + 8) >> 4) : (int16_t)adc_buffer.temp;
+}
+
+#endif
@@ -0,0 +1,154 @@
+/*
+ * Cooperative rate-monotonic scheduler of the main loop, see scheduler.h.
+ *
+ * sched_init() sorts the task indices by period once. sched_run() then
+ * walks them in that order and takes the first task whose release has come.
+ * Ticks are compared as signed differences, so buzzerTimer may wrap.
+ *
+ * The trigger flag is cleared before the run, so input arriving while the
+ * task runs triggers it again. Input that comes between reading the stamp
+ * and clearing the flag loses its stamp, but the run about to start takes
+ * it over.
+ */
+
+#include <stdint.h>
+#include "stm32f1xx_hal.h"
+#include "config.h"
+#include "scheduler.h"
+
+extern volatile uint32_t buzzerTimer;
+
+uint32_t schedLoad = 0;
+uint32_t schedLatHist[SCHED_LAT_BINS];
+
+static const uint16_t schedLatBound[SCHED_LAT_BINS - 1] = {250, 500, 1000, 2000, 5000};  // [us] upper bin bounds
+
+static SchedTask *schedTable = NULL;
+static uint8_t    schedOrder[TASK_COUNT];   // task indices, most urgent first
+static uint8_t    schedCount = 0;
+static uint32_t   schedLoadStart;           // [ticks] start of the load window
+
+void sched_init(SchedTask *tasks, uint8_t count) {
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;   // DWT needs trace enabled, ISR_PROFILE and HALL_CAPTURE may have done it
+  DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
+
+  uint32_t now = buzzerTimer;
+  schedTable     = tasks;
+  schedCount     = 0;
+  schedLoadStart = now;
+  for (uint8_t i = 0; i < count && i < TASK_COUNT; i++) {
+    tasks[i].release = now;
+    if (tasks[i].periodMs == 0) {
+      continue;
+    }
+    // insertion sort by period, stable so equal periods keep the table order
+    uint8_t p = schedCount++;
+    while (p > 0 && tasks[schedOrder[p - 1]].periodMs > tasks[i].periodMs) {
+      schedOrder[p] = schedOrder[p - 1];
+      p--;
+    }
+    schedOrder[p] = i;
+  }
+}
+
+static void sched_load(uint32_t now) {
+  uint32_t total = 0;
+  for (uint8_t p = 0; p < schedCount; p++) {
+    SchedTask *task = &schedTable[schedOrder[p]];
+    task->load    = task->execWin / (SCHED_CYCLES_US * SCHED_LOAD_MS);
+    task->execWin = 0;
+    total        += task->load;
+  }
+  schedLoad      = total;
+  schedLoadStart = now;
+}
+
+// Interrupts: new input for task id has arrived
+void sched_trigger(uint8_t id) {
+  if (schedTable == NULL || id >= TASK_COUNT || schedTable[id].periodMs == 0) {
+    return;   // before sched_init() or not built
+  }
+  SchedTask *task = &schedTable[id];
+  if (!task->triggered) {             // keep the oldest input not yet served
+    task->triggerCycles = DWT->CYCCNT;
+    task->triggered     = 1;
+  }
+}
+
+static void sched_latency(SchedTask *task, uint32_t triggerCycles) {
+  uint32_t latency = (DWT->CYCCNT - triggerCycles) / SCHED_CYCLES_US;
+  if (latency > task->latencyMax) {
+    task->latencyMax = latency;
+  }
+  task->events++;
+  if (task == &schedTable[SCHED_LAT_TASK]) {
+    uint8_t bin = 0;
+    while (bin < SCHED_LAT_BINS - 1 && latency >= schedLatBound[bin]) {
+      bin++;
+    }
+    schedLatHist[bin]++;
+  }
+}
+
+// Main loop: runs the most urgent released task. 0 = none was released
+uint8_t sched_run(void) {
+  uint32_t now = buzzerTimer;
+  if (now - schedLoadStart >= SCHED_LOAD_MS * SCHED_TICKS_MS) {
+    sched_load(now);
+  }
+
+  for (uint8_t p = 0; p < schedCount; p++) {
+    SchedTask *task = &schedTable[schedOrder[p]];
+    int32_t late = (int32_t)(now - task->release);
+    uint8_t triggered = task->triggered;
+#if defined(COMMAND_EVENT)
+    if (late < 0 && !triggered) {
+#else
+    if (late < 0) {
+#endif
+      continue;
+    }
+
+    uint32_t triggerCycles = task->triggerCycles;
+    task->triggered = 0;
+
+    uint32_t start = DWT->CYCCNT;
+    task->run();
+    uint32_t cycles = DWT->CYCCNT - start;
+
+    if (triggered) {
+      sched_latency(task, triggerCycles);
+      if (task->next) {
+        SchedTask *next = &schedTable[task->next];
+        if (!next->triggered) {
+          next->triggerCycles = triggerCycles;
+          next->triggered     = 1;
+        }
+      }
+    }
+
+    uint32_t period = task->periodMs * SCHED_TICKS_MS;
+    if (late < 0) {
+      task->release = now + period;   // event run ahead of the grid, restart it
+    } else {
+      if ((int32_t)(buzzerTimer - task->release) > (int32_t)(task->deadlineMs * SCHED_TICKS_MS)) {
+        task->overruns++;
+      }
+      uint32_t missed = (uint32_t)late / period;
+      task->skipped  += missed;
+      task->release  += (missed + 1) * period;
+
+      uint32_t jitter = (uint32_t)late * 1000 / SCHED_TICKS_MS;
+      if (jitter > task->jitterMax) {
+        task->jitterMax = jitter;
+      }
+    }
+    if (cycles / SCHED_CYCLES_US > task->execMax) {
+      task->execMax = cycles / SCHED_CYCLES_US;
+    }
+    task->execWin += cycles;
+    task->runs++;
+    return 1;
+  }
+  return 0;
+}
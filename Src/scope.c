@@ -0,0 +1,200 @@
+/*
+ * Triggered capture of control loop signals, see scope.h.
+ *
+ * scope_sample() costs the same every period: a state check, the decimation
+ * counter, one load and store per selected channel and one trigger compare.
+ * All set-up (channel pointers, ring size) is done by scope_arm().
+ *
+ * scope_arm(), scope_force() and scope_stop() are called from the USART2 IRQ.
+ * The DMA1 interrupt may preempt them, so the state is written last and the
+ * ISR only touches the ring while the state is ARMED or TRIGGERED.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+#include "defines.h"
+#include "BLDC_controller.h"
+#include "scope.h"
+
+#if defined(LIMERO_SCOPE)
+
+extern int16_t curL_phaA, curL_phaB, curL_DC;
+extern int16_t curR_phaB, curR_phaC, curR_DC;
+extern ExtU rtU_Left;
+extern ExtU rtU_Right;
+extern ExtY rtY_Left;
+extern ExtY rtY_Right;
+
+// the boolean and mode inputs of each controller packed into one channel, left and right
+static int16_t scope_ctl[2];
+
+static const int16_t *const scope_sources[SCOPE_CH_COUNT] = {
+  &curL_phaA, &curL_phaB, &curL_DC,
+  &curR_phaB, &curR_phaC, &curR_DC,
+  &rtY_Left.iq, &rtY_Left.id, &rtY_Right.iq, &rtY_Right.id,
+  &rtY_Left.a_elecAngle, &rtY_Right.a_elecAngle,
+  &rtY_Left.n_mot, &rtY_Right.n_mot,
+  &scope_ctl[0], &rtU_Left.r_inpTgt, &scope_ctl[1], &rtU_Right.r_inpTgt,
+};
+
+static int16_t scope_buffer[SCOPE_BUFFER_SIZE];
+
+static struct {
+  volatile uint8_t  state;
+  volatile uint8_t  force;
+  uint8_t           n_ch;
+  const int16_t    *src[SCOPE_CHANNELS_MAX];
+  const int16_t    *trig_src;
+  int16_t           trig_prev;
+  uint16_t          dec_count;
+  uint16_t          rows;       // ring size in samples per channel
+  uint16_t          head;       // next row written
+  uint16_t          pre_left;   // rows still needed before the trigger is looked at
+  uint16_t          post_left;  // rows still needed after the trigger
+  uint32_t          capture_id;
+  ScopeConfig       config;
+} scope;
+
+int scope_arm(const ScopeConfig *config) {
+  uint8_t n_ch = 0;
+  const int16_t *src[SCOPE_CHANNELS_MAX];
+  for (uint8_t ch = 0; ch < SCOPE_CH_COUNT; ch++) {
+    if (config->channels & (1U << ch)) {
+      if (n_ch == SCOPE_CHANNELS_MAX) {
+        return -1;
+      }
+      src[n_ch++] = scope_sources[ch];
+    }
+  }
+  uint16_t rows = n_ch ? SCOPE_BUFFER_SIZE / n_ch : 0;
+  if (n_ch == 0 || config->channels >> SCOPE_CH_COUNT || config->pre_samples >= rows ||
+      config->trigger > SCOPE_TRIG_ERROR || config->trigger_channel >= SCOPE_CH_COUNT) {
+    return -1;
+  }
+
+  scope.state     = SCOPE_IDLE;   // keeps the ISR out while the rest changes
+  scope.force     = 0;
+  scope.n_ch      = n_ch;
+  for (uint8_t i = 0; i < n_ch; i++) {
+    scope.src[i]  = src[i];
+  }
+  scope.trig_src  = scope_sources[config->trigger_channel];
+  scope.trig_prev = *scope.trig_src;
+  scope.dec_count = 0;
+  scope.rows      = rows;
+  scope.head      = 0;
+  scope.pre_left  = config->pre_samples;
+  scope.config    = *config;
+  if (scope.config.decimation == 0) {
+    scope.config.decimation = 1;
+  }
+  scope.capture_id++;
+  scope.state     = SCOPE_ARMED;
+  return 0;
+}
+
+void scope_force(void) {
+  scope.force = 1;
+}
+
+void scope_stop(void) {
+  scope.state = SCOPE_IDLE;
+}
+
+static inline int16_t scope_pack_ctl(const ExtU *u) {
+  return u->b_hallA | u->b_hallB << 1 | u->b_hallC << 2 | u->b_motEna << 3 | u->z_ctrlModReq << 4;
+}
+
+static uint8_t scope_triggered(void) {
+  int16_t value = *scope.trig_src;
+  int16_t prev  = scope.trig_prev;
+  scope.trig_prev = value;
+  if (scope.force) {
+    return 1;
+  }
+  switch (scope.config.trigger) {
+    case SCOPE_TRIG_RISING:
+      return prev < scope.config.level && value >= scope.config.level;
+    case SCOPE_TRIG_FALLING:
+      return prev > scope.config.level && value <= scope.config.level;
+    case SCOPE_TRIG_ERROR:
+      return rtY_Left.z_errCode || rtY_Right.z_errCode;
+    default:
+      return 0;
+  }
+}
+
+// DMA1_Channel1_IRQHandler(), after both controller steps
+RAMFUNC void scope_sample(void) {
+  uint8_t state = scope.state;
+  if (state != SCOPE_ARMED && state != SCOPE_TRIGGERED) {
+    return;
+  }
+  if (++scope.dec_count < scope.config.decimation) {
+    return;
+  }
+  scope.dec_count = 0;
+
+  scope_ctl[0] = scope_pack_ctl(&rtU_Left);
+  scope_ctl[1] = scope_pack_ctl(&rtU_Right);
+  int16_t *row = &scope_buffer[scope.head * scope.n_ch];
+  for (uint8_t i = 0; i < scope.n_ch; i++) {
+    row[i] = *scope.src[i];
+  }
+  if (++scope.head == scope.rows) {
+    scope.head = 0;
+  }
+
+  if (state == SCOPE_TRIGGERED) {
+    if (--scope.post_left == 0) {
+      scope.state = SCOPE_DONE;
+    }
+  } else if (scope.pre_left) {
+    scope.pre_left--;
+    scope.trig_prev = *scope.trig_src;
+  } else if (scope_triggered()) {
+    // the trigger row is written, the ring is full after rows - pre_samples - 1 more
+    scope.post_left = scope.rows - scope.config.pre_samples - 1;
+    scope.state = scope.post_left ? SCOPE_TRIGGERED : SCOPE_DONE;
+  }
+}
+
+uint8_t scope_state(void) {
+  return scope.state;
+}
+
+uint32_t scope_capture_id(void) {
+  return scope.capture_id;
+}
+
+const ScopeConfig *scope_config(void) {
+  return &scope.config;
+}
+
+uint16_t scope_samples(void) {
+  return scope.rows;
+}
+
+// Copies rows of a finished capture, oldest first: row pre_samples is the trigger
+uint16_t scope_read(uint16_t offset, int16_t *dst, uint16_t max_samples) {
+  if (scope.state != SCOPE_DONE || offset >= scope.rows) {
+    return 0;
+  }
+  uint16_t count = scope.rows - offset;
+  if (count > max_samples) {
+    count = max_samples;
+  }
+  uint16_t row = (scope.head + offset) % scope.rows;
+  for (uint16_t i = 0; i < count; i++) {
+    for (uint8_t c = 0; c < scope.n_ch; c++) {
+      *dst++ = scope_buffer[row * scope.n_ch + c];
+    }
+    if (++row == scope.rows) {
+      row = 0;
+    }
+  }
+  return count;
+}
+
+#endif
@@ -368,6 +368,10 @@ void MX_GPIO_Init(void) {
   GPIO_InitStruct.Pull  = GPIO_NOPULL;
   GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
 
+#ifdef HALL_CAPTURE
+  GPIO_InitStruct.Mode  = GPIO_MODE_IT_RISING_FALLING;  // every hall edge interrupts, the DMA interrupt still reads the levels
+#endif
+
   GPIO_InitStruct.Pin = LEFT_HALL_U_PIN;
   HAL_GPIO_Init(LEFT_HALL_U_PORT, &GPIO_InitStruct);
 
@@ -386,6 +390,10 @@ void MX_GPIO_Init(void) {
   GPIO_InitStruct.Pin = RIGHT_HALL_W_PIN;
   HAL_GPIO_Init(RIGHT_HALL_W_PORT, &GPIO_InitStruct);
 
+#ifdef HALL_CAPTURE
+  GPIO_InitStruct.Mode  = GPIO_MODE_INPUT;
+#endif
+
   GPIO_InitStruct.Pull = GPIO_PULLUP;
   GPIO_InitStruct.Pin = CHARGER_PIN;
   HAL_GPIO_Init(CHARGER_PORT, &GPIO_InitStruct);
@@ -151,17 +151,7 @@ void DebugMon_Handler(void) {
   /* USER CODE END DebugMonitor_IRQn 1 */
 }
 
-/**
-* @brief This function handles Pendable request for system service.
-*/
-void PendSV_Handler(void) {
-  /* USER CODE BEGIN PendSV_IRQn 0 */
-
-  /* USER CODE END PendSV_IRQn 0 */
-  /* USER CODE BEGIN PendSV_IRQn 1 */
-
-  /* USER CODE END PendSV_IRQn 1 */
-}
+/* PendSV_Handler() runs the deferred part of the control interrupt, see bldc.c */
 
 /**
 * @brief This function handles System tick timer.
@@ -276,6 +266,18 @@ void EXTI15_10_IRQHandler(void)
 }
 #endif
 
+#ifdef HALL_CAPTURE
+void EXTI9_5_IRQHandler(void)
+{
+  hall_capture_left();
+}
+
+void EXTI15_10_IRQHandler(void)
+{
+  hall_capture_right();
+}
+#endif
+
 #if defined(DEBUG_SERIAL_USART2) || defined(CONTROL_SERIAL_USART2) \
 || defined(FEEDBACK_SERIAL_USART2) || defined(SIDEBOARD_SERIAL_USART2) \
 || defined(CONTROL_LIMERO) || defined(FEEDBACK_LIMERO)
@@ -30,6 +30,7 @@
 #include "BLDC_controller.h"
 #include "rtwtypes.h"
 #include "comms.h"
+#include "scheduler.h"
 
 #if defined(DEBUG_I2C_LCD) || defined(SUPPORT_LCD)
 #include "hd44780.h"
@@ -50,9 +51,25 @@ extern uint8_t backwardDrive;
 extern uint8_t buzzerCount;   // global variable for the buzzer counts. can be 1, 2, 3, 4, 5, 6, 7...
 extern uint8_t buzzerFreq;    // global variable for the buzzer pitch. can be 1, 2, 3, 4, 5, 6, 7...
 extern uint8_t buzzerPattern; // global variable for the buzzer pattern. can be 1, 2, 3, 4, 5, 6, 7...
+extern volatile uint32_t buzzerTimer;
 
 extern uint8_t enable; // global variable for motor enable
 
+#ifdef FAST_BOOT
+extern int16_t offsetStored[6];
+extern uint8_t offsetStoredValid;
+uint8_t offsetsGet(int16_t offsets[6]);
+#endif
+
+#ifdef HALL_CAPTURE
+#include "hall_speed.h"
+extern HallSpeed hallSpeedL, hallSpeedR;
+#endif
+
+#ifdef ENERGY_COUNT
+#include "energy.h"
+#endif
+
 extern uint8_t nunchuk_data[6];
 extern volatile uint32_t timeoutCntGen; // global counter for general timeout counter
 extern volatile uint8_t timeoutFlgGen;  // global flag for general timeout counter
@@ -88,6 +105,14 @@ ExtU rtU_Right; /* External inputs */
 ExtY rtY_Right; /* External outputs */
 //---------------
 
+// rtP_Left/rtP_Right are only edited by the main loop and the USART interrupts. The controllers
+// run on a copy in one of two banks: BLDC_paramCommit() fills the other bank and raises
+// rtP_pending, the DMA interrupt switches both motors to it before its next step.
+static P rtP_bank[2][2];                // [bank][left, right]
+static volatile uint8_t rtP_active = 0; // bank the controllers run on
+volatile uint8_t rtP_pending = 0;       // bank + 1 waiting for the DMA interrupt, 0 for none
+#define COMPILER_BARRIER() __ASM volatile ("" : : : "memory")   // keeps the bank copies between the rtP_pending writes
+
 uint8_t inIdx = 0;
 uint8_t inIdx_prev = 0;
 #if defined(PRI_INPUT1) && defined(PRI_INPUT2) && defined(AUX_INPUT1) && defined(AUX_INPUT2)
@@ -117,7 +142,14 @@ static uint16_t saveValue = 0;
 static uint8_t saveValue_valid = 0;
 #elif !defined(VARIANT_HOVERBOARD) && !defined(VARIANT_TRANSPOTTER)
 uint16_t VirtAddVarTab[NB_OF_VAR] = {1000, 1001, 1002, 1003, 1004, 1005, 1006, 1007, 1008, 1009,
-                                     1010, 1011, 1012, 1013, 1014, 1015, 1016, 1017, 1018};
+                                     1010, 1011, 1012, 1013, 1014, 1015, 1016, 1017, 1018,
+#ifdef FAST_BOOT
+                                     1019, 1020, 1021, 1022, 1023, 1024,   // EE_FAST_BOOT_IDX..: current offsets
+#endif
+#ifdef ENERGY_COUNT
+                                     1025, 1026, 1027, 1028, 1029, 1030, 1031, 1032,   // EE_ENERGY_IDX..: totals, low and high half
+#endif
+                                    };  // the addresses stay the same whichever of the options are enabled
 #else
 uint16_t VirtAddVarTab[NB_OF_VAR] = {1000}; // Dummy virtual address to avoid warnings
 #endif
@@ -250,18 +282,27 @@ void BLDC_Init(void)
   rtP_Left.a_phaAdvMax = PHASE_ADV_MAX << 4;                     // fixdt(1,16,4)
   rtP_Left.r_fieldWeakHi = FIELD_WEAK_HI << 4;                   // fixdt(1,16,4)
   rtP_Left.r_fieldWeakLo = FIELD_WEAK_LO << 4;                   // fixdt(1,16,4)
+#if defined(HALL_CAPTURE) && HALL_CAPTURE_ANGLE
+  rtP_Left.b_angleMeasEna = 1; // the angle interpolated from the hall edge timestamps, see hall_speed.h
+#endif
 
   rtP_Right = rtP_Left;             // Copy the Left motor parameters to the Right motor parameters
   rtP_Right.z_selPhaCurMeasABC = 1; // Right motor measured current phases {Blue, Yellow} = {iB, iC} -> do NOT change
 
+  for (uint8_t bank = 0; bank < 2; bank++)
+  {
+    memcpy(&rtP_bank[bank][0], &rtP_Left, sizeof(P));
+    memcpy(&rtP_bank[bank][1], &rtP_Right, sizeof(P));
+  }
+
   /* Pack LEFT motor data into RTM */
-  rtM_Left->defaultParam = &rtP_Left;
+  rtM_Left->defaultParam = &rtP_bank[0][0];
   rtM_Left->dwork = &rtDW_Left;
   rtM_Left->inputs = &rtU_Left;
   rtM_Left->outputs = &rtY_Left;
 
   /* Pack RIGHT motor data into RTM */
-  rtM_Right->defaultParam = &rtP_Right;
+  rtM_Right->defaultParam = &rtP_bank[0][1];
   rtM_Right->dwork = &rtDW_Right;
   rtM_Right->inputs = &rtU_Right;
   rtM_Right->outputs = &rtY_Right;
@@ -271,6 +312,40 @@ void BLDC_Init(void)
   BLDC_controller_initialize(rtM_Right);
 }
 
+// Main loop: hands rtP_Left/rtP_Right to the controllers if they changed since the last commit
+void BLDC_paramCommit(void)
+{
+  uint8_t pending = rtP_pending;
+  uint8_t latest = pending ? pending - 1 : rtP_active;
+  if (memcmp(&rtP_Left, &rtP_bank[latest][0], sizeof(P)) == 0 &&
+      memcmp(&rtP_Right, &rtP_bank[latest][1], sizeof(P)) == 0)
+  {
+    return;
+  }
+
+  rtP_pending = 0; // from here on the DMA interrupt stays on rtP_active
+  COMPILER_BARRIER();
+  uint8_t bank = !rtP_active; // read after the clear: a swap just before it has moved rtP_active
+  do
+  { // a USART interrupt may edit the parameters while they are copied; memcpy keeps the padding comparable
+    memcpy(&rtP_bank[bank][0], &rtP_Left, sizeof(P));
+    memcpy(&rtP_bank[bank][1], &rtP_Right, sizeof(P));
+  } while (memcmp(&rtP_Left, &rtP_bank[bank][0], sizeof(P)) != 0 ||
+           memcmp(&rtP_Right, &rtP_bank[bank][1], sizeof(P)) != 0);
+  COMPILER_BARRIER();
+  rtP_pending = bank + 1;
+}
+
+// DMA interrupt, before both controller steps while rtP_pending is set
+RAMFUNC void BLDC_paramSwap(void)
+{
+  uint8_t bank = rtP_pending - 1;
+  rtM_Left->defaultParam = &rtP_bank[bank][0];
+  rtM_Right->defaultParam = &rtP_bank[bank][1];
+  rtP_active = bank;
+  rtP_pending = 0;
+}
+
 void Input_Lim_Init(void)
 { // Input Limitations - ! Do NOT touch !
   if (rtP_Left.b_fieldWeakEna || rtP_Right.b_fieldWeakEna)
@@ -476,6 +551,60 @@ void poweronMelody(void)
   buzzerFreq = 0;
 }
 
+// The same as a sequence of beepShort()/HAL_Delay() calls, but playTonesUpdate() in the main loop
+// moves on to the next tone when the time of the current one is over. A list started while
+// another one plays follows it.
+static const BuzzerTone *tonePlaying = NULL;
+static const BuzzerTone *toneQueued  = NULL;
+static uint32_t toneStart;
+
+static void toneStartList(const BuzzerTone *tones)
+{
+  buzzerCount = 0; // prevent interraction with beep counter
+  buzzerPattern = 0;
+  buzzerFreq = tones->freq;
+  toneStart = buzzerTimer;
+  tonePlaying = tones->ms ? tones : NULL;
+}
+
+void playTones(const BuzzerTone *tones)
+{
+  if (tonePlaying != NULL)
+  {
+    toneQueued = tones;
+    return;
+  }
+  toneStartList(tones);
+}
+
+// 1 while a playTones() list is playing
+uint8_t playTonesUpdate(void)
+{
+  if (tonePlaying == NULL)
+  {
+    return 0;
+  }
+  // buzzerTimer counts the PWM_FREQ periods of the DMA interrupt
+  uint32_t ticks = (uint32_t)tonePlaying->ms * (PWM_FREQ / 1000);
+  if (buzzerTimer - toneStart >= ticks)
+  {
+    toneStart += ticks;
+    tonePlaying++;
+    buzzerFreq = tonePlaying->freq;
+    if (tonePlaying->ms == 0)
+    {
+      tonePlaying = NULL;
+      if (toneQueued == NULL)
+      {
+        return 0;
+      }
+      toneStartList(toneQueued);
+      toneQueued = NULL;
+    }
+  }
+  return 1;
+}
+
 void beepCount(uint8_t cnt, uint8_t freq, uint8_t pattern)
 {
   buzzerCount = cnt;
@@ -517,22 +646,48 @@ void beepShortMany(uint8_t cnt, int8_t dir)
   }
 }
 
+/* Microseconds since boot from the 1 ms HAL tick plus the SysTick down-counter.
+ * Safe to call from interrupts. Wraps with HAL_GetTick() after 49 days.
+ */
+uint64_t board_time_us(void)
+{
+  uint32_t ms, val;
+  do
+  {
+    ms = HAL_GetTick();
+    val = SysTick->VAL;
+  } while (ms != HAL_GetTick());
+  // counter reloaded but the SysTick interrupt did not run yet (interrupts masked)
+  if ((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) && val > SysTick->LOAD / 2)
+  {
+    ms++;
+  }
+  return (uint64_t)ms * 1000 + (SysTick->LOAD - val) * 1000 / (SysTick->LOAD + 1);
+}
+
 void calcAvgSpeed(void)
 {
   // Calculate measured average speed. The minus sign (-) is because motors spin in opposite directions
   speedAvg = 0;
+#ifdef HALL_CAPTURE
+  int16_t n_motL = hallSpeedL.rpm >> 4; // from the hall edge timestamps, down to HALL_CAPTURE_TIMEOUT
+  int16_t n_motR = hallSpeedR.rpm >> 4;
+#else
+  int16_t n_motL = rtY_Left.n_mot;
+  int16_t n_motR = rtY_Right.n_mot;
+#endif
 #if defined(MOTOR_LEFT_ENA)
 #if defined(INVERT_L_DIRECTION)
-  speedAvg -= rtY_Left.n_mot;
+  speedAvg -= n_motL;
 #else
-  speedAvg += rtY_Left.n_mot;
+  speedAvg += n_motL;
 #endif
 #endif
 #if defined(MOTOR_RIGHT_ENA)
 #if defined(INVERT_R_DIRECTION)
-  speedAvg += rtY_Right.n_mot;
+  speedAvg += n_motR;
 #else
-  speedAvg -= rtY_Right.n_mot;
+  speedAvg -= n_motR;
 #endif
 
 // Average only if both motors are enabled
@@ -1004,13 +1159,29 @@ void readInputRaw(void)
 #endif
 
 #ifdef CONTROL_LIMERO
+  // The values, their fresh flag and req_id as one set: the USART2 IRQ may publish the next request meanwhile
+#ifdef LIMERO_ACK
+  extern volatile uint32_t pending_req_id;
+  uint32_t limero_req_id;
+#endif
+  uint8_t limero_fresh;
+  __disable_irq();
   input1[inIdx].raw = limero_steer;
   input2[inIdx].raw = limero_speed;
-  if (limero_data_fresh)
+  limero_fresh = limero_data_fresh;
+  limero_data_fresh = 0;
+#ifdef LIMERO_ACK
+  limero_req_id = pending_req_id;
+#endif
+  __enable_irq();
+  if (limero_fresh)
   {
     timeoutCntSerial_L = 0;
     timeoutFlgSerial_L = 0;
-    limero_data_fresh = 0;
+#ifdef LIMERO_ACK
+    extern void limero_applied(uint32_t req_id, uint32_t tick); // queue the reply for the request just taken over
+    limero_applied(limero_req_id, main_loop_counter);
+#endif
   }
 #endif
 
@@ -1481,6 +1652,7 @@ void usart_process_command(SerialCommand *command_in, SerialCommand *command_out
     if (ibus_chksum == (uint16_t)((command_in->checksumh << 8) + command_in->checksuml))
     {
       *command_out = *command_in;
+      sched_trigger(TASK_COMMAND);  // stamp the arrival, with COMMAND_EVENT also release the command path
       if (usart_idx == 2)
       { // Sideboard USART2
 #ifdef CONTROL_SERIAL_USART2
@@ -1505,6 +1677,7 @@ void usart_process_command(SerialCommand *command_in, SerialCommand *command_out
     if (command_in->checksum == checksum)
     {
       *command_out = *command_in;
+      sched_trigger(TASK_COMMAND);  // stamp the arrival, with COMMAND_EVENT also release the command path
       if (usart_idx == 2)
       { // Sideboard USART2
 #ifdef CONTROL_SERIAL_USART2
@@ -1826,6 +1999,108 @@ void saveConfig()
 #endif
 }
 
+#ifdef FAST_BOOT
+/*
+ * Current offsets of the last run, checked by the DMA interrupt instead of the full calibration.
+ * Called before the ADC starts. Input_Init() only initializes the EEPROM emulation for some
+ * inputs, so it is done here as well.
+ */
+void offsetsLoad(void)
+{
+  uint16_t readVal;
+  uint8_t found = 0;
+  HAL_FLASH_Unlock();
+  EE_Init(); /* EEPROM Init */
+  for (uint8_t i = 0; i < 6; i++)
+  {
+    if (EE_ReadVariable(VirtAddVarTab[EE_FAST_BOOT_IDX + i], &readVal) == 0)
+    {
+      offsetStored[i] = (int16_t)readVal;
+      found++;
+    }
+  }
+  HAL_FLASH_Lock();
+  offsetStoredValid = (found == 6);
+}
+
+/*
+ * Store the current offsets for the next boot. Only the ones that changed are written,
+ * each write uses up a word of the EEPROM emulation page.
+ */
+void offsetsSave(void)
+{
+  int16_t offsets[6];
+  if (!offsetsGet(offsets))
+  {
+    return;
+  }
+  HAL_FLASH_Unlock();
+  for (uint8_t i = 0; i < 6; i++)
+  {
+    if (!offsetStoredValid || offsets[i] != offsetStored[i])
+    {
+      EE_WriteVariable(VirtAddVarTab[EE_FAST_BOOT_IDX + i], (uint16_t)offsets[i]);
+      offsetStored[i] = offsets[i];
+    }
+  }
+  HAL_FLASH_Lock();
+  offsetStoredValid = 1;
+}
+#endif
+
+#ifdef ENERGY_COUNT
+// energyStored in the order of the EEPROM variables from EE_ENERGY_IDX on, two per value
+static uint32_t *const energyStoredVal[4] = {&energyStored.usedMah, &energyStored.regenMah,
+                                             &energyStored.usedMwh, &energyStored.regenMwh};
+static uint8_t energyStoredFound = 0;   // values read back by energyLoad(), the others are written in full
+
+/*
+ * Lifetime totals up to this boot. Called before the ADC starts, like offsetsLoad().
+ * Totals that were never stored start from 0.
+ */
+void energyLoad(void)
+{
+  uint16_t lo, hi;
+  HAL_FLASH_Unlock();
+  EE_Init(); /* EEPROM Init */
+  for (uint8_t i = 0; i < 4; i++)
+  {
+    if (EE_ReadVariable(VirtAddVarTab[EE_ENERGY_IDX + 2 * i], &lo) == 0 && EE_ReadVariable(VirtAddVarTab[EE_ENERGY_IDX + 2 * i + 1], &hi) == 0)
+    {
+      *energyStoredVal[i] = (uint32_t)hi << 16 | lo;
+      energyStoredFound |= 1U << i;
+    }
+  }
+  HAL_FLASH_Lock();
+}
+
+/*
+ * Store the lifetime totals, called at power off. Only the halves that changed are written,
+ * which is mostly the low ones.
+ */
+void energySave(void)
+{
+  EnergyTotals total;
+  energy_total(&total);
+  const uint32_t val[4] = {total.usedMah, total.regenMah, total.usedMwh, total.regenMwh};
+  HAL_FLASH_Unlock();
+  for (uint8_t i = 0; i < 4; i++)
+  {
+    uint32_t stored = *energyStoredVal[i];
+    uint8_t  found  = energyStoredFound & (1U << i);
+    if (!found || (uint16_t)val[i] != (uint16_t)stored)
+    {
+      EE_WriteVariable(VirtAddVarTab[EE_ENERGY_IDX + 2 * i], (uint16_t)val[i]);
+    }
+    if (!found || val[i] >> 16 != stored >> 16)
+    {
+      EE_WriteVariable(VirtAddVarTab[EE_ENERGY_IDX + 2 * i + 1], (uint16_t)(val[i] >> 16));
+    }
+  }
+  HAL_FLASH_Lock();
+}
+#endif
+
 void poweroff(void)
 {
   enable = 0;
@@ -1840,6 +2115,12 @@ void poweroff(void)
     HAL_Delay(100);
   }
   saveConfig();
+#ifdef FAST_BOOT
+  offsetsSave();
+#endif
+#ifdef ENERGY_COUNT
+  energySave();
+#endif
   HAL_GPIO_WritePin(OFF_PORT, OFF_PIN, GPIO_PIN_RESET);
   while (1)
   {